@@ -0,0 +1,171 @@
+#pragma once
+#include "EasyVKStart.h"
+#include "ThreadPool.h"
+#include "VKBase+.h"
+#include "VKBase.h"
+
+#include <mutex>
+
+using namespace vulkan;
+
+/*
+在后台线程编译管线，避免渲染线程因即时编译而卡顿：
+1. 首次请求某个管线时，复制创建信息包并提交到线程池编译，立即返回调用者指定的后备管线
+   （如功能较简单的版本或通用的uber着色器版本），编译完成前的请求都返回后备管线
+2. 后台编译完成的管线在下一次Update()时一并换入，同一帧内对同一管线的请求总是返回相同的句柄
+3. Statistics()给出正在编译、已完成、失败的管线个数，以及返回后备管线的次数
+
+管线以pipelineStateKey区分，状态相同的请求只编译一次；pNext链中有其不认识的结构体时不去重，每次请求都会重新编译。
+创建信息包中引用的着色器模块、管线布局、渲染通道须在编译完成前保持有效。
+*/
+
+namespace easyVulkan {
+
+/**
+ * @brief 异步编译的统计数据
+ */
+struct asyncPipelineStatistics
+{
+    uint32_t pendingCount   = 0;  // 正在编译或等待换入
+    uint32_t completedCount = 0;  // 已换入
+    uint32_t failedCount    = 0;
+    uint64_t fallbackCount  = 0;  // 返回后备管线的次数
+};
+
+/**
+ * @brief 以后备管线掩盖编译延迟的异步管线编译器
+ * @note Request(...)和Update()须在同一线程调用；须在创建逻辑设备之后构造，且在逻辑设备销毁前析构
+ */
+class asyncPipelineCompiler {
+    struct entry
+    {
+        pipelineStateKey               key;
+        graphicsPipelineCreateInfoPack pack;      // 供后台线程使用的副本
+        std::unique_ptr<pipeline>      compiled;  // 编译失败时始终为空
+    };
+
+    threadPool&                                                       pool;
+    std::unordered_map<uint64_t, std::vector<std::unique_ptr<entry>>> entries;
+    std::mutex                                                        mutex;
+    std::vector<std::pair<entry*, std::unique_ptr<pipeline>>>         finished;  // 编译失败时管线为空
+    taskCounter                                                       compilingTasks;
+    asyncPipelineStatistics                                           statistics;
+
+    void Build(entry* pEntry)
+    {
+        auto compiled = std::make_unique<pipeline>();
+        if (compiled->Create(pEntry->pack) != VK_SUCCESS) { compiled.reset(); }
+        std::lock_guard lock(mutex);
+        finished.emplace_back(pEntry, std::move(compiled));
+    }
+    void Compile(entry* pEntry)
+    {
+        statistics.pendingCount++;
+        pool.Submit([this, pEntry] { Build(pEntry); }, compilingTasks);
+    }
+    void SwapInCompiled()
+    {
+        std::lock_guard lock(mutex);
+        for (auto& [pEntry, compiled] : finished)
+        {
+            statistics.pendingCount--;
+            if (!compiled)
+            {
+                statistics.failedCount++;
+                continue;
+            }
+            pEntry->compiled = std::move(compiled);
+            statistics.completedCount++;
+        }
+        finished.clear();
+    }
+
+public:
+    asyncPipelineCompiler(threadPool& pool = threadPool::Shared()) : pool(pool) {}
+    asyncPipelineCompiler(const asyncPipelineCompiler&)            = delete;
+    asyncPipelineCompiler& operator=(const asyncPipelineCompiler&) = delete;
+    ~asyncPipelineCompiler() { WaitIdle(); }
+
+    // Getter
+    const asyncPipelineStatistics& Statistics() const { return statistics; }
+
+    // Const Function
+    /**
+     * @brief 管线是否已编译完成并换入
+     */
+    bool Ready(const graphicsPipelineCreateInfoPack& pack) const
+    {
+        pipelineStateKey key(pack.createInfo);
+        auto             bucket = entries.find(key.Hash());
+        if (bucket == entries.end()) { return false; }
+        for (auto& i : bucket->second)
+        {
+            if (i->key == key) { return i->compiled != nullptr; }
+        }
+        return false;
+    }
+
+    // Non-const Function
+    /**
+     * @brief 取得与创建信息包对应的管线，尚未编译完成时返回fallback
+     * @note 首次请求时开始编译，pack须已调用UpdateAllArrays()；编译失败的管线始终以fallback代替
+     *
+     * @param fallback 编译完成前使用的后备管线，可为VK_NULL_HANDLE，表示调用者跳过相应的绘制
+     */
+    VkPipeline Request(const graphicsPipelineCreateInfoPack& pack, VkPipeline fallback)
+    {
+        pipelineStateKey key(pack.createInfo);
+        auto&            bucket = entries[key.Hash()];
+        for (auto& i : bucket)
+        {
+            if (!(i->key == key)) { continue; }
+            if (i->compiled) { return *i->compiled; }
+            statistics.fallbackCount++;
+            return fallback;
+        }
+        auto& newEntry = bucket.emplace_back(std::make_unique<entry>(entry{std::move(key), pack}));
+        Compile(newEntry.get());
+        statistics.fallbackCount++;
+        return fallback;
+    }
+    /**
+     * @brief 预先开始编译，不返回管线，用于按使用清单预热
+     *
+     * @return bool 是否提交了新的编译，管线已存在或正在编译时返回false
+     */
+    bool Prewarm(const graphicsPipelineCreateInfoPack& pack)
+    {
+        pipelineStateKey key(pack.createInfo);
+        auto&            bucket = entries[key.Hash()];
+        for (auto& i : bucket)
+        {
+            if (i->key == key) { return false; }
+        }
+        Compile(bucket.emplace_back(std::make_unique<entry>(entry{std::move(key), pack})).get());
+        return true;
+    }
+    /**
+     * @brief 每帧调用一次，换入后台编译完成的管线
+     */
+    void Update() { SwapInCompiled(); }
+    /**
+     * @brief 等待所有后台编译完成并换入，用于加载界面或退出前
+     */
+    void WaitIdle()
+    {
+        compilingTasks.Wait();
+        SwapInCompiled();
+    }
+    /**
+     * @brief 销毁所有管线，须确保它们已不再被GPU使用
+     */
+    void Clear()
+    {
+        WaitIdle();
+        entries.clear();
+        statistics.completedCount = 0;
+        statistics.failedCount    = 0;
+    }
+};
+
+}  // namespace easyVulkan
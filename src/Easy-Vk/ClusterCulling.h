@@ -0,0 +1,223 @@
+#pragma once
+#include "EasyVKStart.h"
+#include "MeshCache.h"
+#include "VKBase+.h"
+#include "VKBase.h"
+
+/*
+不依赖网格着色器的网格簇剔除：
+1. 计算着色器（shader/ClusterCull.comp.shader）对每个网格簇做平截头体剔除和法线锥背面剔除，
+   通过的网格簇以原子计数紧凑地写出VkDrawIndexedIndirectCommand
+2. 间接绘制缓冲区在剔除前被清零，末尾未写入的命令的indexCount为0，不绘制任何东西，
+   因此即便不支持drawIndirectCount，也可以用一次vkCmdDrawIndexedIndirect(...)绘制全部meshletCount条命令，
+   这要求物理设备支持multiDrawIndirect特性，不支持时Create(...)失败，而不是退化为每个网格簇一次绘制
+3. 绘制时仍使用普通的顶点着色器管线，顶点和索引缓冲区与UploadMesh(...)上传的相同
+
+剔除须在渲染通道之外进行，即先CmdCull(...)，再开始渲染通道并CmdDraw(...)。
+*/
+
+namespace easyVulkan {
+
+/**
+ * @brief 剔除所用的推送常量，布局与ClusterCull.comp.shader中的一致
+ */
+struct clusterCullConstants
+{
+    glm::vec4 frustumPlanes[6];  // 模型空间中的平面，法线朝向平截头体内侧
+    glm::vec3 cameraPosition;    // 模型空间中的相机位置
+    uint32_t  meshletCount;
+};
+static_assert(sizeof(clusterCullConstants) == 112);
+
+/**
+ * @brief 从矩阵中提取平截头体的六个平面（Gribb-Hartmann法）
+ * @note 传入投影 * 观察 * 模型矩阵，即得到模型空间中的平面。深度范围为[0, 1]，
+ * FlipVertical(...)只是交换了上下两个平面，不影响结果。
+ */
+inline std::array<glm::vec4, 6> ExtractFrustumPlanes(const glm::mat4& matrix)
+{
+    auto Row = [&](int i) { return glm::vec4(matrix[0][i], matrix[1][i], matrix[2][i], matrix[3][i]); };
+    std::array<glm::vec4, 6> planes = {
+        Row(3) + Row(0),  // 左
+        Row(3) - Row(0),  // 右
+        Row(3) + Row(1),  // 下
+        Row(3) - Row(1),  // 上
+        Row(2),           // 近
+        Row(3) - Row(2),  // 远
+    };
+    for (auto& i : planes) { i /= glm::length(glm::vec3(i)); }
+    return planes;
+}
+
+/**
+ * @brief 对一个网格的所有网格簇进行GPU剔除，并生成间接绘制命令
+ */
+class clusterCuller {
+    descriptorSetLayout descriptorSetLayout_cull;
+    pipelineLayout      pipelineLayout_cull;
+    pipeline            pipeline_cull;
+    descriptorPool      descriptorPool_cull;
+    descriptorSet       descriptorSet_cull;
+    deviceLocalBuffer   meshletBuffer;
+    deviceLocalBuffer   drawCommandBuffer;
+    deviceLocalBuffer   drawCountBuffer;
+    uint32_t            meshletCount = 0;
+
+    static constexpr uint32_t workgroupSize = 64;  // 须与着色器中的local_size_x一致
+
+public:
+    clusterCuller() = default;
+
+    // Getter
+    uint32_t MeshletCount() const { return meshletCount; }
+    // 供启用了drawIndirectCount特性的程序自行调用vkCmdDrawIndexedIndirectCount(...)，计数缓冲区中为通过剔除的命令数
+    VkBuffer DrawCommandBuffer() const { return drawCommandBuffer; }
+    VkBuffer DrawCountBuffer() const { return drawCountBuffer; }
+
+    // Const Function
+    /**
+     * @brief 记录剔除命令，须在渲染通道之外调用
+     *
+     * @param viewProjection 投影 * 观察矩阵
+     * @param model 模型矩阵，不包括meshCache::PositionDequantization()，网格簇的包围体不受量化影响
+     * @param cameraPosition 世界空间中的相机位置
+     */
+    void CmdCull(VkCommandBuffer  commandBuffer,
+                 const glm::mat4& viewProjection,
+                 const glm::mat4& model,
+                 const glm::vec3& cameraPosition) const
+    {
+        clusterCullConstants constants = {};
+        auto                 planes    = ExtractFrustumPlanes(viewProjection * model);
+        std::copy(planes.begin(), planes.end(), constants.frustumPlanes);
+        constants.cameraPosition = glm::vec3(glm::inverse(model) * glm::vec4(cameraPosition, 1.F));
+        constants.meshletCount   = meshletCount;
+
+        // 上一次的间接绘制读完之后才能清零
+        VkMemoryBarrier barrier = {
+            .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = 0,
+            .dstAccessMask = 0,
+        };
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1,
+                             &barrier, 0, nullptr, 0, nullptr);
+        vkCmdFillBuffer(commandBuffer, drawCommandBuffer, 0, VK_WHOLE_SIZE, 0);
+        vkCmdFillBuffer(commandBuffer, drawCountBuffer, 0, VK_WHOLE_SIZE, 0);
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1,
+                             &barrier, 0, nullptr, 0, nullptr);
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_cull);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout_cull, 0, 1,
+                                descriptorSet_cull.Address(), 0, nullptr);
+        vkCmdPushConstants(commandBuffer, pipelineLayout_cull, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof constants,
+                           &constants);
+        vkCmdDispatch(commandBuffer, (meshletCount + workgroupSize - 1) / workgroupSize, 1, 1);
+
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+    /**
+     * @brief 以一次多重间接绘制记录全部网格簇的绘制命令，调用前须绑定图形管线以及UploadMesh(...)所创建的顶点和索引缓冲区
+     */
+    void CmdDraw(VkCommandBuffer commandBuffer) const
+    {
+        constexpr uint32_t stride       = sizeof(VkDrawIndexedIndirectCommand);
+        uint32_t           maxDrawCount = GraphicsBase::Base().PhysicalDeviceProperties().limits.maxDrawIndirectCount;
+        for (uint32_t first = 0; first < meshletCount; first += maxDrawCount)
+        {
+            vkCmdDrawIndexedIndirect(commandBuffer, drawCommandBuffer, VkDeviceSize(first) * stride,
+                                     std::min(maxDrawCount, meshletCount - first), stride);
+        }
+    }
+
+    // Non-const Function
+    /**
+     * @brief 上传网格缓存中的网格簇，并创建剔除所需的管线和缓冲区
+     *
+     * @param shaderPath 由ClusterCull.comp.shader编译得到的SPIR-V
+     */
+    result_t Create(const meshCache& cache, const char* shaderPath = "shader/ClusterCull.comp.spv")
+    {
+        auto meshlets = cache.Meshlets();
+        if (meshlets.Count() == 0)
+        {
+            LOG(ERROR) << "[ clusterCuller ] ERROR\nThe mesh cache contains no meshlet!\n"
+                       << "Set meshImportOptions::buildMeshlets to true when loading the mesh.";
+            return VK_RESULT_MAX_ENUM;
+        }
+        VkPhysicalDeviceFeatures physicalDeviceFeatures;
+        vkGetPhysicalDeviceFeatures(GraphicsBase::Base().PhysicalDevice(), &physicalDeviceFeatures);
+        if (physicalDeviceFeatures.multiDrawIndirect == VK_FALSE)  // CreateDevice()开启了所有支持的1.0特性
+        {
+            LOG(ERROR) << "[ clusterCuller ] ERROR\nCluster culling requires the multiDrawIndirect feature!";
+            return VK_ERROR_FEATURE_NOT_PRESENT;
+        }
+        meshletCount = static_cast<uint32_t>(meshlets.Count());
+
+        // 缓冲区
+        if (result_t result = meshletBuffer.Create(sizeof(meshlet) * meshletCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT))
+        {
+            return result;
+        }
+        meshletBuffer.TransferData(meshlets.Pointer(), sizeof(meshlet) * meshletCount);
+        if (result_t result =
+                drawCommandBuffer.Create(sizeof(VkDrawIndexedIndirectCommand) * meshletCount,
+                                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT))
+        {
+            return result;
+        }
+        if (result_t result = drawCountBuffer.Create(
+                sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT))
+        {
+            return result;
+        }
+
+        // 描述符
+        std::array<VkDescriptorSetLayoutBinding, 3> bindings = {};
+        for (uint32_t i = 0; i < bindings.size(); i++)
+        {
+            bindings[i] = {i, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT};
+        }
+        VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
+            .bindingCount = static_cast<uint32_t>(bindings.size()),
+            .pBindings    = bindings.data(),
+        };
+        if (result_t result = descriptorSetLayout_cull.Create(descriptorSetLayoutCreateInfo)) { return result; }
+        VkDescriptorPoolSize poolSize = {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, static_cast<uint32_t>(bindings.size())};
+        if (result_t result = descriptorPool_cull.Create(1, poolSize)) { return result; }
+        if (result_t result = descriptorPool_cull.AllocateSets(descriptorSet_cull, descriptorSetLayout_cull))
+        {
+            return result;
+        }
+        std::array<VkDescriptorBufferInfo, 3> bufferInfos = {{
+            {meshletBuffer, 0, VK_WHOLE_SIZE},
+            {drawCommandBuffer, 0, VK_WHOLE_SIZE},
+            {drawCountBuffer, 0, VK_WHOLE_SIZE},
+        }};
+        descriptorSet_cull.Write({bufferInfos.data(), bufferInfos.size()}, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+        // 管线
+        VkPushConstantRange        pushConstantRange        = {VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                                                               sizeof(clusterCullConstants)};
+        VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
+            .setLayoutCount         = 1,
+            .pSetLayouts            = descriptorSetLayout_cull.Address(),
+            .pushConstantRangeCount = 1,
+            .pPushConstantRanges    = &pushConstantRange,
+        };
+        if (result_t result = pipelineLayout_cull.Create(pipelineLayoutCreateInfo)) { return result; }
+        shaderModule shader;
+        if (result_t result = shader.Create(shaderPath)) { return result; }
+        VkComputePipelineCreateInfo pipelineCreateInfo = {
+            .stage  = shader.StageCreateInfo(VK_SHADER_STAGE_COMPUTE_BIT),
+            .layout = pipelineLayout_cull,
+        };
+        return pipeline_cull.Create(pipelineCreateInfo);
+    }
+};
+
+}  // namespace easyVulkan
@@ -0,0 +1,430 @@
+#pragma once
+#include "EasyVKStart.h"
+#include "VKBase+.h"
+#include "VKBase.h"
+
+#include <mutex>
+
+using namespace vulkan;
+
+/*
+以动态状态减少管线的数量：
+1. VK_EXT_extended_dynamic_state（Vulkan1.3中为核心功能）使剔除模式、正面朝向、拓扑、深度测试、
+   顶点缓冲区的步长等可在录制命令时设置；VK_EXT_extended_dynamic_state2、3进一步覆盖图元重启、深度偏移、
+   多边形模式、混色等，VK_EXT_vertex_input_dynamic_state使整个顶点输入成为动态状态
+2. 以AddSupported(...)向graphicsPipelineCreateInfoPack添加动态状态，设备不支持的动态状态被跳过，
+   管线仍使用创建信息中的值，因此同一套代码在不支持扩展的设备上仍然正确，只是管线多一些
+3. pipelineStateKey不计入动态状态的值，仅这些值不同的管线在pipelineRegistry等缓存中只创建一次
+4. 录制时以dynamicStateRecorder设置动态状态，与上一次设置的值相同时不录制命令
+
+这些扩展须在创建逻辑设备前以EnableDeviceExtensions()开启。
+*/
+
+namespace easyVulkan {
+
+/**
+ * @brief 设置动态状态，并跳过与当前值相同的设置
+ * @note 绑定未将某个状态设为动态的管线后，该状态的值由管线决定，记录的值随之作废，
+ * 因此须以BindPipeline(...)绑定管线。每个命令缓冲区各用一个，不是线程安全的
+ */
+class dynamicStateRecorder {
+    // 被跟踪的状态在known中的位
+    enum slot : uint32_t {
+        slot_cullMode,
+        slot_frontFace,
+        slot_primitiveTopology,
+        slot_primitiveRestartEnable,
+        slot_depthTestEnable,
+        slot_depthWriteEnable,
+        slot_depthCompareOp,
+        slot_depthBiasEnable,
+        slot_rasterizerDiscardEnable,
+        slot_polygonMode,
+        slot_depthClampEnable,
+        slot_logicOp,
+        slot_colorBlendEnable,
+        slot_colorWriteMask,
+        slot_vertexInput,
+    };
+    struct functions
+    {
+        VkDevice                               device = VK_NULL_HANDLE;
+        PFN_vkCmdSetCullModeEXT                cmdSetCullMode;
+        PFN_vkCmdSetFrontFaceEXT               cmdSetFrontFace;
+        PFN_vkCmdSetPrimitiveTopologyEXT       cmdSetPrimitiveTopology;
+        PFN_vkCmdSetPrimitiveRestartEnableEXT  cmdSetPrimitiveRestartEnable;
+        PFN_vkCmdSetDepthTestEnableEXT         cmdSetDepthTestEnable;
+        PFN_vkCmdSetDepthWriteEnableEXT        cmdSetDepthWriteEnable;
+        PFN_vkCmdSetDepthCompareOpEXT          cmdSetDepthCompareOp;
+        PFN_vkCmdSetDepthBiasEnableEXT         cmdSetDepthBiasEnable;
+        PFN_vkCmdSetRasterizerDiscardEnableEXT cmdSetRasterizerDiscardEnable;
+        PFN_vkCmdSetPolygonModeEXT             cmdSetPolygonMode;
+        PFN_vkCmdSetDepthClampEnableEXT        cmdSetDepthClampEnable;
+        PFN_vkCmdSetLogicOpEXT                 cmdSetLogicOp;
+        PFN_vkCmdSetColorBlendEnableEXT        cmdSetColorBlendEnable;
+        PFN_vkCmdSetColorWriteMaskEXT          cmdSetColorWriteMask;
+        PFN_vkCmdSetVertexInputEXT             cmdSetVertexInput;
+        PFN_vkCmdBindVertexBuffers2EXT         cmdBindVertexBuffers2;
+    };
+    // 扩展的特性结构体须活过逻辑设备
+    inline static VkPhysicalDeviceExtendedDynamicStateFeaturesEXT extendedDynamicStateFeatures = {
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT,
+    };
+    inline static VkPhysicalDeviceExtendedDynamicState2FeaturesEXT extendedDynamicState2Features = {
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT,
+    };
+    inline static VkPhysicalDeviceExtendedDynamicState3FeaturesEXT extendedDynamicState3Features = {
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT,
+    };
+    inline static VkPhysicalDeviceVertexInputDynamicStateFeaturesEXT vertexInputDynamicStateFeatures = {
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VERTEX_INPUT_DYNAMIC_STATE_FEATURES_EXT,
+    };
+
+    VkCommandBuffer  commandBuffer = VK_NULL_HANDLE;
+    const functions* pFunctions    = nullptr;
+    uint32_t         known         = 0;  // 各状态的当前值是否已知
+    // 各状态的当前值
+    VkCullModeFlags                                    cullMode;
+    VkFrontFace                                        frontFace;
+    VkPrimitiveTopology                                primitiveTopology;
+    VkBool32                                           primitiveRestartEnable;
+    VkBool32                                           depthTestEnable;
+    VkBool32                                           depthWriteEnable;
+    VkCompareOp                                        depthCompareOp;
+    VkBool32                                           depthBiasEnable;
+    VkBool32                                           rasterizerDiscardEnable;
+    VkPolygonMode                                      polygonMode;
+    VkBool32                                           depthClampEnable;
+    VkLogicOp                                          logicOp;
+    std::vector<VkBool32>                              colorBlendEnables;
+    std::vector<VkColorComponentFlags>                 colorWriteMasks;
+    std::vector<VkVertexInputBindingDescription2EXT>   vertexBindings;
+    std::vector<VkVertexInputAttributeDescription2EXT> vertexAttributes;
+
+    template <typename T>
+    static bool Equal(const std::vector<T>& current, arrayRef<const T> values)
+    {
+        return current.size() == values.Count() &&
+               std::memcmp(current.data(), values.Pointer(), sizeof(T) * values.Count()) == 0;
+    }
+    /**
+     * @brief 若状态的当前值已知且等于value则返回false，否则记下value并返回true
+     */
+    template <typename T>
+    bool Changed(slot index, T& current, const T& value)
+    {
+        uint32_t bit = 1U << index;
+        if ((known & bit) != 0U && current == value) { return false; }
+        current = value;
+        known |= bit;
+        return true;
+    }
+    template <typename T>
+    bool Changed(slot index, std::vector<T>& current, arrayRef<const T> values)
+    {
+        uint32_t bit = 1U << index;
+        if ((known & bit) != 0U && Equal(current, values)) { return false; }
+        current.assign(values.begin(), values.end());
+        known |= bit;
+        return true;
+    }
+
+    template <typename T>
+    static void Load(T& function, const char* coreName, const char* extensionName)
+    {
+        VkDevice           device   = GraphicsBase::Base().Device();
+        PFN_vkVoidFunction pAddress = vkGetDeviceProcAddr(device, coreName);
+        if (pAddress == nullptr) { pAddress = vkGetDeviceProcAddr(device, extensionName); }
+        function = reinterpret_cast<T>(pAddress);
+    }
+    /**
+     * @brief 取得当前逻辑设备的函数指针，逻辑设备被重建后重新取得
+     */
+    static const functions& Functions()
+    {
+        static functions  f;
+        static std::mutex mutex;
+        std::lock_guard   lock(mutex);
+        if (f.device == GraphicsBase::Base().Device()) { return f; }
+        f.device = GraphicsBase::Base().Device();
+        Load(f.cmdSetCullMode, "vkCmdSetCullMode", "vkCmdSetCullModeEXT");
+        Load(f.cmdSetFrontFace, "vkCmdSetFrontFace", "vkCmdSetFrontFaceEXT");
+        Load(f.cmdSetPrimitiveTopology, "vkCmdSetPrimitiveTopology", "vkCmdSetPrimitiveTopologyEXT");
+        Load(f.cmdSetPrimitiveRestartEnable, "vkCmdSetPrimitiveRestartEnable", "vkCmdSetPrimitiveRestartEnableEXT");
+        Load(f.cmdSetDepthTestEnable, "vkCmdSetDepthTestEnable", "vkCmdSetDepthTestEnableEXT");
+        Load(f.cmdSetDepthWriteEnable, "vkCmdSetDepthWriteEnable", "vkCmdSetDepthWriteEnableEXT");
+        Load(f.cmdSetDepthCompareOp, "vkCmdSetDepthCompareOp", "vkCmdSetDepthCompareOpEXT");
+        Load(f.cmdSetDepthBiasEnable, "vkCmdSetDepthBiasEnable", "vkCmdSetDepthBiasEnableEXT");
+        Load(f.cmdSetRasterizerDiscardEnable, "vkCmdSetRasterizerDiscardEnable", "vkCmdSetRasterizerDiscardEnableEXT");
+        Load(f.cmdSetPolygonMode, "vkCmdSetPolygonModeEXT", "vkCmdSetPolygonModeEXT");
+        Load(f.cmdSetDepthClampEnable, "vkCmdSetDepthClampEnableEXT", "vkCmdSetDepthClampEnableEXT");
+        Load(f.cmdSetLogicOp, "vkCmdSetLogicOpEXT", "vkCmdSetLogicOpEXT");
+        Load(f.cmdSetColorBlendEnable, "vkCmdSetColorBlendEnableEXT", "vkCmdSetColorBlendEnableEXT");
+        Load(f.cmdSetColorWriteMask, "vkCmdSetColorWriteMaskEXT", "vkCmdSetColorWriteMaskEXT");
+        Load(f.cmdSetVertexInput, "vkCmdSetVertexInputEXT", "vkCmdSetVertexInputEXT");
+        Load(f.cmdBindVertexBuffers2, "vkCmdBindVertexBuffers2", "vkCmdBindVertexBuffers2EXT");
+        return f;
+    }
+    static int32_t Slot(VkDynamicState state)
+    {
+        switch (state)
+        {
+            case VK_DYNAMIC_STATE_CULL_MODE: return slot_cullMode;
+            case VK_DYNAMIC_STATE_FRONT_FACE: return slot_frontFace;
+            case VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY: return slot_primitiveTopology;
+            case VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE: return slot_primitiveRestartEnable;
+            case VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE: return slot_depthTestEnable;
+            case VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE: return slot_depthWriteEnable;
+            case VK_DYNAMIC_STATE_DEPTH_COMPARE_OP: return slot_depthCompareOp;
+            case VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE: return slot_depthBiasEnable;
+            case VK_DYNAMIC_STATE_RASTERIZER_DISCARD_ENABLE: return slot_rasterizerDiscardEnable;
+            case VK_DYNAMIC_STATE_POLYGON_MODE_EXT: return slot_polygonMode;
+            case VK_DYNAMIC_STATE_DEPTH_CLAMP_ENABLE_EXT: return slot_depthClampEnable;
+            case VK_DYNAMIC_STATE_LOGIC_OP_EXT: return slot_logicOp;
+            case VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT: return slot_colorBlendEnable;
+            case VK_DYNAMIC_STATE_COLOR_WRITE_MASK_EXT: return slot_colorWriteMask;
+            case VK_DYNAMIC_STATE_VERTEX_INPUT_EXT: return slot_vertexInput;
+            default: return -1;
+        }
+    }
+
+public:
+    dynamicStateRecorder() = default;
+    dynamicStateRecorder(VkCommandBuffer commandBuffer) { Begin(commandBuffer); }
+
+    // Non-const Function
+    /**
+     * @brief 开始在命令缓冲区中录制，此前记录的值全部作废
+     * @note 须在逻辑设备创建后、vkBeginCommandBuffer(...)之后调用
+     */
+    void Begin(VkCommandBuffer commandBuffer)
+    {
+        this->commandBuffer = commandBuffer;
+        pFunctions          = &Functions();
+        known               = 0;
+    }
+    /**
+     * @brief 绑定管线，管线中不是动态的状态，其记录的值作废
+     */
+    void BindPipeline(VkPipeline pipeline, arrayRef<const VkDynamicState> dynamicStates)
+    {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        uint32_t dynamicMask = 0;
+        for (size_t i = 0; i < dynamicStates.Count(); i++)
+        {
+            if (int32_t slot = Slot(dynamicStates[i]); slot >= 0) { dynamicMask |= 1U << slot; }
+        }
+        known &= dynamicMask;
+    }
+    void BindPipeline(VkPipeline pipeline, const graphicsPipelineCreateInfoPack& pack)
+    {
+        BindPipeline(pipeline, {pack.dynamicStates.data(), pack.dynamicStates.size()});
+    }
+    void SetCullMode(VkCullModeFlags value)
+    {
+        if (Changed(slot_cullMode, cullMode, value)) { pFunctions->cmdSetCullMode(commandBuffer, value); }
+    }
+    void SetFrontFace(VkFrontFace value)
+    {
+        if (Changed(slot_frontFace, frontFace, value)) { pFunctions->cmdSetFrontFace(commandBuffer, value); }
+    }
+    void SetPrimitiveTopology(VkPrimitiveTopology value)
+    {
+        if (Changed(slot_primitiveTopology, primitiveTopology, value))
+        {
+            pFunctions->cmdSetPrimitiveTopology(commandBuffer, value);
+        }
+    }
+    void SetPrimitiveRestartEnable(VkBool32 value)
+    {
+        if (Changed(slot_primitiveRestartEnable, primitiveRestartEnable, value))
+        {
+            pFunctions->cmdSetPrimitiveRestartEnable(commandBuffer, value);
+        }
+    }
+    void SetDepthTestEnable(VkBool32 value)
+    {
+        if (Changed(slot_depthTestEnable, depthTestEnable, value))
+        {
+            pFunctions->cmdSetDepthTestEnable(commandBuffer, value);
+        }
+    }
+    void SetDepthWriteEnable(VkBool32 value)
+    {
+        if (Changed(slot_depthWriteEnable, depthWriteEnable, value))
+        {
+            pFunctions->cmdSetDepthWriteEnable(commandBuffer, value);
+        }
+    }
+    void SetDepthCompareOp(VkCompareOp value)
+    {
+        if (Changed(slot_depthCompareOp, depthCompareOp, value))
+        {
+            pFunctions->cmdSetDepthCompareOp(commandBuffer, value);
+        }
+    }
+    void SetDepthBiasEnable(VkBool32 value)
+    {
+        if (Changed(slot_depthBiasEnable, depthBiasEnable, value))
+        {
+            pFunctions->cmdSetDepthBiasEnable(commandBuffer, value);
+        }
+    }
+    void SetRasterizerDiscardEnable(VkBool32 value)
+    {
+        if (Changed(slot_rasterizerDiscardEnable, rasterizerDiscardEnable, value))
+        {
+            pFunctions->cmdSetRasterizerDiscardEnable(commandBuffer, value);
+        }
+    }
+    void SetPolygonMode(VkPolygonMode value)
+    {
+        if (Changed(slot_polygonMode, polygonMode, value)) { pFunctions->cmdSetPolygonMode(commandBuffer, value); }
+    }
+    void SetDepthClampEnable(VkBool32 value)
+    {
+        if (Changed(slot_depthClampEnable, depthClampEnable, value))
+        {
+            pFunctions->cmdSetDepthClampEnable(commandBuffer, value);
+        }
+    }
+    void SetLogicOp(VkLogicOp value)
+    {
+        if (Changed(slot_logicOp, logicOp, value)) { pFunctions->cmdSetLogicOp(commandBuffer, value); }
+    }
+    /**
+     * @brief 设置从第0个起的各颜色附件是否混色
+     */
+    void SetColorBlendEnable(arrayRef<const VkBool32> values)
+    {
+        if (Changed(slot_colorBlendEnable, colorBlendEnables, values))
+        {
+            pFunctions->cmdSetColorBlendEnable(commandBuffer, 0, values.Count(), values.Pointer());
+        }
+    }
+    /**
+     * @brief 设置从第0个起的各颜色附件的写入掩码
+     */
+    void SetColorWriteMask(arrayRef<const VkColorComponentFlags> values)
+    {
+        if (Changed(slot_colorWriteMask, colorWriteMasks, values))
+        {
+            pFunctions->cmdSetColorWriteMask(commandBuffer, 0, values.Count(), values.Pointer());
+        }
+    }
+    /**
+     * @brief 设置顶点输入，须开启VK_EXT_vertex_input_dynamic_state
+     */
+    void SetVertexInput(arrayRef<const VkVertexInputBindingDescription2EXT>   bindings,
+                        arrayRef<const VkVertexInputAttributeDescription2EXT> attributes)
+    {
+        uint32_t bit = 1U << slot_vertexInput;
+        if ((known & bit) != 0U && Equal(vertexBindings, bindings) && Equal(vertexAttributes, attributes)) { return; }
+        vertexBindings.assign(bindings.begin(), bindings.end());
+        vertexAttributes.assign(attributes.begin(), attributes.end());
+        known |= bit;
+        pFunctions->cmdSetVertexInput(commandBuffer, bindings.Count(), bindings.Pointer(), attributes.Count(),
+                                      attributes.Pointer());
+    }
+    /**
+     * @brief 绑定顶点缓冲区并指定步长，用于VK_DYNAMIC_STATE_VERTEX_INPUT_BINDING_STRIDE
+     * @note 顶点缓冲区通常每次绘制都不同，不做过滤
+     */
+    void BindVertexBuffers(uint32_t firstBinding, arrayRef<const VkBuffer> buffers,
+                           arrayRef<const VkDeviceSize> offsets, arrayRef<const VkDeviceSize> strides)
+    {
+        pFunctions->cmdBindVertexBuffers2(commandBuffer, firstBinding, buffers.Count(), buffers.Pointer(),
+                                          offsets.Pointer(), nullptr, strides.Pointer());
+    }
+
+    // Static Function
+    /**
+     * @brief 开启物理设备支持的动态状态扩展，须在DeterminePhysicalDevice(...)之后、CreateDevice()之前调用
+     */
+    static result_t EnableDeviceExtensions()
+    {
+        std::vector<const char*> extensions = {
+            VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME,
+            VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME,
+            VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME,
+            VK_EXT_VERTEX_INPUT_DYNAMIC_STATE_EXTENSION_NAME,
+        };
+        void* features[] = {
+            &extendedDynamicStateFeatures,
+            &extendedDynamicState2Features,
+            &extendedDynamicState3Features,
+            &vertexInputDynamicStateFeatures,
+        };
+        if (result_t result = GraphicsBase::Base().CheckDeviceExtensions(extensions)) { return result; }
+        for (size_t i = 0; i < extensions.size(); i++)
+        {
+            if (extensions[i] == nullptr) { continue; }
+            GraphicsBase::Base().AddDeviceExtension(extensions[i]);
+            GraphicsBase::Base().AddDeviceFeatures(features[i]);
+        }
+        return VK_SUCCESS;
+    }
+    /**
+     * @brief 逻辑设备是否支持将该状态设为动态，须在创建逻辑设备后调用
+     */
+    static bool Supported(VkDynamicState state)
+    {
+        // Vulkan1.3中，VK_EXT_extended_dynamic_state及VK_EXT_extended_dynamic_state2的基本功能为核心功能
+        bool core = std::min(GraphicsBase::Base().ApiVersion(),
+                             GraphicsBase::Base().PhysicalDeviceProperties().apiVersion) >= VK_API_VERSION_1_3;
+        const auto& eds3 = extendedDynamicState3Features;
+        switch (state)
+        {
+            case VK_DYNAMIC_STATE_CULL_MODE:
+            case VK_DYNAMIC_STATE_FRONT_FACE:
+            case VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY:
+            case VK_DYNAMIC_STATE_VIEWPORT_WITH_COUNT:
+            case VK_DYNAMIC_STATE_SCISSOR_WITH_COUNT:
+            case VK_DYNAMIC_STATE_VERTEX_INPUT_BINDING_STRIDE:
+            case VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE:
+            case VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE:
+            case VK_DYNAMIC_STATE_DEPTH_COMPARE_OP:
+            case VK_DYNAMIC_STATE_DEPTH_BOUNDS_TEST_ENABLE:
+            case VK_DYNAMIC_STATE_STENCIL_TEST_ENABLE:
+            case VK_DYNAMIC_STATE_STENCIL_OP: return core || extendedDynamicStateFeatures.extendedDynamicState;
+            case VK_DYNAMIC_STATE_RASTERIZER_DISCARD_ENABLE:
+            case VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE:
+            case VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE:
+                return core || extendedDynamicState2Features.extendedDynamicState2;
+            case VK_DYNAMIC_STATE_LOGIC_OP_EXT: return extendedDynamicState2Features.extendedDynamicState2LogicOp;
+            case VK_DYNAMIC_STATE_PATCH_CONTROL_POINTS_EXT:
+                return extendedDynamicState2Features.extendedDynamicState2PatchControlPoints;
+            case VK_DYNAMIC_STATE_POLYGON_MODE_EXT: return eds3.extendedDynamicState3PolygonMode;
+            case VK_DYNAMIC_STATE_DEPTH_CLAMP_ENABLE_EXT: return eds3.extendedDynamicState3DepthClampEnable;
+            case VK_DYNAMIC_STATE_LOGIC_OP_ENABLE_EXT: return eds3.extendedDynamicState3LogicOpEnable;
+            case VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT: return eds3.extendedDynamicState3ColorBlendEnable;
+            case VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT: return eds3.extendedDynamicState3ColorBlendEquation;
+            case VK_DYNAMIC_STATE_COLOR_WRITE_MASK_EXT: return eds3.extendedDynamicState3ColorWriteMask;
+            case VK_DYNAMIC_STATE_VERTEX_INPUT_EXT: return vertexInputDynamicStateFeatures.vertexInputDynamicState;
+            default: return state <= VK_DYNAMIC_STATE_STENCIL_REFERENCE;  // Vulkan1.0的动态状态
+        }
+    }
+    /**
+     * @brief 向创建信息包添加逻辑设备支持的动态状态，不支持的被跳过，管线使用创建信息中的值
+     * @note 之后须调用pack.UpdateAllArrays()
+     *
+     * @return uint32_t 被添加的动态状态的个数
+     */
+    static uint32_t AddSupported(graphicsPipelineCreateInfoPack& pack, arrayRef<const VkDynamicState> dynamicStates)
+    {
+        uint32_t count = 0;
+        for (size_t i = 0; i < dynamicStates.Count(); i++)
+        {
+            if (!Supported(dynamicStates[i])) { continue; }
+            if (std::find(pack.dynamicStates.begin(), pack.dynamicStates.end(), dynamicStates[i]) ==
+                pack.dynamicStates.end())
+            {
+                pack.dynamicStates.push_back(dynamicStates[i]);
+                count++;
+            }
+        }
+        return count;
+    }
+};
+
+}  // namespace easyVulkan
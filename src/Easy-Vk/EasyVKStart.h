@@ -24,6 +24,7 @@
 #include <format>
 #include <fstream>
 #include <functional>
+#include <initializer_list>
 #include <iostream>
 #include <map>
 #include <memory>
@@ -87,3 +88,133 @@ public:
     // Non-const Function
     arrayRef& operator=(const arrayRef&) = delete;  // 禁止复制/移动赋值
 };
+
+// smallVector
+/*
+元素个数不超过inlineCapacity时存放于对象内部、不分配内存的vector，超出时转移到堆上。
+用于管线创建信息等通常只有少数几个元素、却被大量创建和复制的场合。
+接口是std::vector的子集，元素在对象内部时，移动smallVector会逐个移动元素，指向元素的指针随之失效。
+*/
+template <typename T, size_t inlineCapacity> class smallVector {
+    static_assert(inlineCapacity > 0);
+    alignas(T) std::byte storage[sizeof(T) * inlineCapacity];
+    T*     pData    = reinterpret_cast<T*>(storage);
+    size_t count    = 0;
+    size_t capacity = inlineCapacity;
+
+    bool IsInline() const { return pData == reinterpret_cast<const T*>(storage); }
+    void Release()
+    {
+        std::destroy(pData, pData + count);
+        if (!IsInline()) { std::allocator<T>().deallocate(pData, capacity); }
+        pData    = reinterpret_cast<T*>(storage);
+        count    = 0;
+        capacity = inlineCapacity;
+    }
+    void MoveFrom(smallVector& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (other.IsInline())
+        {
+            std::uninitialized_move(other.pData, other.pData + other.count, pData);
+            count = other.count;
+            other.clear();
+            return;
+        }
+        // 元素在堆上时直接接管
+        pData          = other.pData;
+        count          = other.count;
+        capacity       = other.capacity;
+        other.pData    = reinterpret_cast<T*>(other.storage);
+        other.count    = 0;
+        other.capacity = inlineCapacity;
+    }
+
+public:
+    smallVector() = default;
+    smallVector(std::initializer_list<T> elements) { assign(elements.begin(), elements.end()); }
+    smallVector(const smallVector& other) { assign(other.begin(), other.end()); }
+    smallVector(smallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) { MoveFrom(other); }
+    ~smallVector() { Release(); }
+
+    // Getter
+    size_t size() const { return count; }
+    bool   empty() const { return count == 0; }
+    T*     data() { return pData; }
+    T*     begin() { return pData; }
+    T*     end() { return pData + count; }
+    T&     operator[](size_t index) { return pData[index]; }
+    T&     front() { return pData[0]; }
+    T&     back() { return pData[count - 1]; }
+
+    // Const Function
+    const T* data() const { return pData; }
+    const T* begin() const { return pData; }
+    const T* end() const { return pData + count; }
+    const T& operator[](size_t index) const { return pData[index]; }
+    const T& front() const { return pData[0]; }
+    const T& back() const { return pData[count - 1]; }
+
+    // Non-const Function
+    smallVector& operator=(const smallVector& other)
+    {
+        if (this != &other) { assign(other.begin(), other.end()); }
+        return *this;
+    }
+    smallVector& operator=(smallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (this != &other)
+        {
+            Release();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+    void reserve(size_t newCapacity)
+    {
+        if (newCapacity <= capacity) { return; }
+        T* pNewData = std::allocator<T>().allocate(newCapacity);
+        std::uninitialized_move(pData, pData + count, pNewData);
+        std::destroy(pData, pData + count);
+        if (!IsInline()) { std::allocator<T>().deallocate(pData, capacity); }
+        pData    = pNewData;
+        capacity = newCapacity;
+    }
+    template <typename... Args> T& emplace_back(Args&&... args)
+    {
+        if (count == capacity)
+        {
+            // 参数可能引用自身的元素，先构造新元素再扩容
+            T element(std::forward<Args>(args)...);
+            reserve(capacity * 2);
+            return *::new (static_cast<void*>(pData + count++)) T(std::move(element));
+        }
+        return *::new (static_cast<void*>(pData + count++)) T(std::forward<Args>(args)...);
+    }
+    void push_back(const T& element) { emplace_back(element); }
+    void push_back(T&& element) { emplace_back(std::move(element)); }
+    void pop_back() { std::destroy_at(pData + --count); }
+    void resize(size_t newCount)
+    {
+        if (newCount < count)
+        {
+            std::destroy(pData + newCount, pData + count);
+            count = newCount;
+            return;
+        }
+        reserve(newCount);
+        std::uninitialized_value_construct(pData + count, pData + newCount);
+        count = newCount;
+    }
+    template <typename Iterator> void assign(Iterator first, Iterator last)
+    {
+        clear();
+        reserve(static_cast<size_t>(std::distance(first, last)));
+        std::uninitialized_copy(first, last, pData);
+        count = static_cast<size_t>(std::distance(first, last));
+    }
+    void clear()
+    {
+        std::destroy(pData, pData + count);
+        count = 0;
+    }
+};
@@ -95,7 +95,10 @@ const auto& CreateRpwf_Screen()
         }
     };
     std::function<void()> DestroyFramebuffers = []() {
-        rpwf.framebuffers.clear();  // 清空vector中的元素时会逐一执行析构函数
+        // 旧帧缓冲可能仍被尚未执行完毕的帧使用，移入删除队列，清空vector中的元素时会逐一执行析构函数
+        auto retired = std::make_shared<std::vector<framebuffer>>(std::move(rpwf.framebuffers));
+        rpwf.framebuffers.clear();
+        GraphicsBase::Base().DeferDestruction([retired] { retired->clear(); });
     };
     CreateFramebuffers();
 
@@ -0,0 +1,263 @@
+#pragma once
+#include "EasyVKStart.h"
+#include "VKBase.h"
+
+#include <deque>
+
+using namespace vulkan;
+
+/*
+注重延迟的帧节奏控制：
+1. 每个即时帧（frame in flight）各有一个栅栏和获取图像用的信号量，即时帧的数量可以在运行时改变；
+   呈现所等待的信号量则每张交换链图像各一个，因为只有再次获取到同一张图像时，才能确定等待它的呈现已开始执行
+2. 设备支持VK_KHR_present_id与VK_KHR_present_wait时，每次呈现附上递增的呈现id，
+   BeginFrame()以vkWaitForPresentKHR(...)等到排队等待呈现的帧不多于MaxQueuedFrames()，
+   使CPU在帧即将被需要时才采样输入，而不是比屏幕快上几帧、让输入在队列中过时
+3. BeginFrame()返回的时刻视为输入的采样时刻，到该帧的呈现id完成时的间隔即输入到呈现的延迟
+4. 等待即时帧的栅栏后以GraphicsBase::FramesCompleted(...)告知帧的完成，重建交换链时不必等待GPU闲置，
+   旧的交换链及相关对象在使用它们的帧执行完毕后销毁
+
+渲染循环的写法：
+    pacer.BeginFrame();                           // 等待，然后立即采样输入
+    GraphicsBase::Base().SwapImage(pacer.ImageIsAvailable());
+    ...                                           // 录制命令，提交时等待ImageIsAvailable()，
+                                                  // 置位RenderingIsOver()和InFlightFence()
+    pacer.Present();
+
+不支持呈现等待时，帧节奏仅由即时帧的数量限制，不测量延迟。
+这些扩展须在创建逻辑设备前以EnableDeviceExtensions()开启。
+*/
+
+namespace easyVulkan {
+
+/**
+ * @brief 以呈现等待控制帧节奏，并测量输入到呈现的延迟
+ * @note 须在创建逻辑设备之后构造，且在逻辑设备销毁前析构；不是线程安全的
+ */
+class framePacer {
+    struct frameSync
+    {
+        fence     inFlight{VK_FENCE_CREATE_SIGNALED_BIT};  // 以置位状态创建，首次等待不会阻塞
+        semaphore imageIsAvailable;
+        uint64_t  lastFrame = UINT64_MAX;  // 最近一次使用该即时帧的帧的序号
+    };
+    struct pendingFrame
+    {
+        uint64_t                              presentId;
+        VkSwapchainKHR                        swapchain;  // 交换链重建后，旧交换链上的呈现id不会再完成
+        std::chrono::steady_clock::time_point inputTime;
+    };
+    // 扩展的特性结构体须活过逻辑设备
+    inline static VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR,
+    };
+    inline static VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR,
+    };
+
+    std::vector<std::unique_ptr<frameSync>> frames;
+    std::vector<semaphore>                  renderingIsOver;  // 与交换链图像一一对应
+    VkSwapchainKHR                          renderingIsOverSwapchain = VK_NULL_HANDLE;  // renderingIsOver所对应的交换链
+    uint32_t                                currentFrame             = 0;
+    uint32_t                                maxQueuedFrames          = 1;
+    uint64_t                                timeout                  = 100'000'000;  // 呈现等待的超时，以纳秒计
+    PFN_vkWaitForPresentKHR                 waitForPresent           = nullptr;      // 不支持呈现等待时为空
+    uint64_t                                presentId                = 0;
+    std::deque<pendingFrame>                pendingFrames;  // 已呈现但尚未确认完成的帧
+    std::chrono::steady_clock::time_point   inputTime;
+    double                                  lastLatency        = 0;  // 以毫秒计
+    double                                  averageLatency     = 0;
+    uint64_t                                latencySampleCount = 0;
+
+    void AddLatencySample(double latency)
+    {
+        lastLatency = latency;
+        // 指数移动平均，前若干个样本取算术平均，避免初值的影响
+        double weight  = std::max(1.0 / static_cast<double>(++latencySampleCount), 0.1);
+        averageLatency += (latency - averageLatency) * weight;
+    }
+    /**
+     * @brief 等到排队等待呈现的帧不多于maxQueuedFrames-1，使即将开始的帧入队后不多于maxQueuedFrames
+     * @return result_t 超时、交换链次优或过时视为成功，其他错误（如设备丢失、surface丢失）原样返回
+     */
+    result_t Pace()
+    {
+        VkSwapchainKHR swapchain = GraphicsBase::Base().Swapchain();
+        while (!pendingFrames.empty() && pendingFrames.front().swapchain != swapchain) { pendingFrames.pop_front(); }
+        if (pendingFrames.size() < maxQueuedFrames) { return VK_SUCCESS; }
+
+        pendingFrame target = pendingFrames[pendingFrames.size() - maxQueuedFrames];
+        VkResult     result = waitForPresent(GraphicsBase::Base().Device(), swapchain, target.presentId, timeout);
+        if (result == VK_SUCCESS)
+        {
+            AddLatencySample(
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - target.inputTime).count());
+        }
+        /*
+        超时（如窗口被遮挡时，呈现可能迟迟不完成）或交换链过时的情况下不再等待，也不计入延迟，
+        以免渲染循环被阻塞
+        */
+        while (!pendingFrames.empty() && pendingFrames.front().presentId <= target.presentId)
+        {
+            pendingFrames.pop_front();
+        }
+        switch (result)
+        {
+            case VK_SUCCESS:
+            case VK_TIMEOUT:
+            case VK_SUBOPTIMAL_KHR:
+            case VK_ERROR_OUT_OF_DATE_KHR: return VK_SUCCESS;
+            default:
+                LOG(ERROR) << "[ framePacer ] ERROR\nFailed to wait for present!\nError code: "
+                           << static_cast<int32_t>(result);
+                return result;
+        }
+    }
+
+public:
+    /**
+     * @param framesInFlight 即时帧的数量，即CPU最多领先GPU的帧数
+     * @param maxQueuedFrames 最多排队等待呈现的帧数，为1时每帧都等到上一帧被呈现后才开始，延迟最低
+     */
+    framePacer(uint32_t framesInFlight = 2, uint32_t maxQueuedFrames = 1)
+        : maxQueuedFrames(std::max(maxQueuedFrames, 1U))
+    {
+        for (uint32_t i = 0; i < std::max(framesInFlight, 1U); i++) { frames.push_back(std::make_unique<frameSync>()); }
+        if (PresentWaitSupported())
+        {
+            waitForPresent = reinterpret_cast<PFN_vkWaitForPresentKHR>(
+                vkGetDeviceProcAddr(GraphicsBase::Base().Device(), "vkWaitForPresentKHR"));
+        }
+    }
+    framePacer(const framePacer&)            = delete;
+    framePacer& operator=(const framePacer&) = delete;
+
+    // Getter
+    uint32_t     FramesInFlight() const { return static_cast<uint32_t>(frames.size()); }
+    uint32_t     CurrentFrame() const { return currentFrame; }
+    uint32_t     MaxQueuedFrames() const { return maxQueuedFrames; }
+    bool         PacingEnabled() const { return waitForPresent != nullptr; }
+    const fence& InFlightFence() const { return frames[currentFrame]->inFlight; }
+    VkSemaphore  ImageIsAvailable() const { return frames[currentFrame]->imageIsAvailable; }
+    uint64_t     PresentId() const { return presentId; }
+    /**
+     * @brief 最近一帧的输入到呈现的延迟，以毫秒计，未测量时为0
+     */
+    double   LastLatency() const { return lastLatency; }
+    double   AverageLatency() const { return averageLatency; }
+    uint64_t LatencySampleCount() const { return latencySampleCount; }
+
+    // Non-const Function
+    /**
+     * @brief 当前交换链图像的呈现所等待的信号量，须在SwapImage(...)之后调用
+     * @note 交换链重建后换用一套新的信号量，旧的可能仍被呈现到旧交换链的操作等待，随旧交换链推迟销毁
+     */
+    VkSemaphore RenderingIsOver()
+    {
+        GraphicsBase& base = GraphicsBase::Base();
+        if (renderingIsOverSwapchain != base.Swapchain())
+        {
+            if (!renderingIsOver.empty())
+            {
+                auto pOldSemaphores = std::make_shared<std::vector<semaphore>>(std::move(renderingIsOver));
+                base.DeferDestruction([pOldSemaphores] { pOldSemaphores->clear(); });
+            }
+            renderingIsOver.clear();
+            for (uint32_t i = 0; i < base.SwapchainImageCount(); i++) { renderingIsOver.emplace_back(); }
+            renderingIsOverSwapchain = base.Swapchain();
+        }
+        return renderingIsOver[base.CurrentImageIndex()];
+    }
+    void MaxQueuedFrames(uint32_t count) { maxQueuedFrames = std::max(count, 1U); }
+    void Timeout(uint64_t nanoseconds) { timeout = nanoseconds; }
+    /**
+     * @brief 改变即时帧的数量，会等待逻辑设备闲置，须在两帧之间调用
+     */
+    result_t FramesInFlight(uint32_t count)
+    {
+        count = std::max(count, 1U);
+        if (count == frames.size()) { return VK_SUCCESS; }
+        if (result_t result = GraphicsBase::Base().WaitIdle()) { return result; }
+        GraphicsBase::Base().FramesCompleted(GraphicsBase::Base().FrameCount());
+        frames.resize(std::min<size_t>(count, frames.size()));
+        while (frames.size() < count) { frames.push_back(std::make_unique<frameSync>()); }
+        currentFrame = 0;
+        return VK_SUCCESS;
+    }
+    /**
+     * @brief 开始一帧：等待当前即时帧的栅栏，再按呈现等待控制节奏，返回后应立即采样输入
+     * @note 栅栏在此被重置，须在本帧的提交中置位InFlightFence()；呈现等待的错误（如设备丢失）亦由此返回
+     */
+    result_t BeginFrame()
+    {
+        frameSync& frame = *frames[currentFrame];
+        if (result_t result = frame.inFlight.WaitAndReset()) { return result; }
+        if (frame.lastFrame != UINT64_MAX) { GraphicsBase::Base().FramesCompleted(frame.lastFrame + 1); }
+        if (waitForPresent != nullptr)
+        {
+            if (result_t result = Pace()) { return result; }
+        }
+        inputTime = std::chrono::steady_clock::now();
+        return VK_SUCCESS;
+    }
+    /**
+     * @brief 呈现当前交换链图像，等待RenderingIsOver()，支持时附上呈现id，然后切换到下一个即时帧
+     */
+    result_t Present()
+    {
+        VkSwapchainKHR swapchain                 = GraphicsBase::Base().Swapchain();
+        uint32_t       imageIndex                = GraphicsBase::Base().CurrentImageIndex();
+        VkSemaphore    semaphore_renderingIsOver = RenderingIsOver();
+        uint64_t       currentPresentId          = presentId + 1;
+        VkPresentIdKHR presentIdInfo             = {
+            .sType          = VK_STRUCTURE_TYPE_PRESENT_ID_KHR,
+            .swapchainCount = 1,
+            .pPresentIds    = &currentPresentId,
+        };
+        VkPresentInfoKHR presentInfo = {
+            .pNext              = waitForPresent != nullptr ? &presentIdInfo : nullptr,
+            .waitSemaphoreCount = 1,
+            .pWaitSemaphores    = &semaphore_renderingIsOver,
+            .swapchainCount     = 1,
+            .pSwapchains        = &swapchain,
+            .pImageIndices      = &imageIndex,
+        };
+        if (waitForPresent != nullptr)
+        {
+            presentId = currentPresentId;
+            pendingFrames.push_back({presentId, swapchain, inputTime});
+        }
+        frames[currentFrame]->lastFrame = GraphicsBase::Base().FrameCount();
+        currentFrame                    = (currentFrame + 1) % frames.size();
+        return GraphicsBase::Base().PresentImage(presentInfo);
+    }
+
+    // Static Function
+    /**
+     * @brief 物理设备支持时开启VK_KHR_present_id与VK_KHR_present_wait，须在创建逻辑设备前调用
+     */
+    static result_t EnableDeviceExtensions()
+    {
+        std::vector<const char*> extensions = {
+            VK_KHR_PRESENT_ID_EXTENSION_NAME,
+            VK_KHR_PRESENT_WAIT_EXTENSION_NAME,
+        };
+        if (result_t result = GraphicsBase::Base().CheckDeviceExtensions(extensions)) { return result; }
+        if (extensions[0] == nullptr || extensions[1] == nullptr) { return VK_SUCCESS; }  // 后者依赖前者
+        GraphicsBase::Base().AddDeviceExtension(extensions[0]);
+        GraphicsBase::Base().AddDeviceExtension(extensions[1]);
+        GraphicsBase::Base().AddDeviceFeatures(&presentIdFeatures);
+        GraphicsBase::Base().AddDeviceFeatures(&presentWaitFeatures);
+        return VK_SUCCESS;
+    }
+    /**
+     * @brief 逻辑设备是否开启了呈现等待，须在创建逻辑设备后调用
+     */
+    static bool PresentWaitSupported()
+    {
+        return GraphicsBase::Base().DeviceExtensionEnabled(VK_KHR_PRESENT_WAIT_EXTENSION_NAME) &&
+               presentIdFeatures.presentId != VK_FALSE && presentWaitFeatures.presentWait != VK_FALSE;
+    }
+};
+
+}  // namespace easyVulkan
@@ -1,5 +1,8 @@
 #pragma once
+#include "DynamicState.h"
 #include "EasyVKStart.h"
+#include "FramePacer.h"
+#include "PipelineLibrary.h"
 #include "VKBase.h"
 
 using namespace vulkan;
@@ -35,6 +38,17 @@ bool InitializeVulkan(bool limitFrameRate = true)
     for (size_t i = 0; i < extensionCount; i++) { GraphicsBase::Base().AddInstanceExtension(extensionNames[i]); }
     // 向GraphicsBase添加GLFW设备级扩展
     GraphicsBase::Base().AddDeviceExtension(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    // 可选的实例级扩展，VK_EXT_swapchain_maintenance1依赖VK_EXT_surface_maintenance1，后者又依赖前者
+    std::vector<const char*> optionalInstanceExtensions = {
+        VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME,
+        VK_EXT_SURFACE_MAINTENANCE_1_EXTENSION_NAME,
+    };
+    if (GraphicsBase::Base().CheckInstanceExtensions(optionalInstanceExtensions) != 0) { return false; }
+    if (optionalInstanceExtensions[0] == nullptr) { optionalInstanceExtensions[1] = nullptr; }
+    for (auto i : optionalInstanceExtensions)
+    {
+        if (i != nullptr) { GraphicsBase::Base().AddInstanceExtension(i); }
+    }
     // 创建Vulkan Instance
     GraphicsBase::Base().UseLatestApiVersion();
     if (GraphicsBase::Base().CreateInstance() != 0)
@@ -55,11 +69,29 @@ bool InitializeVulkan(bool limitFrameRate = true)
 
     // 查找物理设备并创建逻辑设备
     if ((GraphicsBase::Base().GetPhysicalDevices() != 0)  // 获取物理设备，并使用列表中的第一个物理设备
-        || (GraphicsBase::Base().DeterminePhysicalDevice(0, true, false) != 0)  // 暂时不需要计算用的队列
-        || (GraphicsBase::Base().CreateDevice() != 0))                          // 创建逻辑设备
+        || (GraphicsBase::Base().DeterminePhysicalDevice(0, true, false) != 0))  // 暂时不需要计算用的队列
     {
         return false;
     }
+    // 可选的设备级扩展，物理设备支持时才开启
+    std::vector<const char*> optionalDeviceExtensions = {
+        VK_EXT_MEMORY_BUDGET_EXTENSION_NAME,
+        VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME,  // Vulkan1.3中为核心功能
+        VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME,     // 以呈现栅栏判断旧交换链何时可被销毁
+    };
+    if (GraphicsBase::Base().CheckDeviceExtensions(optionalDeviceExtensions) != 0) { return false; }
+    if (optionalInstanceExtensions[1] == nullptr) { optionalDeviceExtensions[2] = nullptr; }
+    for (auto i : optionalDeviceExtensions)
+    {
+        if (i != nullptr) { GraphicsBase::Base().AddDeviceExtension(i); }
+    }
+    if (optionalDeviceExtensions[2] != nullptr) { GraphicsBase::Base().AddSwapchainMaintenance1Features(); }
+    // 供pipelineExecutableReport诊断着色器开销
+    if (pipelineExecutableReport::EnableDeviceExtensions() != 0) { return false; }
+    if (easyVulkan::dynamicStateRecorder::EnableDeviceExtensions() != 0) { return false; }
+    if (easyVulkan::framePacer::EnableDeviceExtensions() != 0) { return false; }
+    if (easyVulkan::pipelineLibraryCache::EnableDeviceExtensions() != 0) { return false; }
+    if (GraphicsBase::Base().CreateDevice() != 0) { return false; }  // 创建逻辑设备
 
     // 创建交换链
     if (GraphicsBase::Base().CreateSwapchain(limitFrameRate) != 0) { return false; }
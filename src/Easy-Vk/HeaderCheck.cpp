@@ -0,0 +1,16 @@
+/*
+main.cpp没有包含的头文件在此各自编译一次，使其中的错误在构建时即被发现，而不是等到被用到时才暴露。
+头文件中的函数和变量须为inline或模板，否则被多个编译单元包含时会在链接时重复定义。
+不要在本文件中定义STB_IMAGE_IMPLEMENTATION，stb_image的实现已在main.cpp中展开。
+*/
+#include "AsyncPipelineCompiler.h"
+#include "ClusterCulling.h"
+#include "MeshCache.h"
+#include "MipmapGenerator.h"
+#include "PipelineLibrary.h"
+#include "PipelineManifest.h"
+#include "PipelineRegistry.h"
+#include "ShaderPermutations.h"
+#include "TextureAtlas.h"
+#include "TextureLoader.h"
+#include "TextureStreaming.h"
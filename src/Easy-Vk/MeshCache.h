@@ -0,0 +1,790 @@
+#pragma once
+#include "EasyVKStart.h"
+#include "VKBase+.h"
+#include "MeshOptimizer.h"
+#include "VKBase.h"
+#include "VertexFormat.h"
+
+// Assimp
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+#include <filesystem>
+
+using namespace vulkan;
+
+namespace easyVulkan {
+
+/**
+ * @brief 网格顶点，各属性皆为32位浮点数
+ */
+struct meshVertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec4 tangent;  // w分量为副切线的方向（±1）
+    glm::vec2 texCoord;
+    glm::vec4 color;
+};
+
+/**
+ * @brief 取得meshVertex各属性的描述，location的约定见VertexFormat.h
+ */
+inline std::vector<vertexAttribute> FullVertexAttributes()
+{
+    return {
+        {0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(meshVertex, position)},
+        {1, VK_FORMAT_R32G32B32_SFLOAT, offsetof(meshVertex, normal)},
+        {2, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(meshVertex, tangent)},
+        {3, VK_FORMAT_R32G32_SFLOAT, offsetof(meshVertex, texCoord)},
+        {4, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(meshVertex, color)},
+    };
+}
+
+/**
+ * @brief 子网格，对应Assimp场景中的一个aiMesh，可用一次vkCmdDrawIndexed(...)绘制
+ */
+struct subMesh
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    int32_t  vertexOffset;  // 子网格的索引相对于该偏移量，因此顶点数不超过65536的子网格可以使用16位索引
+    uint32_t vertexCount;
+    uint32_t materialIndex;
+};
+
+/**
+ * @brief 子网格的一级LOD，各级LOD共用子网格的顶点，只是索引不同
+ * @note 绘制时firstIndex和indexCount取自meshLod，vertexOffset取所属子网格的
+ */
+struct meshLod
+{
+    uint32_t subMeshIndex;
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float    error;  // 相对于原网格的误差，为模型空间中的距离，第0级为0
+};
+
+/**
+ * @brief 导入后、写入缓存前，在CPU一侧处理的网格数据
+ */
+struct meshData
+{
+    std::vector<meshVertex> vertices;
+    std::vector<uint32_t>   indices;
+    std::vector<subMesh>    subMeshes;
+    std::vector<meshlet>    meshlets;
+    std::vector<meshLod>    lods;  // 按子网格、级别排序，各级LOD的索引位于所有第0级索引之后
+    glm::vec3               boundsMin = glm::vec3(FLT_MAX);
+    glm::vec3               boundsMax = glm::vec3(-FLT_MAX);
+};
+
+/*
+网格缓存文件的布局：
+    meshCacheHeader
+    meshCacheSection[sectionCount]
+    各区段的数据，每段的起始位置按meshCacheAlignment对齐
+
+顶点和索引区段的内容与上传到GPU的缓冲区中的内容逐字节相同，因此加载时只需映射文件，
+再把这两段复制到暂存缓冲区，不需要任何解析。任何改变文件布局的修改都须递增meshCacheVersion，
+旧版本的缓存会被视作无效并重新生成。
+*/
+constexpr uint32_t meshCacheMagic     = 0x434d5645;  // "EVMC"
+constexpr uint32_t meshCacheVersion   = 5;
+constexpr uint64_t meshCacheAlignment = 16;
+
+enum class meshCacheSectionType : uint32_t {
+    vertices,
+    indices,
+    subMeshes,
+    vertexAttributes,  // vertexAttribute[]，按其生成VkVertexInputAttributeDescription
+    meshlets,          // meshlet[]，供ClusterCulling.h中的GPU剔除使用，包围体在模型空间中，不受顶点量化的影响
+    lods,              // meshLod[]，网格簇只针对第0级LOD
+};
+
+struct meshCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sourceHash;   // 源文件内容的哈希，源文件被修改后缓存随之失效
+    uint64_t optionsHash;  // 导入选项的哈希，改变后缓存同样失效
+    uint32_t vertexStride;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t indexType;  // VkIndexType
+    uint32_t subMeshCount;
+    uint32_t sectionCount;
+    uint32_t vertexFormat;  // easyVulkan::vertexFormat
+    uint32_t importFlags;   // 导入时所用的Assimp后处理标志
+    uint32_t reserved;
+    float    boundsMin[3];
+    float    boundsMax[3];
+    uint32_t padding;  // 显式填充至8字节对齐，使写入文件的每个字节都有确定的值
+};
+static_assert(sizeof(meshCacheHeader) == 88);
+
+struct meshCacheSection
+{
+    meshCacheSectionType type;
+    uint32_t             reserved;
+    uint64_t             offset;  // 相对于文件起始位置
+    uint64_t             size;
+};
+
+/**
+ * @brief 导入网格时默认使用的Assimp后处理标志
+ * @note aiProcess_PreTransformVertices将节点层级展平为静态网格；
+ * aiProcess_FlipUVs使纹理坐标的原点位于左上角，与Vulkan中图像的行序一致。
+ */
+constexpr uint32_t defaultMeshImportFlags = aiProcess_Triangulate | aiProcess_JoinIdenticalVertices |
+                                            aiProcess_GenSmoothNormals | aiProcess_CalcTangentSpace |
+                                            aiProcess_PreTransformVertices | aiProcess_SortByPType | aiProcess_FlipUVs;
+
+/**
+ * @brief 导入网格时的选项，任何一项改变都会使已有的缓存失效
+ */
+struct meshImportOptions
+{
+    uint32_t                 importFlags  = defaultMeshImportFlags;
+    easyVulkan::vertexFormat vertexFormat = easyVulkan::vertexFormat::full;
+    // 网格优化，见MeshOptimizer.h
+    bool  optimizeVertexCache = true;
+    bool  optimizeOverdraw    = false;  // 对需要排序的半透明物体无意义，且会使顶点缓存命中率略微变差，因此默认关闭
+    float overdrawThreshold   = 1.05F;
+    bool  optimizeVertexFetch = true;
+    // 网格簇，见BuildMeshlets(...)
+    bool     buildMeshlets       = true;
+    uint32_t meshletMaxVertices  = defaultMeshletMaxVertices;
+    uint32_t meshletMaxTriangles = defaultMeshletMaxTriangles;
+    // LOD链，见BuildLods(...)
+    uint32_t lodCount     = 4;      // 包括第0级，为1时不生成LOD
+    float    lodReduction = 0.5F;   // 每一级的目标三角形数相对于上一级的比例
+    float    lodMaxError  = 0.05F;  // 误差上限，相对于网格包围盒的对角线长度
+
+    uint64_t Hash() const
+    {
+        uint64_t hash = HashBytes(&importFlags, sizeof importFlags);
+        hash          = HashBytes(&vertexFormat, sizeof vertexFormat, hash);
+        hash          = HashBytes(&optimizeVertexCache, sizeof optimizeVertexCache, hash);
+        hash          = HashBytes(&optimizeOverdraw, sizeof optimizeOverdraw, hash);
+        hash          = HashBytes(&overdrawThreshold, sizeof overdrawThreshold, hash);
+        hash          = HashBytes(&optimizeVertexFetch, sizeof optimizeVertexFetch, hash);
+        hash          = HashBytes(&buildMeshlets, sizeof buildMeshlets, hash);
+        hash          = HashBytes(&meshletMaxVertices, sizeof meshletMaxVertices, hash);
+        hash          = HashBytes(&meshletMaxTriangles, sizeof meshletMaxTriangles, hash);
+        hash          = HashBytes(&lodCount, sizeof lodCount, hash);
+        hash          = HashBytes(&lodReduction, sizeof lodReduction, hash);
+        return HashBytes(&lodMaxError, sizeof lodMaxError, hash);
+    }
+};
+
+/**
+ * @brief 用Assimp导入模型文件，将其中所有的三角形网格合并到同一个meshData
+ */
+inline result_t ImportMesh(const char* filepath, meshData& mesh, uint32_t importFlags = defaultMeshImportFlags)
+{
+    Assimp::Importer importer;
+    importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_POINT | aiPrimitiveType_LINE);
+    const aiScene* pScene = importer.ReadFile(filepath, importFlags);
+    if (pScene == nullptr || ((pScene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) != 0U))
+    {
+        LOG(ERROR) << "[ ImportMesh ] ERROR\nFailed to import the file: " << filepath << "\n"
+                   << importer.GetErrorString();
+        return VK_RESULT_MAX_ENUM;
+    }
+
+    mesh = {};
+    for (uint32_t m = 0; m < pScene->mNumMeshes; m++)
+    {
+        const aiMesh* pMesh = pScene->mMeshes[m];
+        if ((pMesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE) == 0U) { continue; }
+
+        subMesh part = {
+            .firstIndex    = static_cast<uint32_t>(mesh.indices.size()),
+            .vertexOffset  = static_cast<int32_t>(mesh.vertices.size()),
+            .vertexCount   = pMesh->mNumVertices,
+            .materialIndex = pMesh->mMaterialIndex,
+        };
+
+        for (uint32_t i = 0; i < pMesh->mNumVertices; i++)
+        {
+            meshVertex vertex = {};
+            vertex.position   = glm::vec3(pMesh->mVertices[i].x, pMesh->mVertices[i].y, pMesh->mVertices[i].z);
+            if (pMesh->HasNormals())
+            {
+                vertex.normal = glm::vec3(pMesh->mNormals[i].x, pMesh->mNormals[i].y, pMesh->mNormals[i].z);
+            }
+            if (pMesh->HasTangentsAndBitangents())
+            {
+                glm::vec3 tangent(pMesh->mTangents[i].x, pMesh->mTangents[i].y, pMesh->mTangents[i].z);
+                glm::vec3 bitangent(pMesh->mBitangents[i].x, pMesh->mBitangents[i].y, pMesh->mBitangents[i].z);
+                // 只保存切线和手性，副切线在着色器中由cross(normal, tangent) * w重建
+                float handedness = glm::dot(glm::cross(vertex.normal, tangent), bitangent) < 0.F ? -1.F : 1.F;
+                vertex.tangent   = glm::vec4(tangent, handedness);
+            }
+            if (pMesh->HasTextureCoords(0))
+            {
+                vertex.texCoord = glm::vec2(pMesh->mTextureCoords[0][i].x, pMesh->mTextureCoords[0][i].y);
+            }
+            vertex.color = pMesh->HasVertexColors(0) ? glm::vec4(pMesh->mColors[0][i].r, pMesh->mColors[0][i].g,
+                                                                 pMesh->mColors[0][i].b, pMesh->mColors[0][i].a) :
+                                                       glm::vec4(1.F);
+            mesh.boundsMin = glm::min(mesh.boundsMin, vertex.position);
+            mesh.boundsMax = glm::max(mesh.boundsMax, vertex.position);
+            mesh.vertices.push_back(vertex);
+        }
+
+        for (uint32_t i = 0; i < pMesh->mNumFaces; i++)
+        {
+            const aiFace& face = pMesh->mFaces[i];
+            if (face.mNumIndices != 3) { continue; }
+            mesh.indices.insert(mesh.indices.end(), face.mIndices, face.mIndices + 3);
+        }
+        part.indexCount = static_cast<uint32_t>(mesh.indices.size()) - part.firstIndex;
+        mesh.subMeshes.push_back(part);
+    }
+
+    if (mesh.indices.empty())
+    {
+        LOG(ERROR) << "[ ImportMesh ] ERROR\nNo triangle mesh found in the file: " << filepath;
+        return VK_RESULT_MAX_ENUM;
+    }
+    return VK_SUCCESS;
+}
+
+/**
+ * @brief 网格优化前后的顶点缓存统计
+ */
+struct meshOptimizationStatistics
+{
+    vertexCacheStatistics before;
+    vertexCacheStatistics after;
+};
+
+/**
+ * @brief 对每个子网格依次进行顶点缓存、过度绘制、顶点获取优化，并报告优化前后的ACMR和ATVR
+ */
+inline meshOptimizationStatistics OptimizeMesh(meshData& mesh, const meshImportOptions& options)
+{
+    meshOptimizationStatistics statistics;
+    if (!options.optimizeVertexCache && !options.optimizeOverdraw && !options.optimizeVertexFetch)
+    {
+        return statistics;
+    }
+
+    size_t                  triangleCount     = 0;
+    size_t                  vertexCountBefore = 0;
+    std::vector<meshVertex> newVertices;
+    newVertices.reserve(mesh.vertices.size());
+    for (auto& part : mesh.subMeshes)
+    {
+        uint32_t* pIndices = mesh.indices.data() + part.firstIndex;
+        triangleCount += part.indexCount / 3;
+        vertexCountBefore += part.vertexCount;
+        statistics.before.cacheMisses += AnalyzeVertexCache(pIndices, part.indexCount, part.vertexCount).cacheMisses;
+
+        if (options.optimizeVertexCache) { OptimizeVertexCache(pIndices, part.indexCount, part.vertexCount); }
+        if (options.optimizeOverdraw)
+        {
+            OptimizeOverdraw(pIndices, part.indexCount, &mesh.vertices[part.vertexOffset].position.x, part.vertexCount,
+                             sizeof(meshVertex), options.overdrawThreshold);
+        }
+
+        std::vector<meshVertex> vertices(mesh.vertices.begin() + part.vertexOffset,
+                                         mesh.vertices.begin() + part.vertexOffset + part.vertexCount);
+        if (options.optimizeVertexFetch) { part.vertexCount = OptimizeVertexFetch(pIndices, part.indexCount, vertices); }
+        part.vertexOffset = static_cast<int32_t>(newVertices.size());
+        newVertices.insert(newVertices.end(), vertices.begin(), vertices.end());
+
+        statistics.after.cacheMisses += AnalyzeVertexCache(pIndices, part.indexCount, part.vertexCount).cacheMisses;
+    }
+    mesh.vertices.swap(newVertices);
+
+    if (triangleCount != 0)
+    {
+        auto missesBefore      = static_cast<float>(statistics.before.cacheMisses);
+        auto missesAfter       = static_cast<float>(statistics.after.cacheMisses);
+        statistics.before.acmr = missesBefore / static_cast<float>(triangleCount);
+        statistics.before.atvr = missesBefore / static_cast<float>(vertexCountBefore);
+        statistics.after.acmr  = missesAfter / static_cast<float>(triangleCount);
+        statistics.after.atvr  = missesAfter / static_cast<float>(mesh.vertices.size());
+    }
+    LOG(INFO) << "[ OptimizeMesh ] INFO\nACMR: " << statistics.before.acmr << " -> " << statistics.after.acmr
+              << "\nATVR: " << statistics.before.atvr << " -> " << statistics.after.atvr;
+    return statistics;
+}
+
+/**
+ * @brief 逐个子网格生成网格簇，须在OptimizeMesh(...)之后调用
+ */
+inline void BuildMeshlets(meshData& mesh, uint32_t maxVertices, uint32_t maxTriangles)
+{
+    mesh.meshlets.clear();
+    for (size_t i = 0; i < mesh.subMeshes.size(); i++)
+    {
+        const subMesh& part  = mesh.subMeshes[i];
+        size_t         count = BuildMeshlets(mesh.meshlets, mesh.indices.data() + part.firstIndex, part.indexCount,
+                                             &mesh.vertices[part.vertexOffset].position.x, part.vertexCount,
+                                             sizeof(meshVertex), maxVertices, maxTriangles);
+        for (auto j = mesh.meshlets.end() - static_cast<ptrdiff_t>(count); j != mesh.meshlets.end(); ++j)
+        {
+            j->firstIndex += part.firstIndex;
+            j->vertexOffset = part.vertexOffset;
+            j->subMeshIndex = static_cast<uint32_t>(i);
+        }
+    }
+    LOG(INFO) << "[ BuildMeshlets ] INFO\nMeshlet count: " << mesh.meshlets.size();
+}
+
+/**
+ * @brief 为每个子网格生成LOD链，须在OptimizeMesh(...)和BuildMeshlets(...)之后调用
+ * @note 各级都从第0级开始简化，误差因而是相对于原网格的。简化后的三角形数下降不足5%时，该子网格的LOD链到此为止。
+ */
+inline void BuildLods(meshData& mesh, uint32_t lodCount, float lodReduction, float lodMaxError)
+{
+    mesh.lods.clear();
+    float                 maxError       = lodMaxError * glm::length(mesh.boundsMax - mesh.boundsMin);
+    size_t                lod0IndexCount = mesh.indices.size();
+    std::vector<uint32_t> lodIndices;
+    for (size_t i = 0; i < mesh.subMeshes.size(); i++)
+    {
+        const subMesh& part = mesh.subMeshes[i];
+        mesh.lods.push_back({static_cast<uint32_t>(i), part.firstIndex, part.indexCount, 0.F});
+        const uint32_t* pIndices         = mesh.indices.data() + part.firstIndex;
+        size_t          targetIndexCount = part.indexCount;
+        size_t          lastIndexCount   = part.indexCount;
+        for (uint32_t level = 1; level < lodCount; level++)
+        {
+            targetIndexCount = static_cast<size_t>(static_cast<float>(targetIndexCount) * lodReduction) / 3 * 3;
+            float error      = 0.F;
+            auto  simplified = SimplifyMesh(pIndices, part.indexCount, &mesh.vertices[part.vertexOffset].position.x,
+                                            part.vertexCount, sizeof(meshVertex), targetIndexCount, maxError, error);
+            if (simplified.empty() || simplified.size() * 20 > lastIndexCount * 19) { break; }
+            OptimizeVertexCache(simplified.data(), simplified.size(), part.vertexCount);
+            mesh.lods.push_back({static_cast<uint32_t>(i), static_cast<uint32_t>(lod0IndexCount + lodIndices.size()),
+                                 static_cast<uint32_t>(simplified.size()), error});
+            lodIndices.insert(lodIndices.end(), simplified.begin(), simplified.end());
+            lastIndexCount = simplified.size();
+        }
+    }
+    mesh.indices.insert(mesh.indices.end(), lodIndices.begin(), lodIndices.end());
+    LOG(INFO) << "[ BuildLods ] INFO\nLOD count: " << mesh.lods.size() << "\nIndex count: " << lod0IndexCount
+              << " -> " << mesh.indices.size();
+}
+
+/**
+ * @brief 逐区段收集数据，最后一次性写出网格缓存文件
+ * @note 只保存数据的指针，调用Write(...)前须确保各数据仍然存活
+ */
+class meshCacheWriter {
+    struct pendingSection
+    {
+        meshCacheSectionType type;
+        const void*          pData;
+        size_t               size;
+    };
+    std::vector<pendingSection> sections;
+
+    static uint64_t AlignUp(uint64_t value) { return (value + meshCacheAlignment - 1) & ~(meshCacheAlignment - 1); }
+
+public:
+    void AddSection(meshCacheSectionType type, const void* pData, size_t size)
+    {
+        sections.push_back({type, pData, size});
+    }
+
+    /**
+     * @brief 先写入临时文件再重命名，以免中途失败时留下不完整的缓存
+     */
+    result_t Write(const char* cachePath, meshCacheHeader header) const
+    {
+        header.magic        = meshCacheMagic;
+        header.version      = meshCacheVersion;
+        header.sectionCount = static_cast<uint32_t>(sections.size());
+
+        std::vector<meshCacheSection> sectionTable(sections.size());
+        uint64_t offset = AlignUp(sizeof(meshCacheHeader) + sizeof(meshCacheSection) * sections.size());
+        for (size_t i = 0; i < sections.size(); i++)
+        {
+            sectionTable[i] = {sections[i].type, 0, offset, sections[i].size};
+            offset          = AlignUp(offset + sections[i].size);
+        }
+
+        std::string   temporaryPath = std::string(cachePath) + ".tmp";
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            LOG(ERROR) << "[ meshCacheWriter ] ERROR\nFailed to create the file: " << temporaryPath;
+            return VK_RESULT_MAX_ENUM;
+        }
+        static constexpr char padding[meshCacheAlignment] = {};
+        file.write(reinterpret_cast<const char*>(&header), sizeof header);
+        file.write(reinterpret_cast<const char*>(sectionTable.data()),
+                   static_cast<std::streamsize>(sizeof(meshCacheSection) * sectionTable.size()));
+        uint64_t written = sizeof header + sizeof(meshCacheSection) * sectionTable.size();
+        for (size_t i = 0; i < sections.size(); i++)
+        {
+            file.write(padding, static_cast<std::streamsize>(sectionTable[i].offset - written));
+            file.write(static_cast<const char*>(sections[i].pData), static_cast<std::streamsize>(sections[i].size));
+            written = sectionTable[i].offset + sections[i].size;
+        }
+        file.close();
+        if (!file)
+        {
+            LOG(ERROR) << "[ meshCacheWriter ] ERROR\nFailed to write the file: " << temporaryPath;
+            return VK_RESULT_MAX_ENUM;
+        }
+
+        std::error_code errorCode;
+        std::filesystem::rename(temporaryPath, cachePath, errorCode);
+        if (errorCode)
+        {
+            LOG(ERROR) << "[ meshCacheWriter ] ERROR\nFailed to replace the file: " << cachePath << "\n"
+                       << errorCode.message();
+            return VK_RESULT_MAX_ENUM;
+        }
+        return VK_SUCCESS;
+    }
+};
+
+/**
+ * @brief 将meshData写入网格缓存，索引在所有子网格的顶点数都不超过65536时以16位存储
+ */
+inline result_t WriteMeshCache(const char*              cachePath,
+                               const meshData&          mesh,
+                               uint64_t                 sourceHash,
+                               const meshImportOptions& options)
+{
+    bool use16BitIndices = true;
+    for (const auto& i : mesh.subMeshes) { use16BitIndices &= i.vertexCount <= 65536; }
+
+    std::vector<uint16_t> indices16;
+    if (use16BitIndices) { indices16.assign(mesh.indices.begin(), mesh.indices.end()); }
+
+    // 按所选的格式准备顶点数据
+    std::vector<compactVertex>   compactVertices;
+    std::vector<vertexAttribute> attributes;
+    const void*                  pVertexData  = mesh.vertices.data();
+    uint32_t                     vertexStride = sizeof(meshVertex);
+    if (options.vertexFormat == vertexFormat::compact)
+    {
+        glm::vec3 center            = (mesh.boundsMin + mesh.boundsMax) * 0.5F;
+        glm::vec3 inverseHalfExtent = 1.F / glm::max((mesh.boundsMax - mesh.boundsMin) * 0.5F, glm::vec3(FLT_MIN));
+        bool      texCoordsAsHalf   = !TexCoordsFitUnorm(&mesh.vertices.data()->texCoord, mesh.vertices.size(),
+                                                         sizeof(meshVertex));
+        compactVertices.reserve(mesh.vertices.size());
+        for (const auto& i : mesh.vertices)
+        {
+            compactVertices.push_back(QuantizeVertex(i.position, i.normal, i.tangent, i.texCoord, i.color, center,
+                                                     inverseHalfExtent, texCoordsAsHalf));
+        }
+        attributes   = CompactVertexAttributes(texCoordsAsHalf);
+        pVertexData  = compactVertices.data();
+        vertexStride = sizeof(compactVertex);
+    }
+    else { attributes = FullVertexAttributes(); }
+
+    // 未列出的成员（包括reserved和padding）被值初始化为0，相同的输入总是写出相同的缓存
+    meshCacheHeader header = {
+        .sourceHash   = sourceHash,
+        .optionsHash  = options.Hash(),
+        .vertexStride = vertexStride,
+        .vertexCount  = static_cast<uint32_t>(mesh.vertices.size()),
+        .indexCount   = static_cast<uint32_t>(mesh.indices.size()),
+        .indexType    = static_cast<uint32_t>(use16BitIndices ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32),
+        .subMeshCount = static_cast<uint32_t>(mesh.subMeshes.size()),
+        .vertexFormat = static_cast<uint32_t>(options.vertexFormat),
+        .importFlags  = options.importFlags,
+        .boundsMin    = {mesh.boundsMin.x, mesh.boundsMin.y, mesh.boundsMin.z},
+        .boundsMax    = {mesh.boundsMax.x, mesh.boundsMax.y, mesh.boundsMax.z},
+    };
+
+    meshCacheWriter writer;
+    writer.AddSection(meshCacheSectionType::vertices, pVertexData,
+                      static_cast<size_t>(vertexStride) * mesh.vertices.size());
+    if (use16BitIndices)
+    {
+        writer.AddSection(meshCacheSectionType::indices, indices16.data(), sizeof(uint16_t) * indices16.size());
+    }
+    else
+    {
+        writer.AddSection(meshCacheSectionType::indices, mesh.indices.data(), sizeof(uint32_t) * mesh.indices.size());
+    }
+    writer.AddSection(meshCacheSectionType::subMeshes, mesh.subMeshes.data(), sizeof(subMesh) * mesh.subMeshes.size());
+    writer.AddSection(meshCacheSectionType::vertexAttributes, attributes.data(),
+                      sizeof(vertexAttribute) * attributes.size());
+    if (!mesh.meshlets.empty())
+    {
+        writer.AddSection(meshCacheSectionType::meshlets, mesh.meshlets.data(), sizeof(meshlet) * mesh.meshlets.size());
+    }
+    if (!mesh.lods.empty())
+    {
+        writer.AddSection(meshCacheSectionType::lods, mesh.lods.data(), sizeof(meshLod) * mesh.lods.size());
+    }
+    return writer.Write(cachePath, header);
+}
+
+/**
+ * @brief 以内存映射方式打开的网格缓存，各区段的数据直接指向映射的文件
+ */
+class meshCache {
+    mappedFile              file;
+    const meshCacheHeader*  pHeader   = nullptr;
+    const meshCacheSection* pSections = nullptr;
+
+public:
+    meshCache() = default;
+    meshCache(meshCache&& other) noexcept
+        : file(std::move(other.file)), pHeader(other.pHeader), pSections(other.pSections)
+    {
+        other.pHeader   = nullptr;
+        other.pSections = nullptr;
+    }
+
+    // Getter
+    bool                   IsOpen() const { return pHeader != nullptr; }
+    const meshCacheHeader& Header() const { return *pHeader; }
+    VkIndexType            IndexType() const { return static_cast<VkIndexType>(pHeader->indexType); }
+
+    // Const Function
+    /**
+     * @brief 取得某一区段的原始字节，区段不存在时返回空的arrayRef
+     */
+    arrayRef<const uint8_t> SectionData(meshCacheSectionType type) const
+    {
+        for (uint32_t i = 0; i < pHeader->sectionCount; i++)
+        {
+            if (pSections[i].type == type)
+            {
+                return {file.Data() + pSections[i].offset, static_cast<size_t>(pSections[i].size)};
+            }
+        }
+        return {};
+    }
+    template <typename T> arrayRef<const T> Section(meshCacheSectionType type) const
+    {
+        auto data = SectionData(type);
+        return {reinterpret_cast<const T*>(data.Pointer()), data.Count() / sizeof(T)};
+    }
+    arrayRef<const subMesh> SubMeshes() const { return Section<subMesh>(meshCacheSectionType::subMeshes); }
+    arrayRef<const meshlet> Meshlets() const { return Section<meshlet>(meshCacheSectionType::meshlets); }
+    /**
+     * @brief 取得某一子网格的各级LOD，缓存中没有LOD时返回空的arrayRef
+     */
+    arrayRef<const meshLod> Lods(uint32_t subMeshIndex) const
+    {
+        auto   lods  = Section<meshLod>(meshCacheSectionType::lods);
+        size_t first = 0;
+        while (first < lods.Count() && lods[first].subMeshIndex != subMeshIndex) { first++; }
+        size_t count = 0;
+        while (first + count < lods.Count() && lods[first + count].subMeshIndex == subMeshIndex) { count++; }
+        return {lods.Pointer() + first, count};
+    }
+    /**
+     * @brief 模型空间中网格的包围球，xyz为球心，w为半径
+     */
+    glm::vec4 BoundingSphere() const
+    {
+        glm::vec3 boundsMin(pHeader->boundsMin[0], pHeader->boundsMin[1], pHeader->boundsMin[2]);
+        glm::vec3 boundsMax(pHeader->boundsMax[0], pHeader->boundsMax[1], pHeader->boundsMax[2]);
+        return glm::vec4((boundsMin + boundsMax) * 0.5F, glm::length(boundsMax - boundsMin) * 0.5F);
+    }
+    vertexFormat            VertexFormat() const { return static_cast<vertexFormat>(pHeader->vertexFormat); }
+    /**
+     * @brief 将量化的坐标还原到模型空间的矩阵，右乘到模型矩阵上使用，非compact格式时为单位矩阵
+     */
+    glm::mat4 PositionDequantization() const
+    {
+        if (VertexFormat() != vertexFormat::compact) { return glm::mat4(1.F); }
+        glm::vec3 boundsMin(pHeader->boundsMin[0], pHeader->boundsMin[1], pHeader->boundsMin[2]);
+        glm::vec3 boundsMax(pHeader->boundsMax[0], pHeader->boundsMax[1], pHeader->boundsMax[2]);
+        glm::vec3 halfExtent = glm::max((boundsMax - boundsMin) * 0.5F, glm::vec3(FLT_MIN));
+        return glm::scale(glm::translate(glm::mat4(1.F), (boundsMin + boundsMax) * 0.5F), halfExtent);
+    }
+    /**
+     * @brief 按缓存中记录的顶点格式，向管线创建信息中添加顶点绑定和顶点属性
+     */
+    void FillVertexInput(graphicsPipelineCreateInfoPack& pipelineCiPack, uint32_t binding = 0) const
+    {
+        pipelineCiPack.vertexInputBindings.push_back({binding, pHeader->vertexStride, VK_VERTEX_INPUT_RATE_VERTEX});
+        for (const auto& i : Section<vertexAttribute>(meshCacheSectionType::vertexAttributes))
+        {
+            pipelineCiPack.vertexInputAttributes.push_back({i.location, binding, i.format, i.offset});
+        }
+    }
+
+    // Non-const Function
+    /**
+     * @brief 映射缓存文件并检查其结构，不检查缓存是否与源文件对应
+     */
+    result_t Open(const char* cachePath)
+    {
+        Close();
+        if (result_t result = file.Open(cachePath)) { return result; }
+        if (file.Size() < sizeof(meshCacheHeader)) { return Invalidate(cachePath, "truncated header"); }
+        pHeader = reinterpret_cast<const meshCacheHeader*>(file.Data());
+        if (pHeader->magic != meshCacheMagic) { return Invalidate(cachePath, "bad magic number"); }
+        if (pHeader->version != meshCacheVersion) { return Invalidate(cachePath, "version mismatch"); }
+        if (file.Size() < sizeof(meshCacheHeader) + sizeof(meshCacheSection) * pHeader->sectionCount)
+        {
+            return Invalidate(cachePath, "truncated section table");
+        }
+        pSections = reinterpret_cast<const meshCacheSection*>(file.Data() + sizeof(meshCacheHeader));
+        for (uint32_t i = 0; i < pHeader->sectionCount; i++)
+        {
+            if (pSections[i].offset + pSections[i].size > file.Size())
+            {
+                return Invalidate(cachePath, "truncated section data");
+            }
+        }
+        return VK_SUCCESS;
+    }
+    void Close()
+    {
+        file.Close();
+        pHeader   = nullptr;
+        pSections = nullptr;
+    }
+
+private:
+    result_t Invalidate(const char* cachePath, const char* reason)
+    {
+        LOG(WARNING) << "[ meshCache ] WARNING\nIgnoring the mesh cache: " << cachePath << " (" << reason << ")";
+        Close();
+        return VK_RESULT_MAX_ENUM;
+    }
+};
+
+/**
+ * @brief 加载网格：缓存有效时直接映射缓存，否则用Assimp导入源文件并重新生成缓存
+ *
+ * @param cachePath 缺省时为源文件路径加上.evmesh后缀
+ */
+inline result_t LoadMesh(const char*              sourcePath,
+                         meshCache&               cache,
+                         const meshImportOptions& options   = {},
+                         const char*              cachePath = nullptr)
+{
+    std::string _cachePath = (cachePath != nullptr) ? cachePath : std::string(sourcePath) + ".evmesh";
+
+    uint64_t sourceHash = 0;
+    {
+        mappedFile source;
+        if (result_t result = source.Open(sourcePath)) { return result; }
+        sourceHash = HashBytes(source.Data(), source.Size());
+    }
+
+    if (std::filesystem::exists(_cachePath) && cache.Open(_cachePath.c_str()) == VK_SUCCESS)
+    {
+        if (cache.Header().sourceHash == sourceHash && cache.Header().optionsHash == options.Hash())
+        {
+            return VK_SUCCESS;
+        }
+        LOG(INFO) << "[ LoadMesh ] INFO\nThe source file or import options have changed, rebuilding the mesh cache: "
+                  << _cachePath;
+    }
+    cache.Close();  // Windows下，映射中的文件无法被替换
+
+    meshData mesh;
+    if (result_t result = ImportMesh(sourcePath, mesh, options.importFlags)) { return result; }
+    OptimizeMesh(mesh, options);
+    if (options.buildMeshlets) { BuildMeshlets(mesh, options.meshletMaxVertices, options.meshletMaxTriangles); }
+    if (options.lodCount > 1) { BuildLods(mesh, options.lodCount, options.lodReduction, options.lodMaxError); }
+    if (result_t result = WriteMeshCache(_cachePath.c_str(), mesh, sourceHash, options)) { return result; }
+    return cache.Open(_cachePath.c_str());
+}
+
+/**
+ * @brief 按投影到屏幕上的误差选择LOD
+ * @note 投影矩阵应与绘制时所用的相同，即glm::perspective(...)经FlipVertical(...)翻转后的矩阵，
+ * 其[1][1]元素为1 / tan(fovy / 2)，翻转只改变符号。
+ */
+class lodSelector {
+    float projectionScale = 0.F;  // 距相机为1处、长为1的线段投影到屏幕上的像素数
+    float pixelThreshold  = 1.F;
+
+public:
+    lodSelector() = default;
+    lodSelector(const glm::mat4& projection, float viewportHeight, float pixelThreshold = 1.F)
+    {
+        Update(projection, viewportHeight, pixelThreshold);
+    }
+
+    // Const Function
+    float ProjectedError(float error, float distance) const
+    {
+        return error * projectionScale / std::max(distance, FLT_MIN);
+    }
+    /**
+     * @brief 选择投影误差不超过阈值的最粗糙的一级LOD
+     *
+     * @param boundingSphere 模型空间中的包围球，如meshCache::BoundingSphere()
+     * @param model 模型矩阵，其缩放同时作用于包围球和误差
+     * @param cameraPosition 世界空间中的相机位置
+     * @return uint32_t 在lods中的下标，lods为空时返回0
+     */
+    uint32_t Select(arrayRef<const meshLod> lods,
+                    const glm::vec4&        boundingSphere,
+                    const glm::mat4&        model,
+                    const glm::vec3&        cameraPosition) const
+    {
+        float scale = std::max(glm::length(glm::vec3(model[0])),
+                               std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+        glm::vec3 center = glm::vec3(model * glm::vec4(glm::vec3(boundingSphere), 1.F));
+        // 取包围球上离相机最近的点，相机在包围球内时总是用第0级
+        float    distance = glm::distance(center, cameraPosition) - boundingSphere.w * scale;
+        uint32_t level    = 0;
+        if (distance <= 0.F) { return level; }
+        for (uint32_t i = 1; i < lods.Count(); i++)
+        {
+            if (ProjectedError(lods[i].error * scale, distance) > pixelThreshold) { break; }
+            level = i;
+        }
+        return level;
+    }
+
+    // Non-const Function
+    void Update(const glm::mat4& projection, float viewportHeight, float _pixelThreshold = 1.F)
+    {
+        projectionScale = std::abs(projection[1][1]) * viewportHeight * 0.5F;
+        pixelThreshold  = _pixelThreshold;
+    }
+};
+
+/**
+ * @brief 为网格创建顶点和索引缓冲区，并把缓存中的数据上传上去
+ * @note 数据从映射的缓存文件直接复制到映射的暂存缓冲区，两段复制命令记录在同一个命令缓冲区中
+ */
+inline result_t UploadMesh(const meshCache& cache, deviceLocalBuffer& vertexBuffer, deviceLocalBuffer& indexBuffer)
+{
+    auto vertexData = cache.SectionData(meshCacheSectionType::vertices);
+    auto indexData  = cache.SectionData(meshCacheSectionType::indices);
+    if (result_t result = vertexBuffer.Create(vertexData.Count(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)) { return result; }
+    if (result_t result = indexBuffer.Create(indexData.Count(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT)) { return result; }
+
+    // 若缓冲区本身就是host visible的，直接写入即可
+    if (vertexBuffer.IsHostVisible() && indexBuffer.IsHostVisible())
+    {
+        vertexBuffer.TransferData(vertexData.Pointer(), vertexData.Count());
+        indexBuffer.TransferData(indexData.Pointer(), indexData.Count());
+        return VK_SUCCESS;
+    }
+
+    auto& staging  = stagingBuffer::MainThread();
+    auto* pStaging = static_cast<uint8_t*>(staging.MapMemory(vertexData.Count() + indexData.Count()));
+    memcpy(pStaging, vertexData.Pointer(), vertexData.Count());
+    memcpy(pStaging + vertexData.Count(), indexData.Pointer(), indexData.Count());
+    staging.UnmapMemory();
+
+    const auto&  commandBuffer = graphicsBasePlus::Plus().CommandBuffer_Transfer();
+    VkBufferCopy vertexRegion  = {0, 0, vertexData.Count()};
+    VkBufferCopy indexRegion   = {vertexData.Count(), 0, indexData.Count()};
+    commandBuffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    vkCmdCopyBuffer(commandBuffer, staging, vertexBuffer, 1, &vertexRegion);
+    vkCmdCopyBuffer(commandBuffer, staging, indexBuffer, 1, &indexRegion);
+    commandBuffer.End();
+    return graphicsBasePlus::Plus().ExecuteCommandBuffer_Graphics(commandBuffer);
+}
+
+}  // namespace easyVulkan
@@ -0,0 +1,738 @@
+#pragma once
+#include "EasyVKStart.h"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+/*
+离线的网格优化算法，处理对象皆为三角形列表的索引：
+1. OptimizeVertexCache(...)   重排三角形以提高变换后顶点缓存（post-transform vertex cache）的命中率，
+                              采用Tom Forsyth的Linear-Speed Vertex Cache Optimisation
+2. OptimizeOverdraw(...)      在不明显损失缓存命中率的前提下，按Tipsify的思路把三角形分簇，
+                              再让朝外的簇先绘制，以减少过度绘制
+3. OptimizeVertexFetch(...)   按首次被引用的顺序重排顶点，提高顶点获取的局部性
+4. BuildMeshlets(...)         按最终的三角形顺序把索引切分为网格簇，并计算供GPU剔除的包围球和法线锥
+须按1、2、3、4的顺序调用，顶点获取优化会改变顶点编号，网格簇则依赖最终的三角形顺序。
+另有SimplifyMesh(...)以二次误差度量的边折叠生成简化的索引，用于构建LOD链。
+
+评价指标：
+ACMR（average cache miss ratio）= 缓存未命中数 / 三角形数，理想值接近0.5
+ATVR（average transformed vertex ratio）= 缓存未命中数 / 顶点数，理想值为1
+*/
+
+namespace easyVulkan {
+
+/**
+ * @brief 顶点缓存模拟的统计结果
+ */
+struct vertexCacheStatistics
+{
+    uint32_t cacheMisses = 0;
+    float    acmr        = 0;
+    float    atvr        = 0;
+};
+
+/**
+ * @brief 以FIFO缓存模拟GPU的变换后顶点缓存，统计ACMR和ATVR
+ *
+ * @param cacheSize 多数GPU的等效FIFO缓存大小在16到32之间
+ */
+inline vertexCacheStatistics
+AnalyzeVertexCache(const uint32_t* pIndices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = 16)
+{
+    vertexCacheStatistics statistics;
+    if (indexCount == 0 || vertexCount == 0) { return statistics; }
+
+    // 记录每个顶点进入缓存时的时间戳，时间戳与当前时间之差不小于cacheSize时说明该顶点已被挤出
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    uint32_t              time = cacheSize + 1;
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        uint32_t index = pIndices[i];
+        if (time - timestamps[index] > cacheSize)
+        {
+            timestamps[index] = time++;
+            statistics.cacheMisses++;
+        }
+    }
+    statistics.acmr = static_cast<float>(statistics.cacheMisses) / static_cast<float>(indexCount / 3);
+    statistics.atvr = static_cast<float>(statistics.cacheMisses) / static_cast<float>(vertexCount);
+    return statistics;
+}
+
+// ANCHOR - Vertex Cache Optimization
+
+namespace forsyth {
+
+constexpr uint32_t cacheSize       = 32;
+constexpr uint32_t maxValence      = 32;  // 超过此值的剩余三角形数按此值计分
+constexpr float    cacheDecay      = 1.5F;
+constexpr float    lastTriScore    = 0.75F;
+constexpr float    valenceScale    = 2.F;
+constexpr float    valencePower    = 0.5F;
+constexpr uint32_t invalidPosition = UINT32_MAX;
+
+/**
+ * @brief 预先计算的分数表，避免在循环中调用pow(...)
+ */
+struct scoreTable
+{
+    float cache[cacheSize]        = {};
+    float valence[maxValence + 1] = {};
+
+    scoreTable()
+    {
+        for (uint32_t i = 0; i < cacheSize; i++)
+        {
+            // 最近使用的三个顶点属于刚刚绘制的三角形，给定固定分数，以免算法偏好立刻复用同一条边
+            float position = static_cast<float>(i - 3) / static_cast<float>(cacheSize - 3);
+            cache[i]       = i < 3 ? lastTriScore : std::pow(1.F - position, cacheDecay);
+        }
+        for (uint32_t i = 1; i <= maxValence; i++)
+        {
+            valence[i] = valenceScale * std::pow(static_cast<float>(i), -valencePower);
+        }
+    }
+    float VertexScore(uint32_t cachePosition, uint32_t remainingTriangles) const
+    {
+        if (remainingTriangles == 0) { return -1.F; }  // 已经没有三角形引用这个顶点了
+        float score = cachePosition == invalidPosition ? 0.F : cache[cachePosition];
+        return score + valence[std::min(remainingTriangles, maxValence)];
+    }
+};
+
+}  // namespace forsyth
+
+/**
+ * @brief 重排三角形以提高变换后顶点缓存的命中率，结果写回pIndices
+ */
+inline void OptimizeVertexCache(uint32_t* pIndices, size_t indexCount, size_t vertexCount)
+{
+    using namespace forsyth;
+    static const scoreTable scores;
+
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) { return; }
+
+    // 建立顶点到三角形的邻接表，adjacency中[adjacencyOffsets[v], adjacencyOffsets[v] + liveTriangles[v])为v的邻接三角形
+    std::vector<uint32_t> liveTriangles(vertexCount, 0);
+    for (size_t i = 0; i < indexCount; i++) { liveTriangles[pIndices[i]]++; }
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (size_t i = 0; i < vertexCount; i++) { adjacencyOffsets[i + 1] = adjacencyOffsets[i] + liveTriangles[i]; }
+    std::vector<uint32_t> adjacency(indexCount);
+    {
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < indexCount; i++) { adjacency[fill[pIndices[i]]++] = static_cast<uint32_t>(i / 3); }
+    }
+
+    std::vector<uint32_t> cachePositions(vertexCount, invalidPosition);
+    std::vector<float>    vertexScores(vertexCount);
+    std::vector<float>    triangleScores(triangleCount, 0.F);
+    std::vector<bool>     emitted(triangleCount, false);
+    for (size_t i = 0; i < vertexCount; i++) { vertexScores[i] = scores.VertexScore(invalidPosition, liveTriangles[i]); }
+    for (size_t i = 0; i < indexCount; i++) { triangleScores[i / 3] += vertexScores[pIndices[i]]; }
+
+    // 初始时选取分数最高的三角形
+    uint32_t bestTriangle =
+        static_cast<uint32_t>(std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin());
+
+    std::vector<uint32_t> output;
+    output.reserve(indexCount);
+    std::array<uint32_t, cacheSize + 3> cache      = {};
+    std::array<uint32_t, cacheSize + 3> newCache   = {};
+    uint32_t                            cacheCount = 0;
+    size_t                              scanCursor = 0;  // 缓存中找不到候选三角形时，从这里开始顺序查找
+
+    for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+    {
+        if (bestTriangle == UINT32_MAX)
+        {
+            while (emitted[scanCursor]) { scanCursor++; }
+            bestTriangle = static_cast<uint32_t>(scanCursor);
+        }
+
+        // 输出三角形，并将其从三个顶点的邻接表中移除
+        const uint32_t* pTriangle = pIndices + size_t(bestTriangle) * 3;
+        output.insert(output.end(), pTriangle, pTriangle + 3);
+        emitted[bestTriangle] = true;
+        for (int i = 0; i < 3; i++)
+        {
+            uint32_t  vertex = pTriangle[i];
+            uint32_t* pBegin = adjacency.data() + adjacencyOffsets[vertex];
+            uint32_t* pEnd   = pBegin + liveTriangles[vertex];
+            *std::find(pBegin, pEnd, bestTriangle) = *(pEnd - 1);
+            liveTriangles[vertex]--;
+        }
+
+        // 更新LRU缓存：三角形的三个顶点移到最前，其余顶点依次后移
+        uint32_t newCacheCount = 0;
+        for (int i = 0; i < 3; i++) { newCache[newCacheCount++] = pTriangle[i]; }
+        for (uint32_t i = 0; i < cacheCount; i++)
+        {
+            uint32_t vertex = cache[i];
+            if (vertex != pTriangle[0] && vertex != pTriangle[1] && vertex != pTriangle[2])
+            {
+                newCache[newCacheCount++] = vertex;
+            }
+        }
+        std::swap(cache, newCache);
+        cacheCount = newCacheCount;
+
+        // 先更新缓存中（包括刚被挤出的）所有顶点的分数，一个三角形可能有多个顶点的缓存位置改变
+        for (uint32_t i = 0; i < cacheCount; i++)
+        {
+            uint32_t vertex        = cache[i];
+            cachePositions[vertex] = i < cacheSize ? i : invalidPosition;
+            float newScore         = scores.VertexScore(cachePositions[vertex], liveTriangles[vertex]);
+            float deltaScore       = newScore - vertexScores[vertex];
+            vertexScores[vertex]   = newScore;
+
+            const uint32_t* pBegin = adjacency.data() + adjacencyOffsets[vertex];
+            for (uint32_t j = 0; j < liveTriangles[vertex]; j++) { triangleScores[pBegin[j]] += deltaScore; }
+        }
+        cacheCount = std::min(cacheCount, cacheSize);
+
+        // 分数全部更新后，再在缓存中顶点的邻接三角形中选出下一个三角形
+        float bestScore = -1.F;
+        bestTriangle    = UINT32_MAX;
+        for (uint32_t i = 0; i < cacheCount; i++)
+        {
+            uint32_t        vertex = cache[i];
+            const uint32_t* pBegin = adjacency.data() + adjacencyOffsets[vertex];
+            for (uint32_t j = 0; j < liveTriangles[vertex]; j++)
+            {
+                uint32_t triangle = pBegin[j];
+                if (triangleScores[triangle] > bestScore)
+                {
+                    bestScore    = triangleScores[triangle];
+                    bestTriangle = triangle;
+                }
+            }
+        }
+    }
+    std::copy(output.begin(), output.end(), pIndices);
+}
+
+// ANCHOR - Overdraw Optimization
+
+/**
+ * @brief 在顶点缓存优化的结果上重排三角形簇，使朝外的簇先绘制，从而借助early-z减少过度绘制
+ *
+ * @param pPositions 顶点位置，每个位置为连续的3个float
+ * @param positionStride 相邻两个顶点位置之间的字节数
+ * @param threshold 允许ACMR变差的比例，如1.05表示最多变差5%
+ */
+inline void OptimizeOverdraw(uint32_t*    pIndices,
+                             size_t       indexCount,
+                             const float* pPositions,
+                             size_t       vertexCount,
+                             size_t       positionStride,
+                             float        threshold = 1.05F)
+{
+    constexpr uint32_t cacheSize     = 16;
+    size_t             triangleCount = indexCount / 3;
+    if (triangleCount == 0) { return; }
+
+    auto Position = [&](uint32_t index) {
+        const auto* pPosition =
+            reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(pPositions) + index * positionStride);
+        return glm::vec3(pPosition[0], pPosition[1], pPosition[2]);
+    };
+
+    // 1. 分簇：先在三个顶点都未命中缓存的三角形处（硬边界）断开，
+    // 簇内若当前累计的ACMR已不高于整簇ACMR乘以threshold，则在此处再断开（软边界）
+    std::vector<uint32_t> clusterStarts;
+    {
+        std::vector<uint32_t> timestamps(vertexCount, 0);
+        uint32_t              time = cacheSize + 1;
+        auto                  Miss = [&](uint32_t index) {
+            if (time - timestamps[index] > cacheSize)
+            {
+                timestamps[index] = time++;
+                return 1U;
+            }
+            return 0U;
+        };
+        std::vector<uint32_t> hardStarts;
+        std::vector<uint32_t> missPrefixSum(triangleCount + 1, 0);  // 用于求各硬边界簇的ACMR
+        for (size_t i = 0; i < triangleCount; i++)
+        {
+            uint32_t misses = Miss(pIndices[i * 3]) + Miss(pIndices[i * 3 + 1]) + Miss(pIndices[i * 3 + 2]);
+            if (misses == 3 || i == 0) { hardStarts.push_back(static_cast<uint32_t>(i)); }
+            missPrefixSum[i + 1] = missPrefixSum[i] + misses;
+        }
+        hardStarts.push_back(static_cast<uint32_t>(triangleCount));
+
+        for (size_t c = 0; c + 1 < hardStarts.size(); c++)
+        {
+            uint32_t begin       = hardStarts[c];
+            uint32_t end         = hardStarts[c + 1];
+            float    clusterAcmr = static_cast<float>(missPrefixSum[end] - missPrefixSum[begin]) /
+                                static_cast<float>(end - begin);
+
+            time += cacheSize + 1;  // 使缓存中的所有顶点失效
+            uint32_t start  = begin;
+            uint32_t misses = 0;
+            clusterStarts.push_back(begin);
+            for (uint32_t i = begin; i < end; i++)
+            {
+                misses += Miss(pIndices[i * 3]) + Miss(pIndices[i * 3 + 1]) + Miss(pIndices[i * 3 + 2]);
+                float runningAcmr = static_cast<float>(misses) / static_cast<float>(i - start + 1);
+                if (i + 1 < end && runningAcmr <= clusterAcmr * threshold && i - start + 1 >= cacheSize)
+                {
+                    start  = i + 1;
+                    misses = 0;
+                    time += cacheSize + 1;
+                    clusterStarts.push_back(start);
+                }
+            }
+        }
+        clusterStarts.push_back(static_cast<uint32_t>(triangleCount));
+    }
+
+    // 2. 以簇的面积加权中心相对网格中心的位置与簇的平均法线的点积为排序依据，越朝外越先绘制
+    struct cluster
+    {
+        uint32_t begin;
+        uint32_t end;
+        float    sortKey;
+    };
+    std::vector<cluster>   clusters;
+    std::vector<glm::vec3> centroids;
+    std::vector<glm::vec3> normals;
+    glm::vec3              meshCentroid(0.F);
+    float                  meshArea = 0.F;
+    for (size_t c = 0; c + 1 < clusterStarts.size(); c++)
+    {
+        glm::vec3 centroid(0.F);
+        glm::vec3 normal(0.F);
+        float     area = 0.F;
+        for (uint32_t i = clusterStarts[c]; i < clusterStarts[c + 1]; i++)
+        {
+            glm::vec3 p0 = Position(pIndices[i * 3]);
+            glm::vec3 p1 = Position(pIndices[i * 3 + 1]);
+            glm::vec3 p2 = Position(pIndices[i * 3 + 2]);
+            glm::vec3 n  = glm::cross(p1 - p0, p2 - p0);  // 长度为三角形面积的两倍
+            float     a  = glm::length(n);
+            centroid += (p0 + p1 + p2) * (a / 3.F);
+            normal += n;
+            area += a;
+        }
+        meshCentroid += centroid;
+        meshArea += area;
+        centroids.push_back(area > 0.F ? centroid / area : centroid);
+        normals.push_back(glm::length(normal) > 0.F ? glm::normalize(normal) : normal);
+        clusters.push_back({clusterStarts[c], clusterStarts[c + 1], 0.F});
+    }
+    if (meshArea > 0.F) { meshCentroid /= meshArea; }
+    for (size_t c = 0; c < clusters.size(); c++)
+    {
+        clusters[c].sortKey = glm::dot(centroids[c] - meshCentroid, normals[c]);
+    }
+    std::stable_sort(clusters.begin(), clusters.end(),
+                     [](const cluster& a, const cluster& b) { return a.sortKey > b.sortKey; });
+
+    std::vector<uint32_t> output;
+    output.reserve(indexCount);
+    for (const auto& i : clusters)
+    {
+        output.insert(output.end(), pIndices + size_t(i.begin) * 3, pIndices + size_t(i.end) * 3);
+    }
+    std::copy(output.begin(), output.end(), pIndices);
+}
+
+// ANCHOR - Vertex Fetch Optimization
+
+/**
+ * @brief 按顶点首次被引用的顺序生成重映射表，并就地改写索引
+ *
+ * @return uint32_t 被引用的顶点数，未被引用的顶点在remap中为UINT32_MAX
+ */
+inline uint32_t OptimizeVertexFetchRemap(uint32_t* pIndices, size_t indexCount, std::vector<uint32_t>& remap)
+{
+    std::fill(remap.begin(), remap.end(), UINT32_MAX);
+    uint32_t nextVertex = 0;
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        uint32_t& newIndex = remap[pIndices[i]];
+        if (newIndex == UINT32_MAX) { newIndex = nextVertex++; }
+        pIndices[i] = newIndex;
+    }
+    return nextVertex;
+}
+
+/**
+ * @brief 按顶点首次被引用的顺序重排顶点，未被引用的顶点会被丢弃
+ *
+ * @return uint32_t 重排后的顶点数
+ */
+template <typename vertex_t>
+uint32_t OptimizeVertexFetch(uint32_t* pIndices, size_t indexCount, std::vector<vertex_t>& vertices)
+{
+    std::vector<uint32_t> remap(vertices.size());
+    uint32_t              vertexCount = OptimizeVertexFetchRemap(pIndices, indexCount, remap);
+    std::vector<vertex_t> newVertices(vertexCount);
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        if (remap[i] != UINT32_MAX) { newVertices[remap[i]] = vertices[i]; }
+    }
+    vertices.swap(newVertices);
+    return vertexCount;
+}
+
+// ANCHOR - Meshlet Generation
+
+/**
+ * @brief 网格簇（meshlet），布局与ClusterCull.comp.shader中的结构体一致（std430）
+ * @note 没有使用网格着色器，每个网格簇就是索引缓冲区中连续的一段，可用一条间接绘制命令绘制
+ */
+struct meshlet
+{
+    glm::vec4 boundingSphere;  // xyz为球心，w为半径，皆在模型空间中
+    glm::vec4 normalCone;      // xyz为法线锥的轴，w为背面剔除所用的阈值，见ComputeMeshletBounds(...)
+    uint32_t  firstIndex;
+    uint32_t  indexCount;
+    int32_t   vertexOffset;
+    uint32_t  subMeshIndex;
+};
+static_assert(sizeof(meshlet) == 48);
+
+constexpr uint32_t defaultMeshletMaxVertices  = 64;
+constexpr uint32_t defaultMeshletMaxTriangles = 124;
+
+/**
+ * @brief 计算网格簇的包围球和法线锥
+ * @note 包围球取包围盒中心及到其最远顶点的距离。法线锥的阈值为sin(锥的半角)，
+ * 当dot(center - camera, axis) >= threshold * length(center - camera) + radius时，
+ * 从相机看去簇中所有三角形都是背面；三角形法线过于分散时阈值为1，即永不剔除。
+ */
+inline void ComputeMeshletBounds(meshlet&        cluster,
+                                 const uint32_t* pIndices,
+                                 const float*    pPositions,
+                                 size_t          positionStride)
+{
+    auto Position = [&](uint32_t index) {
+        const auto* pPosition =
+            reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(pPositions) + index * positionStride);
+        return glm::vec3(pPosition[0], pPosition[1], pPosition[2]);
+    };
+    const uint32_t* pClusterIndices = pIndices + cluster.firstIndex;
+
+    glm::vec3 boundsMin(FLT_MAX);
+    glm::vec3 boundsMax(-FLT_MAX);
+    for (uint32_t i = 0; i < cluster.indexCount; i++)
+    {
+        glm::vec3 position = Position(pClusterIndices[i]);
+        boundsMin          = glm::min(boundsMin, position);
+        boundsMax          = glm::max(boundsMax, position);
+    }
+    glm::vec3 center = (boundsMin + boundsMax) * 0.5F;
+    float     radius = 0.F;
+    for (uint32_t i = 0; i < cluster.indexCount; i++)
+    {
+        radius = std::max(radius, glm::length(Position(pClusterIndices[i]) - center));
+    }
+    cluster.boundingSphere = glm::vec4(center, radius);
+
+    // 以各三角形单位法线的平均值为锥轴，以其与各法线夹角的最大值为半角
+    std::vector<glm::vec3> normals;
+    normals.reserve(cluster.indexCount / 3);
+    glm::vec3 axis(0.F);
+    for (uint32_t i = 0; i + 2 < cluster.indexCount; i += 3)
+    {
+        glm::vec3 p0     = Position(pClusterIndices[i]);
+        glm::vec3 normal = glm::cross(Position(pClusterIndices[i + 1]) - p0, Position(pClusterIndices[i + 2]) - p0);
+        float     length = glm::length(normal);
+        if (length == 0.F) { continue; }  // 退化的三角形不可见，不影响剔除
+        normals.push_back(normal / length);
+        axis += normals.back();
+    }
+    cluster.normalCone = glm::vec4(0.F, 0.F, 0.F, 1.F);
+    if (glm::length(axis) == 0.F) { return; }
+    axis         = glm::normalize(axis);
+    float minDot = 1.F;
+    for (const auto& i : normals) { minDot = std::min(minDot, glm::dot(i, axis)); }
+    // 半角接近90°时剔除率极低，不如直接放弃
+    cluster.normalCone = glm::vec4(axis, minDot <= 0.1F ? 1.F : std::sqrt(1.F - minDot * minDot));
+}
+
+/**
+ * @brief 按当前的三角形顺序把索引贪心地切分为网格簇，每簇的顶点数和三角形数皆不超过上限
+ * @note 应在其他优化之后调用，顶点缓存优化后的三角形顺序在空间上是连贯的，切分出的簇也就较为紧凑。
+ * 生成的网格簇的firstIndex相对于pIndices，vertexOffset和subMeshIndex为0，由调用者按需改写。
+ *
+ * @return size_t 新增的网格簇的数量
+ */
+inline size_t BuildMeshlets(std::vector<meshlet>& meshlets,
+                            const uint32_t*       pIndices,
+                            size_t                indexCount,
+                            const float*          pPositions,
+                            size_t                vertexCount,
+                            size_t                positionStride,
+                            uint32_t              maxVertices  = defaultMeshletMaxVertices,
+                            uint32_t              maxTriangles = defaultMeshletMaxTriangles)
+{
+    size_t                firstMeshlet = meshlets.size();
+    std::vector<uint32_t> owners(vertexCount, UINT32_MAX);  // 记录各顶点最近一次被计入的网格簇
+    uint32_t              clusterId       = 0;
+    uint32_t              clusterVertices = 0;
+    meshlet               cluster         = {};
+    auto                  FinishCluster   = [&]() {
+        ComputeMeshletBounds(cluster, pIndices, pPositions, positionStride);
+        meshlets.push_back(cluster);
+        cluster         = {.firstIndex = cluster.firstIndex + cluster.indexCount};
+        clusterVertices = 0;
+        clusterId++;
+    };
+    for (size_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        uint32_t newVertices = 0;
+        for (size_t j = 0; j < 3; j++) { newVertices += owners[pIndices[i + j]] != clusterId; }
+        // 同一三角形中重复的顶点（退化三角形）会被多计，只会让簇提前结束，不影响正确性
+        if (clusterVertices + newVertices > maxVertices || cluster.indexCount / 3 + 1 > maxTriangles)
+        {
+            FinishCluster();
+            newVertices = 0;
+            for (size_t j = 0; j < 3; j++) { newVertices += owners[pIndices[i + j]] != clusterId; }
+        }
+        for (size_t j = 0; j < 3; j++) { owners[pIndices[i + j]] = clusterId; }
+        clusterVertices += newVertices;
+        cluster.indexCount += 3;
+    }
+    if (cluster.indexCount != 0) { FinishCluster(); }
+    return meshlets.size() - firstMeshlet;
+}
+
+// ANCHOR - Simplification
+
+/**
+ * @brief 对称的4x4二次误差矩阵（Garland-Heckbert），只存储上三角的10个元素
+ * @note 各平面按三角形面积加权，求值时除以权重之和，因此误差即加权的均方距离，单位为模型空间长度的平方
+ */
+struct quadricMatrix
+{
+    double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+    double a11 = 0, a12 = 0, a13 = 0;
+    double a22 = 0, a23 = 0;
+    double a33    = 0;
+    double weight = 0;
+
+    static quadricMatrix FromPlane(const glm::vec3& normal, float distance, float weight)
+    {
+        double x = normal.x, y = normal.y, z = normal.z, w = distance;
+        return {x * x * weight, x * y * weight, x * z * weight, x * w * weight,
+                y * y * weight, y * z * weight, y * w * weight, z * z * weight,
+                z * w * weight, w * w * weight, weight};
+    }
+    quadricMatrix& operator+=(const quadricMatrix& other)
+    {
+        double*       pThis  = &a00;
+        const double* pOther = &other.a00;
+        for (size_t i = 0; i < 11; i++) { pThis[i] += pOther[i]; }
+        return *this;
+    }
+    quadricMatrix operator+(const quadricMatrix& other) const
+    {
+        quadricMatrix result = *this;
+        return result += other;
+    }
+    double Evaluate(const glm::vec3& position) const
+    {
+        double x = position.x, y = position.y, z = position.z;
+        double error = a00 * x * x + a11 * y * y + a22 * z * z + a33 +
+                       2 * (a01 * x * y + a02 * x * z + a12 * y * z + a03 * x + a13 * y + a23 * z);
+        return weight > 0 ? std::abs(error) / weight : 0;
+    }
+};
+
+/**
+ * @brief 以边折叠（半边折叠，折叠到已有顶点上）简化三角形网格，只生成新的索引，顶点数据保持不变
+ * @note 纹理接缝等位置相同而编号不同的顶点被锁定，以免出现裂缝；开放边界附加了垂直于边界的约束平面，
+ * 使边界尽量不收缩。折叠分轮进行，每轮按代价从低到高选取互不相邻的边，直至达到目标或误差上限。
+ *
+ * @param targetIndexCount 目标索引数，误差上限先于其达到时返回的索引会多于该值
+ * @param targetError 误差上限，为模型空间中的距离
+ * @param resultError 实际的最大误差，为模型空间中的距离
+ * @return std::vector<uint32_t> 简化后的索引，引用原有的顶点
+ */
+inline std::vector<uint32_t> SimplifyMesh(const uint32_t* pIndices,
+                                          size_t          indexCount,
+                                          const float*    pPositions,
+                                          size_t          vertexCount,
+                                          size_t          positionStride,
+                                          size_t          targetIndexCount,
+                                          float           targetError,
+                                          float&          resultError)
+{
+    auto Position = [&](uint32_t index) {
+        const auto* pPosition =
+            reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(pPositions) + index * positionStride);
+        return glm::vec3(pPosition[0], pPosition[1], pPosition[2]);
+    };
+    auto Normal = [&](uint32_t i0, uint32_t i1, uint32_t i2) {
+        glm::vec3 p0 = Position(i0);
+        return glm::cross(Position(i1) - p0, Position(i2) - p0);
+    };
+    std::vector<uint32_t> indices(pIndices, pIndices + indexCount);
+    resultError = 0.F;
+
+    // 1. 锁定位置重复的顶点
+    std::vector<uint8_t> locked(vertexCount, 0);
+    {
+        std::vector<uint32_t> sorted(vertexCount);
+        std::iota(sorted.begin(), sorted.end(), 0);
+        auto Key = [&](uint32_t index) {
+            glm::vec3 position = Position(index);
+            return std::array<float, 3>{position.x, position.y, position.z};
+        };
+        std::sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b) { return Key(a) < Key(b); });
+        for (size_t i = 1; i < vertexCount; i++)
+        {
+            if (Key(sorted[i - 1]) == Key(sorted[i])) { locked[sorted[i - 1]] = locked[sorted[i]] = 1; }
+        }
+    }
+
+    // 2. 累加各顶点的二次误差矩阵
+    std::vector<quadricMatrix>             quadrics(vertexCount);
+    std::unordered_map<uint64_t, uint32_t> edgeUseCounts;
+    auto EdgeKey = [](uint32_t a, uint32_t b) { return uint64_t(std::min(a, b)) << 32 | std::max(a, b); };
+    for (size_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        glm::vec3 normal = Normal(indices[i], indices[i + 1], indices[i + 2]);
+        float     area2  = glm::length(normal);
+        if (area2 == 0.F) { continue; }
+        normal /= area2;
+        auto quadric = quadricMatrix::FromPlane(normal, -glm::dot(normal, Position(indices[i])), area2 * 0.5F);
+        for (size_t j = 0; j < 3; j++)
+        {
+            quadrics[indices[i + j]] += quadric;
+            edgeUseCounts[EdgeKey(indices[i + j], indices[i + (j + 1) % 3])]++;
+        }
+    }
+    constexpr float borderWeight = 10.F;
+    for (size_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        glm::vec3 normal = Normal(indices[i], indices[i + 1], indices[i + 2]);
+        if (glm::length(normal) == 0.F) { continue; }
+        normal = glm::normalize(normal);
+        for (size_t j = 0; j < 3; j++)
+        {
+            uint32_t a = indices[i + j];
+            uint32_t b = indices[i + (j + 1) % 3];
+            if (edgeUseCounts[EdgeKey(a, b)] != 1) { continue; }
+            glm::vec3 edge        = Position(b) - Position(a);
+            glm::vec3 planeNormal = glm::cross(edge, normal);
+            if (glm::length(planeNormal) == 0.F) { continue; }
+            planeNormal  = glm::normalize(planeNormal);
+            auto quadric = quadricMatrix::FromPlane(planeNormal, -glm::dot(planeNormal, Position(a)),
+                                                    glm::dot(edge, edge) * borderWeight);
+            quadrics[a] += quadric;
+            quadrics[b] += quadric;
+        }
+    }
+
+    // 3. 分轮折叠
+    struct collapse
+    {
+        uint32_t from;
+        uint32_t to;
+        double   cost;
+    };
+    double                maxCost     = double(targetError) * targetError;
+    double                maxUsedCost = 0;
+    std::vector<uint32_t> remap(vertexCount);
+    std::iota(remap.begin(), remap.end(), 0);
+    std::vector<uint32_t> triangleOffsets(vertexCount + 1);
+    std::vector<uint32_t> vertexTriangles;
+    std::vector<uint8_t>  touched(vertexCount);
+    std::vector<collapse> candidates;
+    while (indices.size() > targetIndexCount)
+    {
+        // 顶点到三角形的邻接表
+        std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+        for (auto i : indices) { triangleOffsets[i + 1]++; }
+        for (size_t i = 0; i < vertexCount; i++) { triangleOffsets[i + 1] += triangleOffsets[i]; }
+        vertexTriangles.resize(indices.size());
+        {
+            std::vector<uint32_t> cursors(triangleOffsets.begin(), triangleOffsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); i++)
+            {
+                vertexTriangles[cursors[indices[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        // 每条边只取代价较小的方向，内部边会从两侧各遇到一次，重复的候选在选取时自然被跳过
+        candidates.clear();
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            for (size_t j = 0; j < 3; j++)
+            {
+                uint32_t a = indices[i + j];
+                uint32_t b = indices[i + (j + 1) % 3];
+                quadricMatrix quadric = quadrics[a] + quadrics[b];
+                double        costAB  = locked[a] != 0U ? DBL_MAX : quadric.Evaluate(Position(b));
+                double        costBA  = locked[b] != 0U ? DBL_MAX : quadric.Evaluate(Position(a));
+                if (costAB == DBL_MAX && costBA == DBL_MAX) { continue; }
+                candidates.push_back(costAB <= costBA ? collapse{a, b, costAB} : collapse{b, a, costBA});
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const collapse& x, const collapse& y) { return x.cost < y.cost; });
+
+        // 选取互不相邻的折叠
+        std::fill(touched.begin(), touched.end(), 0);
+        size_t trianglesToRemove = (indices.size() - targetIndexCount) / 3;
+        size_t removedTriangles  = 0;
+        size_t appliedCount      = 0;
+        for (const auto& c : candidates)
+        {
+            if (c.cost > maxCost || removedTriangles >= trianglesToRemove) { break; }
+            if ((touched[c.from] | touched[c.to]) != 0U) { continue; }
+
+            // 折叠后法线反转或大幅偏转的三角形说明网格会自交或折叠，放弃该折叠
+            bool flipped = false;
+            for (uint32_t t = triangleOffsets[c.from]; t < triangleOffsets[c.from + 1] && !flipped; t++)
+            {
+                const uint32_t* pTriangle = &indices[size_t(vertexTriangles[t]) * 3];
+                if (pTriangle[0] == c.to || pTriangle[1] == c.to || pTriangle[2] == c.to) { continue; }
+                uint32_t moved[3];
+                for (size_t j = 0; j < 3; j++) { moved[j] = pTriangle[j] == c.from ? c.to : pTriangle[j]; }
+                glm::vec3 normal      = Normal(pTriangle[0], pTriangle[1], pTriangle[2]);
+                glm::vec3 movedNormal = Normal(moved[0], moved[1], moved[2]);
+                flipped = glm::dot(normal, movedNormal) < 0.25F * glm::length(normal) * glm::length(movedNormal);
+            }
+            if (flipped) { continue; }
+
+            remap[c.from] = c.to;
+            quadrics[c.to] += quadrics[c.from];
+            for (uint32_t t = triangleOffsets[c.from]; t < triangleOffsets[c.from + 1]; t++)
+            {
+                const uint32_t* pTriangle = &indices[size_t(vertexTriangles[t]) * 3];
+                touched[pTriangle[0]] = touched[pTriangle[1]] = touched[pTriangle[2]] = 1;
+                removedTriangles += pTriangle[0] == c.to || pTriangle[1] == c.to || pTriangle[2] == c.to;
+            }
+            maxUsedCost = std::max(maxUsedCost, c.cost);
+            appliedCount++;
+        }
+        if (appliedCount == 0) { break; }
+
+        // 改写索引，丢弃退化的三角形
+        size_t writeIndex = 0;
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            uint32_t a = remap[indices[i]];
+            uint32_t b = remap[indices[i + 1]];
+            uint32_t c = remap[indices[i + 2]];
+            if (a == b || b == c || c == a) { continue; }
+            indices[writeIndex++] = a;
+            indices[writeIndex++] = b;
+            indices[writeIndex++] = c;
+        }
+        indices.resize(writeIndex);
+    }
+    resultError = static_cast<float>(std::sqrt(maxUsedCost));
+    return indices;
+}
+
+}  // namespace easyVulkan
@@ -0,0 +1,383 @@
+#pragma once
+#include "EasyVKStart.h"
+#include "VKBase.h"
+
+/*
+在GPU上生成完整的mip链：
+1. 格式支持线性过滤的blit时，逐级用vkCmdBlitImage(...)从上一级缩小
+2. 否则，若格式支持存储图像，用计算着色器（shader/MipmapDownsample.comp.shader）逐级做2x2盒式滤波
+3. 两者都不支持时只保留第0级，MipLevelCount(...)对这样的格式返回1
+
+CmdGenerate(...)一次处理多张图像，同一级的所有图像共用一次屏障，
+因此可以直接记录在上传纹理的命令缓冲区中，紧跟在复制命令之后。
+仓库中只有该计算着色器的源文件，其SPIR-V在构建时由glslc编译，嵌入或不嵌入着色器时都可用；没有glslc时计算路径不可用。
+*/
+
+namespace easyVulkan {
+
+/**
+ * @brief 计算完整mip链的等级数
+ */
+inline uint32_t CalculateMipLevelCount(VkExtent2D extent)
+{
+    return static_cast<uint32_t>(std::floor(std::log2(std::max(extent.width, extent.height)))) + 1;
+}
+
+/**
+ * @brief 生成mipmap，须在主线程中使用
+ */
+class mipmapGenerator {
+public:
+    enum class method : uint32_t {
+        none,
+        blit,
+        compute,
+    };
+    struct target
+    {
+        VkImage    image;
+        VkFormat   format;
+        VkExtent2D extent;
+        uint32_t   mipLevelCount;
+        uint32_t   arrayLayer = 0;  // 纹理数组的每一层作为单独的目标
+    };
+    /**
+     * @brief 计算路径在命令缓冲区中引用的对象，须存活到命令缓冲区执行完毕
+     */
+    struct scratch
+    {
+        vulkan::descriptorPool         descriptorPool;
+        std::vector<vulkan::imageView> imageViews;
+    };
+
+private:
+    descriptorSetLayout                descriptorSetLayout_downsample;
+    pipelineLayout                     pipelineLayout_downsample;
+    pipeline                           pipeline_downsample;
+    bool                               computeAvailable = false;
+    mutable std::map<VkFormat, method> methods;  // 每种格式的查询结果
+
+    static constexpr uint32_t workgroupSize = 8;  // 须与着色器中的local_size_x/y一致
+
+    static int32_t MipSize(uint32_t size, uint32_t level) { return static_cast<int32_t>(std::max(1U, size >> level)); }
+    static VkImageMemoryBarrier Barrier(const target& image,
+                                        uint32_t      baseMipLevel,
+                                        uint32_t      levelCount,
+                                        VkAccessFlags srcAccessMask,
+                                        VkAccessFlags dstAccessMask,
+                                        VkImageLayout oldLayout,
+                                        VkImageLayout newLayout)
+    {
+        return {
+            .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask       = srcAccessMask,
+            .dstAccessMask       = dstAccessMask,
+            .oldLayout           = oldLayout,
+            .newLayout           = newLayout,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image               = image.image,
+            .subresourceRange    = {VK_IMAGE_ASPECT_COLOR_BIT, baseMipLevel, levelCount, image.arrayLayer, 1},
+        };
+    }
+    static void CmdBarriers(VkCommandBuffer                    commandBuffer,
+                            VkPipelineStageFlags               srcStageMask,
+                            VkPipelineStageFlags               dstStageMask,
+                            std::vector<VkImageMemoryBarrier>& barriers)
+    {
+        if (barriers.empty()) { return; }
+        vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, 0, 0, nullptr, 0, nullptr,
+                             static_cast<uint32_t>(barriers.size()), barriers.data());
+        barriers.clear();
+    }
+
+public:
+    mipmapGenerator() = default;
+    mipmapGenerator(const mipmapGenerator&)            = delete;
+    mipmapGenerator& operator=(const mipmapGenerator&) = delete;
+
+    // Getter
+    bool ComputeAvailable() const { return computeAvailable; }
+
+    // Const Function
+    method Method(VkFormat format) const
+    {
+        if (auto i = methods.find(format); i != methods.end()) { return i->second; }
+        VkFormatProperties formatProperties;
+        vkGetPhysicalDeviceFormatProperties(GraphicsBase::Base().PhysicalDevice(), format, &formatProperties);
+        VkFormatFeatureFlags features = formatProperties.optimalTilingFeatures;
+        constexpr VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                                      VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        constexpr VkFormatFeatureFlags computeFeatures =
+            VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT;
+        method result = method::none;
+        if ((features & blitFeatures) == blitFeatures) { result = method::blit; }
+        else if (computeAvailable && (features & computeFeatures) == computeFeatures) { result = method::compute; }
+        return methods[format] = result;
+    }
+    /**
+     * @return uint32_t 该格式能生成的mip等级数，无法生成时为1
+     */
+    uint32_t MipLevelCount(VkFormat format, VkExtent2D extent) const
+    {
+        return Method(format) == method::none ? 1 : CalculateMipLevelCount(extent);
+    }
+    /**
+     * @brief 生成mipmap所需的额外图像用途，创建图像时与其他用途一并指定
+     */
+    VkImageUsageFlags ImageUsage(VkFormat format) const
+    {
+        switch (Method(format))
+        {
+            case method::blit: return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            case method::compute: return VK_IMAGE_USAGE_STORAGE_BIT;
+            default: return 0;
+        }
+    }
+    /**
+     * @brief 为多张图像生成mipmap
+     * @note 调用前，各图像的第0级须为VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL且刚被传输命令写入，其余等级的内容被丢弃；
+     * 调用后，所有等级均为VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL，对dstStageMask中的着色器读取可见。
+     * mipLevelCount为1的图像只做布局转换。
+     *
+     * @param resources 计算路径创建的对象，须存活到命令缓冲区执行完毕
+     */
+    result_t CmdGenerate(VkCommandBuffer        commandBuffer,
+                         arrayRef<const target> targets,
+                         scratch&               resources,
+                         VkPipelineStageFlags   dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT) const
+    {
+        std::vector<const target*>        blitTargets;
+        std::vector<const target*>        computeTargets;
+        std::vector<VkImageMemoryBarrier> barriers;
+        uint32_t                          maxLevelCount_blit    = 1;
+        uint32_t                          maxLevelCount_compute = 1;
+        uint32_t                          levelCount_compute    = 0;  // 计算路径需要生成的等级总数
+        for (auto& i : targets)
+        {
+            method targetMethod = i.mipLevelCount > 1 ? Method(i.format) : method::none;
+            if (targetMethod == method::blit)
+            {
+                blitTargets.push_back(&i);
+                maxLevelCount_blit = std::max(maxLevelCount_blit, i.mipLevelCount);
+            }
+            else if (targetMethod == method::compute)
+            {
+                computeTargets.push_back(&i);
+                maxLevelCount_compute = std::max(maxLevelCount_compute, i.mipLevelCount);
+                levelCount_compute += i.mipLevelCount - 1;
+            }
+            else if (i.mipLevelCount > 1)
+            {
+                LOG(ERROR) << "[ mipmapGenerator ] ERROR\nFormat " << static_cast<int32_t>(i.format)
+                           << " supports neither linear blit nor the compute path!\n"
+                           << "Create the image with MipLevelCount(...) levels.";
+                return VK_RESULT_MAX_ENUM;
+            }
+        }
+
+        // 计算路径：先创建每一级的图像视图和描述符集，记录命令前就能发现错误
+        std::vector<VkDescriptorSet> descriptorSets(levelCount_compute);
+        if (levelCount_compute != 0)
+        {
+            std::array<VkDescriptorPoolSize, 2> poolSizes = {{
+                {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, levelCount_compute},
+                {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, levelCount_compute},
+            }};
+            std::vector<VkDescriptorSetLayout>  setLayouts(levelCount_compute, descriptorSetLayout_downsample);
+            if (result_t result =
+                    resources.descriptorPool.Create(levelCount_compute, {poolSizes.data(), poolSizes.size()}))
+            {
+                return result;
+            }
+            if (result_t result = resources.descriptorPool.AllocateSets({descriptorSets.data(), descriptorSets.size()},
+                                                                        {setLayouts.data(), setLayouts.size()}))
+            {
+                return result;
+            }
+
+            std::vector<VkDescriptorImageInfo> imageInfos;
+            std::vector<VkWriteDescriptorSet>  writes;
+            imageInfos.reserve(levelCount_compute * 2);
+            writes.reserve(levelCount_compute * 2);
+            uint32_t setIndex = 0;
+            for (auto pTarget : computeTargets)
+            {
+                size_t firstView = resources.imageViews.size();
+                for (uint32_t level = 0; level < pTarget->mipLevelCount; level++)
+                {
+                    if (result_t result = resources.imageViews.emplace_back().Create(
+                            pTarget->image, VK_IMAGE_VIEW_TYPE_2D, pTarget->format,
+                            {VK_IMAGE_ASPECT_COLOR_BIT, level, 1, pTarget->arrayLayer, 1}))
+                    {
+                        return result;
+                    }
+                }
+                for (uint32_t level = 1; level < pTarget->mipLevelCount; level++, setIndex++)
+                {
+                    imageInfos.push_back({VK_NULL_HANDLE, resources.imageViews[firstView + level - 1],
+                                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
+                    writes.push_back({
+                        .dstSet          = descriptorSets[setIndex],
+                        .dstBinding      = 0,
+                        .descriptorCount = 1,
+                        .descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                        .pImageInfo      = &imageInfos.back(),
+                    });
+                    imageInfos.push_back(
+                        {VK_NULL_HANDLE, resources.imageViews[firstView + level], VK_IMAGE_LAYOUT_GENERAL});
+                    writes.push_back({
+                        .dstSet          = descriptorSets[setIndex],
+                        .dstBinding      = 1,
+                        .descriptorCount = 1,
+                        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                        .pImageInfo      = &imageInfos.back(),
+                    });
+                }
+            }
+            descriptorSet::Update({writes.data(), writes.size()});
+        }
+
+        // 第0级转为读取来源，其余等级转为写入目标
+        for (auto pTarget : blitTargets)
+        {
+            barriers.push_back(Barrier(*pTarget, 0, 1, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL));
+            barriers.push_back(Barrier(*pTarget, 1, pTarget->mipLevelCount - 1, 0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                       VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL));
+        }
+        for (auto pTarget : computeTargets)
+        {
+            barriers.push_back(Barrier(*pTarget, 0, 1, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+            barriers.push_back(Barrier(*pTarget, 1, pTarget->mipLevelCount - 1, 0, VK_ACCESS_SHADER_WRITE_BIT,
+                                       VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL));
+        }
+        CmdBarriers(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, barriers);
+
+        // blit路径：所有图像同一级的blit之间没有依赖，每一级之后共用一次屏障
+        for (uint32_t level = 1; level < maxLevelCount_blit; level++)
+        {
+            for (auto pTarget : blitTargets)
+            {
+                if (level >= pTarget->mipLevelCount) { continue; }
+                VkImageBlit region = {
+                    .srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - 1, pTarget->arrayLayer, 1},
+                    .srcOffsets     = {{}, {MipSize(pTarget->extent.width, level - 1),
+                                            MipSize(pTarget->extent.height, level - 1), 1}},
+                    .dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, pTarget->arrayLayer, 1},
+                    .dstOffsets     = {{}, {MipSize(pTarget->extent.width, level),
+                                            MipSize(pTarget->extent.height, level), 1}},
+                };
+                vkCmdBlitImage(commandBuffer, pTarget->image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, pTarget->image,
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region, VK_FILTER_LINEAR);
+                barriers.push_back(Barrier(*pTarget, level, 1, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                           VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                           VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL));
+            }
+            CmdBarriers(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, barriers);
+        }
+
+        // 计算路径：同理，每一级之后共用一次屏障
+        if (!computeTargets.empty())
+        {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_downsample);
+        }
+        for (uint32_t level = 1; level < maxLevelCount_compute; level++)
+        {
+            uint32_t setIndex = 0;
+            for (auto pTarget : computeTargets)
+            {
+                if (level < pTarget->mipLevelCount)
+                {
+                    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout_downsample, 0,
+                                            1, &descriptorSets[setIndex + level - 1], 0, nullptr);
+                    uint32_t width  = MipSize(pTarget->extent.width, level);
+                    uint32_t height = MipSize(pTarget->extent.height, level);
+                    vkCmdDispatch(commandBuffer, (width + workgroupSize - 1) / workgroupSize,
+                                  (height + workgroupSize - 1) / workgroupSize, 1);
+                    barriers.push_back(Barrier(*pTarget, level, 1, VK_ACCESS_SHADER_WRITE_BIT,
+                                               VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                                               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+                }
+                setIndex += pTarget->mipLevelCount - 1;
+            }
+            CmdBarriers(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                        barriers);
+        }
+
+        // 所有图像的全部等级转为着色器只读，计算路径的图像已处于该布局，只需使写入对dstStageMask可见
+        VkPipelineStageFlags srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        for (auto& i : targets)
+        {
+            method targetMethod = i.mipLevelCount > 1 ? Method(i.format) : method::none;
+            if (targetMethod == method::blit)
+            {
+                barriers.push_back(Barrier(i, 0, i.mipLevelCount, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                           VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+            }
+            else if (targetMethod == method::compute)
+            {
+                srcStageMask |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+                barriers.push_back(Barrier(i, 0, i.mipLevelCount, VK_ACCESS_SHADER_WRITE_BIT,
+                                           VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+            }
+            else
+            {
+                barriers.push_back(Barrier(i, 0, 1, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+            }
+        }
+        CmdBarriers(commandBuffer, srcStageMask, dstStageMask, barriers);
+        return VK_SUCCESS;
+    }
+
+    // Non-const Function
+    /**
+     * @brief 创建计算路径所用的管线
+     * @note 失败时不影响blit路径，只是不支持线性blit的格式不再生成mipmap
+     *
+     * @param shaderPath 由MipmapDownsample.comp.shader编译得到的SPIR-V
+     */
+    result_t Create(const char* shaderPath = "shader/MipmapDownsample.comp.spv")
+    {
+        VkPhysicalDeviceFeatures physicalDeviceFeatures;
+        vkGetPhysicalDeviceFeatures(GraphicsBase::Base().PhysicalDevice(), &physicalDeviceFeatures);
+        if (physicalDeviceFeatures.shaderStorageImageWriteWithoutFormat == 0U)
+        {
+            LOG(ERROR) << "[ mipmapGenerator ] ERROR\nshaderStorageImageWriteWithoutFormat isn't supported!";
+            return VK_RESULT_MAX_ENUM;
+        }
+
+        std::array<VkDescriptorSetLayoutBinding, 2> bindings = {{
+            {0, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT},
+            {1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT},
+        }};
+        VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
+            .bindingCount = static_cast<uint32_t>(bindings.size()),
+            .pBindings    = bindings.data(),
+        };
+        if (result_t result = descriptorSetLayout_downsample.Create(descriptorSetLayoutCreateInfo)) { return result; }
+        VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
+            .setLayoutCount = 1,
+            .pSetLayouts    = descriptorSetLayout_downsample.Address(),
+        };
+        if (result_t result = pipelineLayout_downsample.Create(pipelineLayoutCreateInfo)) { return result; }
+        shaderModule shader;
+        if (result_t result = shader.Create(shaderPath)) { return result; }
+        VkComputePipelineCreateInfo pipelineCreateInfo = {
+            .stage  = shader.StageCreateInfo(VK_SHADER_STAGE_COMPUTE_BIT),
+            .layout = pipelineLayout_downsample,
+        };
+        if (result_t result = pipeline_downsample.Create(pipelineCreateInfo)) { return result; }
+        computeAvailable = true;
+        methods.clear();  // 之前查询的格式可能因计算路径可用而改变
+        return VK_SUCCESS;
+    }
+};
+
+}  // namespace easyVulkan
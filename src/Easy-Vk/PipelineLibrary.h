@@ -0,0 +1,322 @@
+#pragma once
+#include "EasyVKStart.h"
+#include "ThreadPool.h"
+#include "VKBase+.h"
+#include "VKBase.h"
+
+#include <deque>
+#include <mutex>
+
+using namespace vulkan;
+
+/*
+以VK_EXT_graphics_pipeline_library快速链接管线：
+1. graphicsPipelineCreateInfoPack被拆成四个管线库：顶点输入接口、光栅化前着色器、片段着色器、片段输出接口，
+   每个部分以其内容的哈希单独缓存，新的材质和顶点格式组合出现时，多数部分可以直接复用
+2. 首次使用某个组合时，不做链接时优化，直接链接四个管线库，这一步很快
+3. 同时向线程池提交带VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT的链接，完成后在Update()中替换快速链接的管线，
+   被替换的管线在若干帧后、GPU不再使用时销毁
+
+不支持该扩展时退化为直接创建完整的管线。
+管线库和管线先按哈希查找，哈希相同时再逐字节比较pipelineStateKey，因而哈希冲突不会返回错误的管线。
+管线库所用的渲染通道由createInfo.renderPass指定，不处理pNext中的VkPipelineRenderingCreateInfo。
+这些扩展须在创建逻辑设备前以EnableDeviceExtensions()开启。
+*/
+
+namespace easyVulkan {
+
+/**
+ * @brief 以管线库快速链接的管线缓存
+ * @note 须在创建逻辑设备之后构造，且在逻辑设备销毁前析构
+ */
+class pipelineLibraryCache {
+    static constexpr std::array<VkGraphicsPipelineLibraryFlagBitsEXT, 4> parts = {
+        VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+        VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+        VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+        VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT,
+    };
+    struct library
+    {
+        VkGraphicsPipelineLibraryFlagBitsEXT part;
+        pipelineStateKey                     key;
+        std::unique_ptr<pipeline>            handle;
+    };
+    struct linkedPipeline
+    {
+        pipelineStateKey          key;
+        std::unique_ptr<pipeline> current;  // 快速链接的管线，或替换后的优化版本
+    };
+    struct retiredPipeline
+    {
+        uint64_t                  frame;
+        std::unique_ptr<pipeline> handle;
+    };
+
+    threadPool&                                                                 pool;
+    uint32_t                                                                    retireDelay;
+    bool                                                                        supported = false;
+    std::unordered_map<uint64_t, std::vector<library>>                          libraries;  // 同一哈希下可能有多个管线库
+    std::unordered_map<uint64_t, std::vector<std::unique_ptr<linkedPipeline>>> pipelines;
+    size_t                                                                      libraryCount  = 0;
+    size_t                                                                      pipelineCount = 0;
+    std::deque<retiredPipeline>                                                 retiredPipelines;
+    std::mutex                                                                  mutex;
+    std::vector<std::pair<linkedPipeline*, std::unique_ptr<pipeline>>>          optimizedPipelines;  // 后台完成的优化版本
+    taskCounter                                                                 optimizingTasks;
+    uint64_t                                                                    frame = 0;
+
+    inline static VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphicsPipelineLibraryFeatures = {
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT,
+    };
+
+    /**
+     * @brief 管线的某一部分的状态，只计入该部分用到的状态
+     * @note 各部分都使用完整的动态状态，因此动态状态计入每一部分
+     */
+    static pipelineStateKey PartKey(const VkGraphicsPipelineCreateInfo& info, VkGraphicsPipelineLibraryFlagBitsEXT part)
+    {
+        pipelineStateKey key;
+        key.DynamicState(info);
+        switch (part)
+        {
+            case VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT: key.VertexInput(info); break;
+            case VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT: key.PreRasterization(info); break;
+            case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT: key.FragmentShader(info); break;
+            case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT: key.FragmentOutput(info); break;
+            default: break;
+        }
+        return key;
+    }
+    /**
+     * @brief 取得管线的某一部分的管线库，不存在时创建
+     */
+    VkPipeline Library(const VkGraphicsPipelineCreateInfo& info, VkGraphicsPipelineLibraryFlagBitsEXT part)
+    {
+        pipelineStateKey      key    = PartKey(info, part);
+        std::vector<library>& bucket = libraries[HashBytes(&part, sizeof part, key.Hash())];
+        for (auto& i : bucket)
+        {
+            if (i.part == part && i.key == key) { return *i.handle; }
+        }
+
+        VkGraphicsPipelineLibraryCreateInfoEXT libraryCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+            .flags = static_cast<VkGraphicsPipelineLibraryFlagsEXT>(part),
+        };
+        // 保留链接时优化所需的信息，后台的优化链接才能进行
+        VkGraphicsPipelineCreateInfo createInfo = {
+            .sType         = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+            .pNext         = &libraryCreateInfo,
+            .flags         = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR |
+                     VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT,
+            .pDynamicState = info.pDynamicState,
+        };
+        std::vector<VkPipelineShaderStageCreateInfo> stages;
+        switch (part)
+        {
+            case VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT:
+                createInfo.pVertexInputState   = info.pVertexInputState;
+                createInfo.pInputAssemblyState = info.pInputAssemblyState;
+                break;
+            case VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT:
+            case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT:
+            {
+                bool fragment = part == VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+                for (uint32_t i = 0; i < info.stageCount; i++)
+                {
+                    if ((info.pStages[i].stage == VK_SHADER_STAGE_FRAGMENT_BIT) == fragment)
+                    {
+                        stages.push_back(info.pStages[i]);
+                    }
+                }
+                createInfo.stageCount = static_cast<uint32_t>(stages.size());
+                createInfo.pStages    = stages.data();
+                createInfo.layout     = info.layout;
+                createInfo.renderPass = info.renderPass;
+                createInfo.subpass    = info.subpass;
+                if (fragment)
+                {
+                    createInfo.pDepthStencilState = info.pDepthStencilState;
+                    createInfo.pMultisampleState  = info.pMultisampleState;
+                }
+                else
+                {
+                    createInfo.pViewportState      = info.pViewportState;
+                    createInfo.pRasterizationState = info.pRasterizationState;
+                    createInfo.pTessellationState  = info.pTessellationState;
+                }
+                break;
+            }
+            default:
+                createInfo.pColorBlendState  = info.pColorBlendState;
+                createInfo.pMultisampleState = info.pMultisampleState;
+                createInfo.renderPass        = info.renderPass;
+                createInfo.subpass           = info.subpass;
+                break;
+        }
+        auto handle = std::make_unique<pipeline>();
+        if (handle->Create(createInfo) != VK_SUCCESS) { return VK_NULL_HANDLE; }
+        bucket.push_back({part, std::move(key), std::move(handle)});
+        libraryCount++;
+        return *bucket.back().handle;
+    }
+    /**
+     * @brief 以链接时优化重新链接，在线程池中执行
+     */
+    void LinkOptimized(linkedPipeline* pLinked, std::array<VkPipeline, 4> libraryHandles, VkPipelineLayout layout)
+    {
+        VkPipelineLibraryCreateInfoKHR libraryCreateInfo = {
+            .sType        = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+            .libraryCount = static_cast<uint32_t>(libraryHandles.size()),
+            .pLibraries   = libraryHandles.data(),
+        };
+        VkGraphicsPipelineCreateInfo createInfo = {
+            .sType  = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+            .pNext  = &libraryCreateInfo,
+            .flags  = VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT,
+            .layout = layout,
+        };
+        auto optimized = std::make_unique<pipeline>();
+        if (optimized->Create(createInfo) != VK_SUCCESS) { return; }
+        std::lock_guard lock(mutex);
+        optimizedPipelines.emplace_back(pLinked, std::move(optimized));
+    }
+    /**
+     * @brief 在后台以链接时优化重新链接，完成后由Update()替换
+     */
+    void Optimize(linkedPipeline* pLinked, std::array<VkPipeline, 4> libraryHandles, VkPipelineLayout layout)
+    {
+        pool.Submit([this, pLinked, libraryHandles, layout] { LinkOptimized(pLinked, libraryHandles, layout); },
+                    optimizingTasks);
+    }
+
+    void SwapInOptimized()
+    {
+        std::lock_guard lock(mutex);
+        for (auto& [pLinked, optimized] : optimizedPipelines)
+        {
+            retiredPipelines.push_back({frame, std::move(pLinked->current)});
+            pLinked->current = std::move(optimized);
+        }
+        optimizedPipelines.clear();
+    }
+
+public:
+    /**
+     * @param retireDelay 被替换的管线在这么多次Update()之后销毁，应不小于同时处理的帧数
+     */
+    pipelineLibraryCache(uint32_t retireDelay = 3, threadPool& pool = threadPool::Shared())
+        : pool(pool), retireDelay(retireDelay)
+    {
+        supported = GraphicsPipelineLibrarySupported();
+    }
+    pipelineLibraryCache(const pipelineLibraryCache&)            = delete;
+    pipelineLibraryCache& operator=(const pipelineLibraryCache&) = delete;
+    ~pipelineLibraryCache() { WaitIdle(); }
+
+    // Getter
+    bool   Supported() const { return supported; }
+    size_t LibraryCount() const { return libraryCount; }
+    size_t PipelineCount() const { return pipelineCount; }
+
+    // Non-const Function
+    /**
+     * @brief 取得与创建信息对应的管线，不存在时快速链接
+     * @note 每次绘制前都应调用，以取得优化版本替换后的管线；返回的管线在retireDelay次Update()之内有效
+     *
+     * @return VkPipeline 创建失败时返回VK_NULL_HANDLE
+     */
+    VkPipeline Get(const graphicsPipelineCreateInfoPack& pack)
+    {
+        const VkGraphicsPipelineCreateInfo& info = pack.createInfo;
+        pipelineStateKey                    key(info);
+        auto&                               bucket = pipelines[key.Hash()];
+        for (auto& i : bucket)
+        {
+            if (i->key == key) { return *i->current; }
+        }
+
+        auto linked     = std::make_unique<linkedPipeline>();
+        linked->key     = std::move(key);
+        linked->current = std::make_unique<pipeline>();
+        if (!supported)
+        {
+            VkGraphicsPipelineCreateInfo createInfo = info;
+            if (linked->current->Create(createInfo) != VK_SUCCESS) { return VK_NULL_HANDLE; }
+        }
+        else
+        {
+            std::array<VkPipeline, 4> libraryHandles;
+            for (size_t i = 0; i < parts.size(); i++)
+            {
+                libraryHandles[i] = Library(info, parts[i]);
+                if (libraryHandles[i] == VK_NULL_HANDLE) { return VK_NULL_HANDLE; }
+            }
+            VkPipelineLibraryCreateInfoKHR libraryCreateInfo = {
+                .sType        = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+                .libraryCount = static_cast<uint32_t>(libraryHandles.size()),
+                .pLibraries   = libraryHandles.data(),
+            };
+            VkGraphicsPipelineCreateInfo createInfo = {
+                .sType  = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+                .pNext  = &libraryCreateInfo,
+                .layout = info.layout,
+            };
+            if (linked->current->Create(createInfo) != VK_SUCCESS) { return VK_NULL_HANDLE; }
+            Optimize(linked.get(), libraryHandles, info.layout);
+        }
+        bucket.push_back(std::move(linked));
+        pipelineCount++;
+        return *bucket.back()->current;
+    }
+    /**
+     * @brief 每帧调用一次，换入后台完成的优化版本，销毁已不再被GPU使用的旧管线
+     */
+    void Update()
+    {
+        frame++;
+        SwapInOptimized();
+        while (!retiredPipelines.empty() && frame - retiredPipelines.front().frame > retireDelay)
+        {
+            retiredPipelines.pop_front();
+        }
+    }
+    /**
+     * @brief 等待所有后台的优化链接完成并换入
+     */
+    void WaitIdle()
+    {
+        optimizingTasks.Wait();
+        SwapInOptimized();
+    }
+
+    // Static Function
+    /**
+     * @brief 检查并添加管线库所需的设备级扩展和特性，须在创建逻辑设备前调用
+     * @note 物理设备不支持时不开启，不视为错误
+     */
+    static result_t EnableDeviceExtensions()
+    {
+        std::vector<const char*> extensions = {
+            VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME,
+            VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME,
+        };
+        if (result_t result = GraphicsBase::Base().CheckDeviceExtensions(extensions)) { return result; }
+        if (extensions[0] == nullptr || extensions[1] == nullptr) { return VK_SUCCESS; }  // 后者依赖前者
+        GraphicsBase::Base().AddDeviceExtension(extensions[0]);
+        GraphicsBase::Base().AddDeviceExtension(extensions[1]);
+        GraphicsBase::Base().AddDeviceFeatures(&graphicsPipelineLibraryFeatures);
+        return VK_SUCCESS;
+    }
+    /**
+     * @brief 逻辑设备是否开启了图形管线库，须在创建逻辑设备后调用
+     */
+    static bool GraphicsPipelineLibrarySupported()
+    {
+        return GraphicsBase::Base().DeviceExtensionEnabled(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME) &&
+               graphicsPipelineLibraryFeatures.graphicsPipelineLibrary != VK_FALSE;
+    }
+};
+
+}  // namespace easyVulkan
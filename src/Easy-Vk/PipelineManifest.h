@@ -0,0 +1,174 @@
+#pragma once
+#include "AsyncPipelineCompiler.h"
+#include "EasyVKStart.h"
+#include "VKBase+.h"
+#include "VKBase.h"
+
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+using namespace vulkan;
+
+/*
+管线使用清单，用于在启动时预热管线：
+1. 运行时以Record(...)记下每个用到的管线及其在本次运行中首次使用的时刻（自清单构造起的毫秒数）
+2. 退出前以Save(...)合并到清单文件，同一管线取各次运行中最早的首次使用时刻，按该时刻排序
+3. 下次启动时Load(...)读取清单，Prewarm(...)按首次使用的先后，经由调用者提供的函数重建创建信息包，
+   提交给asyncPipelineCompiler在后台编译，多数管线在首次使用前即已就绪
+
+管线的句柄、着色器模块等在每次运行中都不同，pipelineStateKey无法跨运行使用，
+因此清单以调用者给出的名称（如"材质名/顶点格式/渲染通道"）标识管线，名称须能唯一地确定如何构建该管线。
+DistinctStateCount()给出本次运行中实际用到的不同管线状态的个数，可与名称的个数比较。
+
+清单每行一个管线：首次使用的毫秒数，制表符，名称。
+*/
+
+namespace easyVulkan {
+
+/**
+ * @brief 管线使用清单
+ * @note 线程安全
+ */
+class pipelineUsageManifest {
+    struct record
+    {
+        std::string name;
+        double      firstUse;  // 自清单构造起的毫秒数
+    };
+    std::vector<record>                   records;      // 本次运行中用到的管线，按首次使用的先后
+    std::set<std::string, std::less<>>    names;        // 以std::less<>按std::string_view查找，不构造std::string
+    std::unordered_set<uint64_t>          stateHashes;  // 本次运行中用到的管线状态
+    std::vector<record>                   loadedRecords;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    mutable std::mutex                    mutex;
+
+    static std::vector<record> Read(const char* filepath)
+    {
+        std::vector<record> result;
+        std::ifstream       file(filepath);
+        for (std::string line; std::getline(file, line);)
+        {
+            size_t tab = line.find('\t');
+            if (tab == std::string::npos || tab + 1 == line.size()) { continue; }
+            result.push_back({line.substr(tab + 1), std::strtod(line.c_str(), nullptr)});
+        }
+        return result;
+    }
+
+public:
+    pipelineUsageManifest() = default;
+    pipelineUsageManifest(const pipelineUsageManifest&)            = delete;
+    pipelineUsageManifest& operator=(const pipelineUsageManifest&) = delete;
+
+    // Getter
+    size_t Count() const
+    {
+        std::lock_guard lock(mutex);
+        return records.size();
+    }
+    size_t DistinctStateCount() const
+    {
+        std::lock_guard lock(mutex);
+        return stateHashes.size();
+    }
+    size_t LoadedCount() const
+    {
+        std::lock_guard lock(mutex);
+        return loadedRecords.size();
+    }
+
+    // Const Function
+    /**
+     * @brief 把本次运行的记录合并到清单文件中
+     */
+    result_t Save(const char* filepath) const
+    {
+        std::vector<record> merged = Read(filepath);
+        {
+            std::lock_guard lock(mutex);
+            for (const auto& i : records)
+            {
+                auto iterator =
+                    std::find_if(merged.begin(), merged.end(), [&i](const record& r) { return r.name == i.name; });
+                if (iterator == merged.end()) { merged.push_back(i); }
+                else { iterator->firstUse = std::min(iterator->firstUse, i.firstUse); }
+            }
+        }
+        std::stable_sort(merged.begin(), merged.end(),
+                         [](const record& a, const record& b) { return a.firstUse < b.firstUse; });
+
+        std::string   temporaryPath = std::string(filepath) + ".tmp";
+        std::ofstream file(temporaryPath, std::ios::trunc);
+        for (const auto& i : merged) { file << std::format("{:.1f}\t{}\n", i.firstUse, i.name); }
+        file.close();
+        std::error_code errorCode;
+        if (file) { std::filesystem::rename(temporaryPath, filepath, errorCode); }
+        if (!file || errorCode)
+        {
+            LOG(ERROR) << "[ pipelineUsageManifest ] ERROR\nFailed to write the manifest: " << filepath;
+            return VK_RESULT_MAX_ENUM;
+        }
+        return VK_SUCCESS;
+    }
+
+    // Non-const Function
+    /**
+     * @brief 记下一次管线的使用，只有首次使用被记录
+     * @note pack须已调用UpdateAllArrays()；计算状态的哈希有一定开销，宜在请求管线时调用，而非每次绘制时
+     */
+    void Record(std::string_view name, const graphicsPipelineCreateInfoPack& pack)
+    {
+        uint64_t        hash = pack.Hash();
+        std::lock_guard lock(mutex);
+        stateHashes.insert(hash);
+        if (names.contains(name)) { return; }
+        double firstUse = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        names.emplace(name);
+        records.push_back({std::string(name), firstUse});
+    }
+    /**
+     * @brief 读取上一次保存的清单
+     *
+     * @return result_t 文件不存在时返回VK_SUCCESS，此时没有可预热的管线
+     */
+    result_t Load(const char* filepath)
+    {
+        if (!std::filesystem::exists(filepath)) { return VK_SUCCESS; }
+        std::vector<record> loaded = Read(filepath);
+        std::stable_sort(loaded.begin(), loaded.end(),
+                         [](const record& a, const record& b) { return a.firstUse < b.firstUse; });
+        std::lock_guard lock(mutex);
+        loadedRecords = std::move(loaded);
+        return VK_SUCCESS;
+    }
+    /**
+     * @brief 按首次使用的先后，在后台编译已读取的清单中的管线
+     *
+     * @param build 按名称填写创建信息包，无法构建（如对应的资源已不存在）时返回false，该名称被跳过
+     * @return uint32_t 提交编译的管线个数
+     */
+    uint32_t Prewarm(asyncPipelineCompiler&                                                           compiler,
+                     const std::function<bool(std::string_view name, graphicsPipelineCreateInfoPack&)>& build)
+    {
+        std::vector<record> loaded;
+        {
+            std::lock_guard lock(mutex);
+            loaded = loadedRecords;
+        }
+        uint32_t count = 0;
+        for (const auto& i : loaded)
+        {
+            graphicsPipelineCreateInfoPack pack;
+            if (!build(i.name, pack)) { continue; }
+            pack.UpdateAllArrays();
+            if (compiler.Prewarm(pack)) { count++; }
+        }
+        return count;
+    }
+};
+
+}  // namespace easyVulkan
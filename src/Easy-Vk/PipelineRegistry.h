@@ -0,0 +1,128 @@
+#pragma once
+#include "EasyVKStart.h"
+#include "VKBase+.h"
+#include "VKBase.h"
+
+#include <condition_variable>
+#include <mutex>
+
+using namespace vulkan;
+
+/*
+进程内共享的管线登记表：
+以pipelineStateKey比较管线状态，状态相同的创建请求返回同一个管线，不同的材质、通道间不会重复创建等价的管线。
+先按哈希查找，哈希相同时再逐字节比较规范化的状态，因而哈希冲突不会返回错误的管线。
+管线在锁外创建，创建期间登记表中放着占位的条目：请求同一管线的其他线程等待其创建完成，请求其他管线的线程不受影响。
+pNext链中有pipelineStateKey不认识的结构体时不去重，每次Get(...)都创建新的管线，调用者应自行保存句柄。
+
+着色器模块以句柄比较，应经shaderModuleCache取得，使内容相同的SPIR-V对应同一个句柄；
+渲染通道同样以句柄比较，不判断不同渲染通道间的兼容性。
+管线在逻辑设备销毁时随之销毁，此后的Get(...)会重新创建。
+*/
+
+namespace easyVulkan {
+
+/**
+ * @brief 以管线状态为键的管线登记表，线程安全
+ */
+class pipelineRegistry {
+    struct entry
+    {
+        pipelineStateKey                  key;
+        std::unique_ptr<vulkan::pipeline> pipeline;
+        bool                              created = false;  // 创建完成后为true，无论成功与否
+    };
+    std::unordered_map<uint64_t, std::vector<std::shared_ptr<entry>>> entries;  // 同一哈希下可能有多个状态
+    size_t                                                            count = 0;
+    mutable std::mutex                                                mutex;
+    std::condition_variable                                           condition;  // 有条目创建完成时通知
+    inline static bool                                                alive = false;
+
+    template <typename T>
+    VkPipeline Get(pipelineStateKey&& key, T createInfo)
+    {
+        uint64_t         hash = key.Hash();
+        std::unique_lock lock(mutex);
+        for (auto& i : entries[hash])
+        {
+            if (!(i->key == key)) { continue; }
+            std::shared_ptr<entry> pEntry = i;  // 等待期间条目可能被移出登记表
+            condition.wait(lock, [&pEntry] { return pEntry->created; });
+            return pEntry->pipeline ? VkPipeline(*pEntry->pipeline) : VK_NULL_HANDLE;
+        }
+        auto pEntry = entries[hash].emplace_back(std::make_shared<entry>(entry{std::move(key)}));
+        lock.unlock();
+
+        auto pipeline  = std::make_unique<vulkan::pipeline>();
+        bool succeeded = pipeline->Create(createInfo) == VK_SUCCESS;
+
+        lock.lock();
+        if (succeeded)
+        {
+            pEntry->pipeline = std::move(pipeline);
+            count++;
+        }
+        else
+        {
+            std::erase(entries[hash], pEntry);  // 移除占位的条目，之后的请求重新创建
+        }
+        pEntry->created = true;
+        condition.notify_all();
+        return succeeded ? VkPipeline(*pEntry->pipeline) : VK_NULL_HANDLE;
+    }
+
+public:
+    pipelineRegistry()
+    {
+        alive = true;
+        std::function<void()> clear = [this] {
+            if (alive) { Clear(); }
+        };
+        GraphicsBase::Base().AddCallback_DestroyDevice(clear);
+    }
+    ~pipelineRegistry() { alive = false; }
+    pipelineRegistry(const pipelineRegistry&)            = delete;
+    pipelineRegistry& operator=(const pipelineRegistry&) = delete;
+
+    // Getter
+    size_t Count() const
+    {
+        std::lock_guard lock(mutex);
+        return count;
+    }
+
+    // Non-const Function
+    /**
+     * @brief 取得与创建信息包状态相同的管线，不存在时创建
+     * @note 须已调用pack.UpdateAllArrays()
+     *
+     * @return VkPipeline 创建失败时返回VK_NULL_HANDLE，句柄在Clear()前始终有效
+     */
+    VkPipeline Get(const graphicsPipelineCreateInfoPack& pack)
+    {
+        return Get(pipelineStateKey(pack.createInfo), pack.createInfo);
+    }
+    VkPipeline Get(const VkComputePipelineCreateInfo& createInfo)
+    {
+        return Get(pipelineStateKey(createInfo), createInfo);
+    }
+    /**
+     * @brief 销毁所有管线
+     * @note 须确保GPU不再使用其中的管线，且没有正在进行的Get(...)
+     */
+    void Clear()
+    {
+        std::lock_guard lock(mutex);
+        entries.clear();
+        count = 0;
+    }
+
+    // Static Function
+    static pipelineRegistry& Shared()
+    {
+        static pipelineRegistry registry;
+        return registry;
+    }
+};
+
+}  // namespace easyVulkan
@@ -0,0 +1,145 @@
+#pragma once
+#include "EasyVKStart.h"
+#include "VKBase.h"
+
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+using namespace vulkan;
+
+/*
+进程内共享的着色器模块缓存：
+1. 以路径查找，命中时不再读取文件，重复创建管线时直接复用已有的着色器模块；构建时嵌入的SPIR-V优先于文件，
+   但Invalidate(...)过的路径此后总是读取文件，使热重载能取得重新编译的着色器
+2. 未命中时映射文件并计算内容的哈希，内容相同的文件（如不同路径下的同一份SPIR-V）共用一个着色器模块
+3. 着色器模块在逻辑设备销毁时随之销毁，此后的Get(...)会重新创建
+
+缓存只增不减，Invalidate(...)只移除路径到模块的对应关系，已创建的管线仍可安全地引用旧的着色器模块。
+*/
+
+namespace easyVulkan {
+
+/**
+ * @brief 以路径和内容哈希为键的着色器模块缓存，线程安全
+ */
+class shaderModuleCache {
+    std::unordered_map<std::string, uint64_t>                            paths;          // 路径到内容哈希
+    std::unordered_map<uint64_t, std::unique_ptr<vulkan::shaderModule>> modules;        // 内容哈希到着色器模块
+    std::unordered_set<std::string>                                      reloadedPaths;  // 不再使用嵌入的SPIR-V的路径
+    mutable std::mutex                                                   mutex;
+    inline static bool alive = false;  // 平凡类型的静态变量不会被析构，静态对象析构后仍可安全读取
+
+    /**
+     * @note 调用前须已锁定mutex
+     */
+    const vulkan::shaderModule* Find(uint64_t hash, size_t codeSize, const uint32_t* pCode)
+    {
+        auto iterator = modules.find(hash);
+        if (iterator != modules.end()) { return iterator->second.get(); }
+        auto module = std::make_unique<vulkan::shaderModule>();
+        if (module->Create(codeSize, pCode) != VK_SUCCESS) { return nullptr; }
+        return modules.emplace(hash, std::move(module)).first->second.get();
+    }
+
+public:
+    shaderModuleCache()
+    {
+        alive = true;
+        // GraphicsBase的单例先于缓存构造、晚于缓存析构，回调须检查缓存是否仍存在
+        std::function<void()> clear = [this] {
+            if (alive) { Clear(); }
+        };
+        GraphicsBase::Base().AddCallback_DestroyDevice(clear);
+    }
+    ~shaderModuleCache() { alive = false; }
+    shaderModuleCache(const shaderModuleCache&)            = delete;
+    shaderModuleCache& operator=(const shaderModuleCache&) = delete;
+
+    // Getter
+    size_t ModuleCount() const
+    {
+        std::lock_guard lock(mutex);
+        return modules.size();
+    }
+
+    // Non-const Function
+    /**
+     * @brief 取得文件对应的着色器模块
+     *
+     * @return const shaderModule* 读取或创建失败时返回nullptr，指针在Clear()前始终有效
+     */
+    const vulkan::shaderModule* Get(const char* filepath)
+    {
+        std::lock_guard lock(mutex);
+        auto            path = paths.find(filepath);
+        if (path != paths.end()) { return modules.at(path->second).get(); }
+
+        embeddedSpirv spirv;
+        if (reloadedPaths.count(filepath) == 0) { spirv = shaderRegistry::Shared().Find(filepath); }
+        if (spirv)
+        {
+            uint64_t                    hash    = HashBytes(spirv.pCode, spirv.codeSize);
+            const vulkan::shaderModule* pModule = Find(hash, spirv.codeSize, spirv.pCode);
+            if (pModule != nullptr) { paths.emplace(filepath, hash); }
+            return pModule;
+        }
+        mappedFile file;
+        if (file.Open(filepath) != VK_SUCCESS) { return nullptr; }
+        if (!vulkan::shaderModule::IsSpirv(file.Data(), file.Size()))
+        {
+            LOG(ERROR) << "[ shaderModuleCache ] ERROR\nThe file isn't valid SPIR-V: " << filepath;
+            return nullptr;
+        }
+        uint64_t                    hash    = HashBytes(file.Data(), file.Size());
+        const vulkan::shaderModule* pModule =
+            Find(hash, file.Size(), reinterpret_cast<const uint32_t*>(file.Data()));
+        if (pModule != nullptr) { paths.emplace(filepath, hash); }
+        return pModule;
+    }
+    /**
+     * @brief 取得内存中的SPIR-V对应的着色器模块，以内容哈希查找
+     */
+    const vulkan::shaderModule* Get(size_t codeSize, const uint32_t* pCode)
+    {
+        if (!vulkan::shaderModule::IsSpirv(pCode, codeSize))
+        {
+            LOG(ERROR) << "[ shaderModuleCache ] ERROR\nThe code isn't valid SPIR-V!";
+            return nullptr;
+        }
+        uint64_t        hash = HashBytes(pCode, codeSize);
+        std::lock_guard lock(mutex);
+        return Find(hash, codeSize, pCode);
+    }
+    /**
+     * @brief 使下一次Get(filepath)重新读取文件，用于着色器被重新编译后
+     * @note 此后该路径不再使用构建时嵌入的SPIR-V，即便文件读取失败
+     */
+    void Invalidate(const char* filepath)
+    {
+        std::lock_guard lock(mutex);
+        paths.erase(filepath);
+        reloadedPaths.emplace(filepath);
+    }
+    /**
+     * @brief 销毁所有着色器模块
+     * @note 须确保没有正在创建的管线引用其中的着色器模块
+     */
+    void Clear()
+    {
+        std::lock_guard lock(mutex);
+        paths.clear();
+        modules.clear();
+        reloadedPaths.clear();
+    }
+
+    // Static Function
+    // 在逻辑设备销毁前随静态对象一并析构
+    static shaderModuleCache& Shared()
+    {
+        static shaderModuleCache cache;
+        return cache;
+    }
+};
+
+}  // namespace easyVulkan
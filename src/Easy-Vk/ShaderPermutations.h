@@ -0,0 +1,370 @@
+#pragma once
+#include "EasyVKStart.h"
+#include "ShaderModuleCache.h"
+#include "VKBase.h"
+
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+
+#ifdef EASY_VK_SHADERC
+#    include <shaderc/shaderc.hpp>
+#endif
+
+using namespace vulkan;
+
+/*
+着色器的排列组合（permutation）：
+1. 着色器声明一组关键字，每个关键字对应一个#define，变体以关键字的位掩码表示
+2. 取得变体时依次尝试：
+   a. 构建时嵌入的变体，名称见VariantName(...)，由CMakeLists.txt按变体清单编译
+   b. 磁盘缓存，文件名为源文件、被包含的文件、宏定义以及目标环境和优化选项的哈希，内容不变时跨运行复用
+      （shaderc本身的版本不计入哈希，升级后须递增cacheVersion或清空缓存目录）
+   c. 定义了EASY_VK_SHADERC时，以shaderc在运行时编译，并写入磁盘缓存
+3. SaveUsage(...)把用到的变体记录到变体清单，打包时以EASY_VK_SHADER_VARIANT_MANIFEST指定清单，
+   只有清单中的变体被编译并嵌入，没用到的变体不会进入发行版
+
+变体清单每行一个变体：源文件名（相对于shader/），之后是以空格分隔的关键字。
+*/
+
+namespace easyVulkan {
+
+/**
+ * @brief 着色器变体的编译选项
+ */
+struct shaderPermutationOptions
+{
+    std::string              cacheDirectory = "shader_cache";
+    std::vector<std::string> includeDirectories;  // 先在包含者所在的目录中查找，再依次在这些目录中查找
+
+    // 运行时编译的目标环境和优化选项，计入磁盘缓存的键。目标环境的默认值与CMakeLists.txt中EASY_VK_SHADER_TARGET_ENV的一致
+    uint32_t targetVulkanVersion = VK_API_VERSION_1_2;
+    bool     optimize            = true;  // 以性能为目标优化
+};
+
+/**
+ * @brief 一个着色器源文件的所有变体
+ * @note 线程安全；至多64个关键字
+ */
+class shaderPermutations {
+    // 缓存文件格式的版本，缓存格式或编译器改变时递增，使旧的缓存失效
+    static constexpr uint32_t cacheVersion = 1;
+
+    std::string                                          sourcePath;
+    std::vector<std::string>                             keywords;
+    shaderPermutationOptions                             options;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> variants;  // 位掩码到SPIR-V
+    std::set<uint64_t>                                   used;
+    mutable std::mutex                                   mutex;
+
+    /**
+     * @brief 按#include的写法查找被包含的文件
+     * @return std::string 找不到时返回空字符串
+     */
+    std::string ResolveInclude(const std::string& requested, const std::string& requesting) const
+    {
+        std::filesystem::path candidate = std::filesystem::path(requesting).parent_path() / requested;
+        if (std::filesystem::exists(candidate)) { return candidate.string(); }
+        for (const auto& i : options.includeDirectories)
+        {
+            candidate = std::filesystem::path(i) / requested;
+            if (std::filesystem::exists(candidate)) { return candidate.string(); }
+        }
+        return {};
+    }
+    /**
+     * @brief 把文件及其递归包含的所有文件的内容计入哈希
+     * @note 只按文本扫描#include行，不求值条件编译，因此可能多计入一些文件，但不会漏掉
+     */
+    bool HashFile(const std::string& path, uint64_t& hash, std::set<std::string>& visited) const
+    {
+        if (!visited.insert(path).second) { return true; }
+        mappedFile file;
+        if (file.Open(path.c_str()) != VK_SUCCESS) { return false; }
+        hash = HashBytes(file.Data(), file.Size(), hash);
+
+        std::string_view  text(reinterpret_cast<const char*>(file.Data()), file.Size());
+        std::stringstream lines{std::string(text)};
+        for (std::string line; std::getline(lines, line);)
+        {
+            size_t directive = line.find_first_not_of(" \t");
+            if (directive == std::string::npos || line.compare(directive, 8, "#include") != 0) { continue; }
+            size_t begin = line.find_first_of("\"<", directive + 8);
+            size_t end   = begin == std::string::npos ? begin : line.find_first_of("\">", begin + 1);
+            if (end == std::string::npos) { continue; }
+            std::string included = ResolveInclude(line.substr(begin + 1, end - begin - 1), path);
+            if (included.empty()) { continue; }  // 交由编译器报错
+            if (!HashFile(included, hash, visited)) { return false; }
+        }
+        return true;
+    }
+    /**
+     * @return uint64_t 变体的内容地址，读取源文件失败时返回0
+     */
+    uint64_t CacheKey(uint64_t mask) const
+    {
+        uint64_t              hash = HashBytes(&cacheVersion, sizeof cacheVersion);
+        std::set<std::string> visited;
+        if (!HashFile(sourcePath, hash, visited)) { return 0; }
+        for (const auto& i : Defines(mask)) { hash = HashBytes(i.data(), i.size() + 1, hash); }
+        hash = HashBytes(&options.targetVulkanVersion, sizeof options.targetVulkanVersion, hash);
+        hash = HashBytes(&options.optimize, sizeof options.optimize, hash);
+        return hash;
+    }
+    std::string CachePath(uint64_t key) const
+    {
+        return (std::filesystem::path(options.cacheDirectory) / std::format("{:016x}.spv", key)).string();
+    }
+    std::vector<std::string> Defines(uint64_t mask) const
+    {
+        std::vector<std::string> defines;
+        for (size_t i = 0; i < keywords.size(); i++)
+        {
+            if (((mask >> i) & 1) != 0U) { defines.push_back(keywords[i]); }
+        }
+        return defines;
+    }
+    result_t ReadCache(uint64_t key, std::vector<uint32_t>& code) const
+    {
+        std::string path = CachePath(key);
+        if (!std::filesystem::exists(path)) { return VK_RESULT_MAX_ENUM; }
+        mappedFile file;
+        if (file.Open(path.c_str()) != VK_SUCCESS || !shaderModule::IsSpirv(file.Data(), file.Size()))
+        {
+            LOG(WARNING) << "[ shaderPermutations ] WARNING\nIgnoring the invalid cache file: " << path;
+            return VK_RESULT_MAX_ENUM;
+        }
+        code.resize(file.Size() / 4);
+        memcpy(code.data(), file.Data(), file.Size());
+        return VK_SUCCESS;
+    }
+    /**
+     * @note 先写入临时文件再改名，其他进程不会读到写了一半的缓存
+     */
+    void WriteCache(uint64_t key, const std::vector<uint32_t>& code) const
+    {
+        std::error_code errorCode;
+        std::filesystem::create_directories(options.cacheDirectory, errorCode);
+        std::string   path          = CachePath(key);
+        std::string   temporaryPath = path + ".tmp";
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(code.data()), static_cast<std::streamsize>(code.size() * 4));
+        file.close();
+        if (file) { std::filesystem::rename(temporaryPath, path, errorCode); }
+        if (!file || errorCode)
+        {
+            LOG(WARNING) << "[ shaderPermutations ] WARNING\nFailed to write the cache file: " << path;
+            std::filesystem::remove(temporaryPath, errorCode);
+        }
+    }
+#ifdef EASY_VK_SHADERC
+    class includer : public shaderc::CompileOptions::IncluderInterface {
+        struct include
+        {
+            shaderc_include_result result;
+            std::string            path;
+            std::string            content;
+        };
+        const shaderPermutations& permutations;
+
+    public:
+        includer(const shaderPermutations& permutations) : permutations(permutations) {}
+        shaderc_include_result* GetInclude(const char* requested_source,
+                                           shaderc_include_type /*type*/,
+                                           const char* requesting_source,
+                                           size_t /*include_depth*/) override
+        {
+            auto* pInclude = new include;
+            pInclude->path = permutations.ResolveInclude(requested_source, requesting_source);
+            if (pInclude->path.empty()) { pInclude->content = std::format("Cannot find {}", requested_source); }
+            else
+            {
+                std::ifstream file(pInclude->path, std::ios::binary);
+                pInclude->content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            }
+            // source_name为空表示包含失败，此时content为错误信息
+            pInclude->result = {pInclude->path.data(), pInclude->path.size(), pInclude->content.data(),
+                                pInclude->content.size(), pInclude};
+            return &pInclude->result;
+        }
+        void ReleaseInclude(shaderc_include_result* data) override
+        {
+            delete static_cast<include*>(data->user_data);
+        }
+    };
+
+    static shaderc_shader_kind ShaderKind(const std::string& path)
+    {
+        // .shader等其他扩展名的文件以#pragma shader_stage(...)指定着色器阶段
+        static const std::unordered_map<std::string, shaderc_shader_kind> kinds = {
+            {".vert", shaderc_glsl_default_vertex_shader},
+            {".frag", shaderc_glsl_default_fragment_shader},
+            {".comp", shaderc_glsl_default_compute_shader},
+            {".geom", shaderc_glsl_default_geometry_shader},
+            {".tesc", shaderc_glsl_default_tess_control_shader},
+            {".tese", shaderc_glsl_default_tess_evaluation_shader},
+        };
+        auto iterator = kinds.find(std::filesystem::path(path).extension().string());
+        return iterator == kinds.end() ? shaderc_glsl_infer_from_source : iterator->second;
+    }
+    result_t Compile(uint64_t mask, std::vector<uint32_t>& code) const
+    {
+        mappedFile source;
+        if (result_t result = source.Open(sourcePath.c_str())) { return result; }
+        shaderc::Compiler       compiler;
+        shaderc::CompileOptions compileOptions;
+        // shaderc_env_version_vulkan_1_x的值与VK_API_VERSION_1_x相同
+        compileOptions.SetTargetEnvironment(shaderc_target_env_vulkan, options.targetVulkanVersion);
+        compileOptions.SetOptimizationLevel(options.optimize ? shaderc_optimization_level_performance
+                                                             : shaderc_optimization_level_zero);
+        compileOptions.SetIncluder(std::make_unique<includer>(*this));
+        for (const auto& i : Defines(mask)) { compileOptions.AddMacroDefinition(i); }
+        shaderc::SpvCompilationResult spirv =
+            compiler.CompileGlslToSpv(reinterpret_cast<const char*>(source.Data()), source.Size(),
+                                      ShaderKind(sourcePath), sourcePath.c_str(), compileOptions);
+        if (spirv.GetCompilationStatus() != shaderc_compilation_status_success)
+        {
+            LOG(ERROR) << "[ shaderPermutations ] ERROR\nFailed to compile " << VariantName(mask) << "\n"
+                       << spirv.GetErrorMessage();
+            return VK_RESULT_MAX_ENUM;
+        }
+        code.assign(spirv.cbegin(), spirv.cend());
+        return VK_SUCCESS;
+    }
+#endif
+
+public:
+    /**
+     * @param keywords 各关键字作为宏定义传给着色器，其下标即位掩码中的位
+     */
+    shaderPermutations(std::string                     sourcePath,
+                       std::vector<std::string>        keywords,
+                       const shaderPermutationOptions& options = {})
+        : sourcePath(std::move(sourcePath)), keywords(std::move(keywords)), options(options)
+    {
+        if (this->keywords.size() > 64)
+        {
+            LOG(ERROR) << "[ shaderPermutations ] ERROR\nToo many keywords in " << this->sourcePath;
+            this->keywords.resize(64);
+        }
+    }
+
+    // Getter
+    const std::string&              SourcePath() const { return sourcePath; }
+    const std::vector<std::string>& Keywords() const { return keywords; }
+
+    // Const Function
+    /**
+     * @brief 由关键字的名称得到位掩码，未声明的关键字被忽略并报错
+     */
+    uint64_t Mask(std::initializer_list<std::string_view> enabledKeywords) const
+    {
+        uint64_t mask = 0;
+        for (auto i : enabledKeywords)
+        {
+            auto iterator = std::find(keywords.begin(), keywords.end(), i);
+            if (iterator == keywords.end())
+            {
+                LOG(ERROR) << "[ shaderPermutations ] ERROR\nUndeclared keyword " << i << " in " << sourcePath;
+                continue;
+            }
+            mask |= uint64_t(1) << (iterator - keywords.begin());
+        }
+        return mask;
+    }
+    /**
+     * @brief 变体的SPIR-V文件名，如FirstTriangle.frag.shader的变体为"FirstTriangle.frag+SHADOW+FOG.spv"
+     */
+    std::string VariantName(uint64_t mask) const
+    {
+        std::string name = std::filesystem::path(sourcePath).filename().string();
+        if (name.ends_with(".shader")) { name.resize(name.size() - 7); }
+        for (const auto& i : Defines(mask)) { name += "+" + i; }
+        return name + ".spv";
+    }
+    /**
+     * @brief 把用到的变体合并到变体清单中
+     */
+    result_t SaveUsage(const char* manifestPath) const
+    {
+        std::set<std::string> lines;
+        {
+            std::ifstream manifest(manifestPath);
+            for (std::string line; std::getline(manifest, line);)
+            {
+                if (!line.empty()) { lines.insert(line); }
+            }
+        }
+        {
+            std::lock_guard lock(mutex);
+            std::string     source = std::filesystem::path(sourcePath).filename().string();
+            for (uint64_t mask : used)
+            {
+                std::string line = source;
+                for (const auto& i : Defines(mask)) { line += " " + i; }
+                lines.insert(line);
+            }
+        }
+        std::ofstream manifest(manifestPath, std::ios::trunc);
+        for (const auto& i : lines) { manifest << i << "\n"; }
+        manifest.close();
+        if (!manifest)
+        {
+            LOG(ERROR) << "[ shaderPermutations ] ERROR\nFailed to write the variant manifest: " << manifestPath;
+            return VK_RESULT_MAX_ENUM;
+        }
+        return VK_SUCCESS;
+    }
+
+    // Non-const Function
+    /**
+     * @brief 取得变体的着色器模块，按嵌入的变体、磁盘缓存、运行时编译的顺序查找
+     *
+     * @return const shaderModule* 失败时返回nullptr，着色器模块由shaderModuleCache持有
+     */
+    const shaderModule* Get(uint64_t mask)
+    {
+        std::lock_guard lock(mutex);
+        used.insert(mask);
+        auto iterator = variants.find(mask);
+        if (iterator == variants.end())
+        {
+            std::vector<uint32_t> code;
+            // 变体与源文件在同一目录下，只有shader/下的源文件的变体才可能被嵌入
+            std::filesystem::path variantPath = std::filesystem::path(sourcePath).parent_path() / VariantName(mask);
+            if (embeddedSpirv spirv = shaderRegistry::Shared().Find(variantPath.generic_string()))
+            {
+                code.assign(spirv.pCode, spirv.pCode + spirv.codeSize / 4);
+            }
+            else
+            {
+                uint64_t key = CacheKey(mask);
+                if (key == 0)
+                {
+                    LOG(ERROR) << "[ shaderPermutations ] ERROR\nFailed to read " << sourcePath;
+                    return nullptr;
+                }
+                if (ReadCache(key, code) != VK_SUCCESS)
+                {
+#ifdef EASY_VK_SHADERC
+                    if (Compile(mask, code) != VK_SUCCESS) { return nullptr; }
+                    WriteCache(key, code);
+#else
+                    LOG(ERROR) << "[ shaderPermutations ] ERROR\nThe variant " << VariantName(mask)
+                               << " is neither embedded nor cached, and EASY_VK_SHADERC isn't defined!";
+                    return nullptr;
+#endif
+                }
+            }
+            iterator = variants.emplace(mask, std::move(code)).first;
+        }
+        return shaderModuleCache::Shared().Get(iterator->second.size() * 4, iterator->second.data());
+    }
+    const shaderModule* Get(std::initializer_list<std::string_view> enabledKeywords)
+    {
+        return Get(Mask(enabledKeywords));
+    }
+};
+
+}  // namespace easyVulkan
@@ -0,0 +1,81 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/*
+编译期嵌入的SPIR-V的登记表：
+构建时glslc编译shader/下的着色器源文件，spirv-opt做性能优化，EmbedSpirv.cmake再把结果写成constexpr的uint32_t数组，
+生成的EmbeddedShaders.cpp在静态初始化阶段把各数组以运行时的相对路径（如"shader/FirstTriangle.vert.spv"）登记于此。
+shaderModule::Create(filepath)先按规范化的路径查找登记表，找到时不读取文件；只有shader/下的路径会命中，
+其他目录中的同名文件仍从磁盘读取。
+
+这个头文件只依赖标准库，以便生成的源文件不必包含整个VKBase.h。
+*/
+
+namespace vulkan {
+
+/**
+ * @brief 嵌入的SPIR-V
+ */
+struct embeddedSpirv
+{
+    const uint32_t* pCode    = nullptr;
+    size_t          codeSize = 0;  // 以字节计
+
+    explicit operator bool() const { return pCode != nullptr; }
+};
+
+/**
+ * @brief 以相对路径为键的嵌入SPIR-V登记表
+ * @note 登记只在静态初始化阶段进行，之后只读，因而查找不加锁
+ */
+class shaderRegistry {
+    std::unordered_map<std::string_view, embeddedSpirv> entries;
+
+public:
+    // Getter
+    size_t Count() const { return entries.size(); }
+
+    // Const Function
+    /**
+     * @brief 按规范化的路径查找，"./shader/a.spv"与"shader\a.spv"都对应"shader/a.spv"
+     */
+    embeddedSpirv Find(std::string_view filepath) const
+    {
+        std::string name     = Normalize(filepath);
+        auto        iterator = entries.find(name);
+        return iterator == entries.end() ? embeddedSpirv{} : iterator->second;
+    }
+
+    // Non-const Function
+    /**
+     * @param name 须为字符串字面量或其他生命周期贯穿整个程序的字符串
+     */
+    void Register(std::string_view name, const uint32_t* pCode, size_t codeSize)
+    {
+        entries[name] = {pCode, codeSize};
+    }
+
+    // Static Function
+    /**
+     * @brief 分隔符统一为'/'，并去掉开头的"./"
+     */
+    static std::string Normalize(std::string_view filepath)
+    {
+        std::string name(filepath);
+        std::replace(name.begin(), name.end(), '\\', '/');
+        while (name.compare(0, 2, "./") == 0) { name.erase(0, 2); }
+        return name;
+    }
+    static shaderRegistry& Shared()
+    {
+        static shaderRegistry registry;
+        return registry;
+    }
+};
+
+}  // namespace vulkan
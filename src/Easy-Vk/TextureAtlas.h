@@ -0,0 +1,342 @@
+#pragma once
+#include "EasyVKStart.h"
+#include "MipmapGenerator.h"
+#include "VKBase+.h"
+#include "VKBase.h"
+
+/*
+把许多小图像装进一个2D纹理数组，使它们共用一个图像、一个图像视图和一个描述符：
+1. skylinePacker以天际线法在一层中为矩形找位置，优先放在最低处，其次选最窄的天际线段
+2. textureAtlas在CPU一侧逐张加入图像，所有已有的层都放不下时新开一层；
+   每张图像四周留出padding并以边缘像素填充，避免线性过滤和较低的mip等级混入相邻图像
+3. Upload()把所有层一次性上传为VK_IMAGE_VIEW_TYPE_2D_ARRAY的图像，
+   着色器以atlasRegion::uvRect把图像自身的UV映射到图集中，并以layer选择数组层
+
+打包只依赖CPU，既可以在导入资源时离线进行，也可以在运行时进行。
+*/
+
+namespace easyVulkan {
+
+/**
+ * @brief 天际线法矩形装箱
+ */
+class skylinePacker {
+    struct segment
+    {
+        uint32_t x;
+        uint32_t y;
+        uint32_t width;
+    };
+
+    std::vector<segment> skyline;  // 按x排列，覆盖整个宽度
+    uint32_t             width  = 0;
+    uint32_t             height = 0;
+
+    /**
+     * @return uint32_t 宽为w的矩形左端对齐第index段时的高度，放不下时返回UINT32_MAX
+     */
+    uint32_t Fit(size_t index, uint32_t w, uint32_t h) const
+    {
+        if (skyline[index].x + w > width) { return UINT32_MAX; }
+        uint32_t y         = 0;
+        uint32_t widthLeft = w;
+        for (size_t i = index; widthLeft > 0; i++)
+        {
+            y = std::max(y, skyline[i].y);
+            if (y + h > height) { return UINT32_MAX; }
+            widthLeft -= std::min(widthLeft, skyline[i].width);
+        }
+        return y;
+    }
+
+public:
+    skylinePacker() = default;
+    skylinePacker(uint32_t width, uint32_t height) { Reset(width, height); }
+
+    // Getter
+    uint32_t Width() const { return width; }
+    uint32_t Height() const { return height; }
+
+    // Non-const Function
+    void Reset(uint32_t width, uint32_t height)
+    {
+        this->width  = width;
+        this->height = height;
+        skyline      = {{0, 0, width}};
+    }
+    /**
+     * @brief 放置一个矩形
+     *
+     * @return bool 放不下时返回false
+     */
+    bool Insert(uint32_t w, uint32_t h, VkOffset2D& position)
+    {
+        size_t   bestIndex = SIZE_MAX;
+        uint32_t bestY     = UINT32_MAX;
+        uint32_t bestWidth = UINT32_MAX;
+        for (size_t i = 0; i < skyline.size(); i++)
+        {
+            uint32_t y = Fit(i, w, h);
+            if (y < bestY || (y == bestY && y != UINT32_MAX && skyline[i].width < bestWidth))
+            {
+                bestIndex = i;
+                bestY     = y;
+                bestWidth = skyline[i].width;
+            }
+        }
+        if (bestIndex == SIZE_MAX) { return false; }
+        position = {static_cast<int32_t>(skyline[bestIndex].x), static_cast<int32_t>(bestY)};
+
+        // 新的一段盖住其右侧的段，被完全盖住的段删除，部分盖住的段截短
+        skyline.insert(skyline.begin() + bestIndex, {skyline[bestIndex].x, bestY + h, w});
+        uint32_t right = skyline[bestIndex].x + w;
+        for (size_t i = bestIndex + 1; i < skyline.size();)
+        {
+            segment& current = skyline[i];
+            if (current.x >= right) { break; }
+            if (current.x + current.width <= right)
+            {
+                skyline.erase(skyline.begin() + i);
+                continue;
+            }
+            current.width -= right - current.x;
+            current.x = right;
+            break;
+        }
+        // 合并高度相同的相邻段
+        for (size_t i = 1; i < skyline.size();)
+        {
+            if (skyline[i - 1].y == skyline[i].y)
+            {
+                skyline[i - 1].width += skyline[i].width;
+                skyline.erase(skyline.begin() + i);
+            }
+            else { i++; }
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief 图像在图集中的位置
+ */
+struct atlasRegion
+{
+    glm::vec4  uvRect;  // (u0, v0, u1, v1)，不含padding
+    uint32_t   layer;
+    VkOffset2D offset;  // 层中的像素位置，不含padding
+    VkExtent2D extent;
+};
+
+/**
+ * @brief 打包成2D纹理数组的图集，像素格式为RGBA8
+ * @note 图集保留CPU一侧的像素，Upload()之后仍可继续加入图像并再次上传
+ */
+class textureAtlas {
+    VkExtent2D                        layerExtent;
+    uint32_t                          padding;
+    VkFormat                          format;
+    std::vector<skylinePacker>        packers;
+    std::vector<std::vector<uint8_t>> layers;
+    std::vector<atlasRegion>          regions;
+    vulkan::imageMemory               imageMemory;
+    vulkan::imageView                 imageView;
+    uint32_t                          mipLevelCount = 1;
+    mipmapGenerator                   mipmaps;  // 未调用Create()，只使用blit路径
+
+public:
+    /**
+     * @param padding 每张图像四周留出的像素数，也限制了mip等级数：第n级的padding为padding >> n，须至少为1
+     * @param format VK_FORMAT_R8G8B8A8_UNORM或VK_FORMAT_R8G8B8A8_SRGB
+     */
+    textureAtlas(VkExtent2D layerExtent = {2048, 2048},
+                 uint32_t   padding     = 4,
+                 VkFormat   format      = VK_FORMAT_R8G8B8A8_UNORM)
+        : layerExtent(layerExtent), padding(padding), format(format)
+    {
+    }
+
+    // Getter
+    VkImage                         Image() const { return imageMemory.Image(); }
+    VkImageView                     ImageView() const { return imageView; }
+    VkExtent2D                      LayerExtent() const { return layerExtent; }
+    uint32_t                        LayerCount() const { return static_cast<uint32_t>(layers.size()); }
+    uint32_t                        MipLevelCount() const { return mipLevelCount; }
+    const atlasRegion&              Region(uint32_t index) const { return regions[index]; }
+    const std::vector<atlasRegion>& Regions() const { return regions; }
+
+    // Const Function
+    VkDescriptorImageInfo DescriptorImageInfo(VkSampler sampler) const
+    {
+        return {sampler, imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    }
+
+    // Non-const Function
+    /**
+     * @brief 加入一张图像
+     *
+     * @param pPixels 紧密排列的RGBA8像素
+     * @return uint32_t 在Regions()中的下标，图像加上padding后大于一层时返回UINT32_MAX
+     */
+    uint32_t Add(const uint8_t* pPixels, VkExtent2D extent)
+    {
+        uint32_t paddedWidth  = extent.width + padding * 2;
+        uint32_t paddedHeight = extent.height + padding * 2;
+        if (extent.width == 0 || extent.height == 0 || paddedWidth > layerExtent.width ||
+            paddedHeight > layerExtent.height)
+        {
+            LOG(ERROR) << "[ textureAtlas ] ERROR\nThe image (" << extent.width << "x" << extent.height
+                       << ") doesn't fit in a layer!";
+            return UINT32_MAX;
+        }
+        VkOffset2D position = {};
+        uint32_t   layer    = 0;
+        while (layer < packers.size() && !packers[layer].Insert(paddedWidth, paddedHeight, position)) { layer++; }
+        if (layer == packers.size())
+        {
+            packers.emplace_back(layerExtent.width, layerExtent.height);
+            layers.emplace_back(size_t(layerExtent.width) * layerExtent.height * 4, uint8_t(0));
+            packers.back().Insert(paddedWidth, paddedHeight, position);
+        }
+
+        // 逐行复制，padding以最近的边缘像素填充
+        uint8_t* pLayer = layers[layer].data();
+        for (uint32_t row = 0; row < paddedHeight; row++)
+        {
+            int64_t        sourceRow    = std::clamp(int64_t(row) - padding, int64_t(0), int64_t(extent.height) - 1);
+            const uint8_t* pSource      = pPixels + size_t(sourceRow) * extent.width * 4;
+            uint8_t*       pDestination = pLayer + (size_t(position.y + row) * layerExtent.width + position.x) * 4;
+            for (uint32_t column = 0; column < padding; column++)
+            {
+                memcpy(pDestination + size_t(column) * 4, pSource, 4);
+                memcpy(pDestination + size_t(padding + extent.width + column) * 4,
+                       pSource + size_t(extent.width - 1) * 4, 4);
+            }
+            memcpy(pDestination + size_t(padding) * 4, pSource, size_t(extent.width) * 4);
+        }
+
+        VkOffset2D offset = {position.x + static_cast<int32_t>(padding), position.y + static_cast<int32_t>(padding)};
+        regions.push_back({
+            .uvRect = glm::vec4(float(offset.x) / layerExtent.width, float(offset.y) / layerExtent.height,
+                                float(offset.x + extent.width) / layerExtent.width,
+                                float(offset.y + extent.height) / layerExtent.height),
+            .layer  = layer,
+            .offset = offset,
+            .extent = extent,
+        });
+        return static_cast<uint32_t>(regions.size() - 1);
+    }
+    /**
+     * @brief 读取并加入一张图像文件
+     */
+    uint32_t Add(const char* filepath)
+    {
+        mappedFile file;
+        if (file.Open(filepath) != VK_SUCCESS) { return UINT32_MAX; }
+        int      width    = 0;
+        int      height   = 0;
+        int      channels = 0;
+        stbi_uc* pPixels  = stbi_load_from_memory(file.Data(), static_cast<int>(file.Size()), &width, &height,
+                                                  &channels, STBI_rgb_alpha);
+        if (pPixels == nullptr)
+        {
+            LOG(ERROR) << "[ textureAtlas ] ERROR\nFailed to decode the image: " << filepath << "\n"
+                       << stbi_failure_reason();
+            return UINT32_MAX;
+        }
+        uint32_t index = Add(pPixels, {static_cast<uint32_t>(width), static_cast<uint32_t>(height)});
+        stbi_image_free(pPixels);
+        return index;
+    }
+    /**
+     * @brief 把所有层上传为一个纹理数组，等待上传完成后返回
+     * @note 再次上传会重新创建图像，须确保旧图像已不再被GPU使用，且须重新写入描述符
+     *
+     * @param generateMipmaps 为true且格式支持线性blit时生成mipmap，等级数受padding限制
+     */
+    result_t Upload(bool generateMipmaps = true)
+    {
+        if (layers.empty())
+        {
+            LOG(ERROR) << "[ textureAtlas ] ERROR\nThe atlas is empty!";
+            return VK_RESULT_MAX_ENUM;
+        }
+        imageView.~imageView();
+        imageMemory.~imageMemory();
+
+        uint32_t layerCount = LayerCount();
+        mipLevelCount       = 1;
+        if (generateMipmaps && padding != 0)
+        {
+            mipLevelCount = std::min(mipmaps.MipLevelCount(format, layerExtent),
+                                     static_cast<uint32_t>(std::floor(std::log2(padding))) + 1);
+        }
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        if (mipLevelCount > 1) { usage |= mipmaps.ImageUsage(format); }
+        VkImageCreateInfo imageCreateInfo = {
+            .imageType   = VK_IMAGE_TYPE_2D,
+            .format      = format,
+            .extent      = {layerExtent.width, layerExtent.height, 1},
+            .mipLevels   = mipLevelCount,
+            .arrayLayers = layerCount,
+            .samples     = VK_SAMPLE_COUNT_1_BIT,
+            .tiling      = VK_IMAGE_TILING_OPTIMAL,
+            .usage       = usage,
+        };
+        if (result_t result = imageMemory.Create(imageCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+        {
+            return result;
+        }
+        if (result_t result = imageView.Create(imageMemory.Image(), VK_IMAGE_VIEW_TYPE_2D_ARRAY, format,
+                                               {VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevelCount, 0, layerCount}))
+        {
+            return result;
+        }
+
+        // 各层在暂存缓冲区中依次排列，一次复制全部
+        size_t layerSize = layers[0].size();
+        auto*  pStaging  = static_cast<uint8_t*>(stagingBuffer::MainThread().MapMemory(layerSize * layerCount));
+        for (uint32_t i = 0; i < layerCount; i++) { memcpy(pStaging + layerSize * i, layers[i].data(), layerSize); }
+        stagingBuffer::MainThread().UnmapMemory();
+
+        const auto&          commandBuffer = graphicsBasePlus::Plus().CommandBuffer_Transfer();
+        VkImageMemoryBarrier barrier       = {
+            .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask       = 0,
+            .dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image               = imageMemory.Image(),
+            .subresourceRange    = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, layerCount},
+        };
+        VkBufferImageCopy region = {
+            .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, layerCount},
+            .imageExtent      = {layerExtent.width, layerExtent.height, 1},
+        };
+        std::vector<mipmapGenerator::target> targets(layerCount);
+        for (uint32_t i = 0; i < layerCount; i++)
+        {
+            targets[i] = {imageMemory.Image(), format, layerExtent, mipLevelCount, i};
+        }
+        mipmapGenerator::scratch scratch;
+        commandBuffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+                             nullptr, 0, nullptr, 1, &barrier);
+        vkCmdCopyBufferToImage(commandBuffer, stagingBuffer::MainThread(), imageMemory.Image(),
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+        // 各层的mipmap在同一次调用中生成，共用屏障
+        if (result_t result = mipmaps.CmdGenerate(commandBuffer, {targets.data(), targets.size()}, scratch,
+                                                  VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                                                      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT))
+        {
+            commandBuffer.End();
+            return result;
+        }
+        commandBuffer.End();
+        return graphicsBasePlus::Plus().ExecuteCommandBuffer_Graphics(commandBuffer);
+    }
+};
+
+}  // namespace easyVulkan
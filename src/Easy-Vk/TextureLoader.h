@@ -0,0 +1,586 @@
+#pragma once
+#include "EasyVKStart.h"
+#include "MipmapGenerator.h"
+#include "ThreadPool.h"
+#include "VKBase+.h"
+#include "VKBase.h"
+
+#include <ktx.h>
+
+#include <atomic>
+#include <deque>
+
+/*
+异步纹理加载的流程：
+1. Load(...)立即返回纹理的句柄，解码任务被投递到线程池
+2. 工作线程映射图像文件并解码，再从暂存区中分配一段内存，把像素写进去：
+   KTX2文件的各mip等级原样写入，Basis Universal编码的则先转码为设备支持的块压缩格式；其他格式用stb_image解码为RGBA8。
+   暂存区已满时工作线程不等待（线程池是共享的，等待会占住其他任务的线程），像素先留在内存中，由Update(...)写入暂存区
+3. 主线程每帧调用Update(...)，把已解码的纹理的复制命令和生成mipmap的命令记录进同一个命令缓冲区，提交到图形队列
+4. 之后某次Update(...)发现该批次的栅栏已置位，回收暂存内存，纹理的状态变为ready
+
+Vulkan的队列须外部同步，因此提交只发生在调用Update(...)的线程上，工作线程只做解码和写入映射的内存。
+*/
+
+using namespace vulkan;
+
+namespace easyVulkan {
+
+/**
+ * @brief 可被多个线程同时分配和写入的暂存内存
+ * @note 整块内存为host coherent且持久映射，写入后不需要刷新。以首次适配法在空闲块表中分配，
+ * 空间不足时Allocate(...)立即失败，不会阻塞。
+ */
+class stagingArena {
+    vulkan::bufferMemory                 bufferMemory;
+    uint8_t*                             pMapped  = nullptr;
+    VkDeviceSize                         capacity = 0;
+    std::map<VkDeviceSize, VkDeviceSize> freeBlocks;  // 起始位置 -> 大小，相邻的空闲块总是被合并
+    std::mutex                           mutex;
+
+public:
+    static constexpr VkDeviceSize alignment = 16;  // 满足vkCmdCopyBufferToImage(...)对bufferOffset的对齐要求
+
+    struct region
+    {
+        VkDeviceSize offset = 0;
+        VkDeviceSize size   = 0;
+    };
+
+    stagingArena() = default;
+    stagingArena(VkDeviceSize size) { Create(size); }
+    stagingArena(const stagingArena&)            = delete;
+    stagingArena& operator=(const stagingArena&) = delete;
+    ~stagingArena()
+    {
+        if (pMapped != nullptr) { bufferMemory.UnmapMemory(capacity); }
+    }
+
+    // Getter
+    VkBuffer     Buffer() const { return bufferMemory.Buffer(); }
+    VkDeviceSize Capacity() const { return capacity; }
+    uint8_t*     Pointer(const region& allocated) const { return pMapped + allocated.offset; }
+
+    // Non-const Function
+    result_t Create(VkDeviceSize size)
+    {
+        VkBufferCreateInfo bufferCreateInfo = {
+            .size  = size,
+            .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        };
+        if (result_t result = bufferMemory.Create(
+                bufferCreateInfo, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+        {
+            return result;
+        }
+        void* pData = nullptr;
+        if (result_t result = bufferMemory.MapMemory(pData, size)) { return result; }
+        pMapped    = static_cast<uint8_t*>(pData);
+        capacity   = size;
+        freeBlocks = {{0, size}};
+        return VK_SUCCESS;
+    }
+    /**
+     * @brief 分配一段暂存内存
+     *
+     * @return bool 当前没有足够大的空闲块时返回false，size超过总容量时永远返回false
+     */
+    bool Allocate(VkDeviceSize size, region& allocated)
+    {
+        size = AlignedSize(size);
+        if (size > capacity) { return false; }
+        std::lock_guard lock(mutex);
+        for (auto i = freeBlocks.begin(); i != freeBlocks.end(); ++i)
+        {
+            if (i->second < size) { continue; }
+            allocated = {i->first, size};
+            if (i->second > size) { freeBlocks[i->first + size] = i->second - size; }
+            freeBlocks.erase(i);
+            return true;
+        }
+        return false;
+    }
+    void Free(const region& allocated)
+    {
+        std::lock_guard lock(mutex);
+        auto            i    = freeBlocks.emplace(allocated.offset, allocated.size).first;
+        auto            next = std::next(i);
+        if (next != freeBlocks.end() && i->first + i->second == next->first)
+        {
+            i->second += next->second;
+            freeBlocks.erase(next);
+        }
+        if (i != freeBlocks.begin())
+        {
+            auto previous = std::prev(i);
+            if (previous->first + previous->second == i->first)
+            {
+                previous->second += i->second;
+                freeBlocks.erase(i);
+            }
+        }
+    }
+
+    // Static Function
+    /**
+     * @brief 大小为size的数据在暂存区中实际占用的大小
+     */
+    static VkDeviceSize AlignedSize(VkDeviceSize size) { return (size + alignment - 1) / alignment * alignment; }
+};
+
+enum class textureState : uint32_t {
+    decoding,   // 正在工作线程中解码
+    decoded,    // 已解码，等待提交
+    uploading,  // 复制命令已提交，GPU尚未执行完
+    ready,      // 可以使用
+    failed,
+};
+
+/**
+ * @brief 格式能否用作以线性过滤采样的最优平铺图像
+ */
+inline bool FormatSupportsSampling(VkFormat format)
+{
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(GraphicsBase::Base().PhysicalDevice(), format, &formatProperties);
+    constexpr VkFormatFeatureFlags features =
+        VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    return (formatProperties.optimalTilingFeatures & features) == features;
+}
+
+/**
+ * @brief 按压缩率和质量的优先次序，选出设备支持的Basis Universal转码目标格式
+ * @note 都不支持时（如部分软件实现）退回到未压缩的RGBA8
+ */
+inline ktx_transcode_fmt_e SelectKtxTranscodeFormat()
+{
+    static constexpr std::pair<ktx_transcode_fmt_e, VkFormat> candidates[] = {
+        {KTX_TTF_BC7_RGBA, VK_FORMAT_BC7_UNORM_BLOCK},
+        {KTX_TTF_ASTC_4x4_RGBA, VK_FORMAT_ASTC_4x4_UNORM_BLOCK},
+        {KTX_TTF_ETC2_RGBA, VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK},
+        {KTX_TTF_BC3_RGBA, VK_FORMAT_BC3_UNORM_BLOCK},
+    };
+    for (auto& [transcodeFormat, format] : candidates)
+    {
+        if (FormatSupportsSampling(format)) { return transcodeFormat; }
+    }
+    return KTX_TTF_RGBA32;
+}
+
+/**
+ * @brief 异步加载的二维纹理，由textureLoader创建和填充
+ * @note 状态为ready之前，除State()和Filepath()以外的函数都不应被调用
+ */
+class asyncTexture {
+    friend class textureLoader;
+    vulkan::imageMemory       imageMemory;
+    vulkan::imageView         imageView;
+    std::string               filepath;
+    VkFormat                  format             = VK_FORMAT_UNDEFINED;
+    VkExtent2D                extent             = {};
+    uint32_t                  mipLevelCount      = 1;
+    uint32_t                  uploadedLevelCount = 1;  // 从文件上传的mip等级数，其余等级在GPU上生成
+    bool                      generateMipmaps    = true;
+    std::atomic<textureState> state              = textureState::decoding;
+    // 解码得到的像素所在的暂存内存，图像大于暂存区的总容量时单独创建暂存缓冲区
+    stagingArena::region           stagingRegion;
+    vulkan::bufferMemory           dedicatedStaging;
+    std::vector<uint8_t>           unstagedData;  // 解码时暂存区已满，像素暂留于此，由主线程写入暂存区
+    std::vector<VkBufferImageCopy> copyRegions;  // bufferOffset相对于暂存内存的起始位置
+
+public:
+    // Getter
+    textureState       State() const { return state.load(std::memory_order_acquire); }
+    bool               IsReady() const { return State() == textureState::ready; }
+    const std::string& Filepath() const { return filepath; }
+    VkImage            Image() const { return imageMemory.Image(); }
+    VkImageView        ImageView() const { return imageView; }
+    VkFormat           Format() const { return format; }
+    VkExtent2D         Extent() const { return extent; }
+    uint32_t           MipLevelCount() const { return mipLevelCount; }
+
+    // Const Function
+    VkDescriptorImageInfo DescriptorImageInfo(VkSampler sampler) const
+    {
+        return {sampler, imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    }
+};
+
+/**
+ * @brief 在线程池中并行解码纹理，并分批上传到GPU
+ */
+class textureLoader {
+    struct uploadBatch
+    {
+        vulkan::commandBuffer                      commandBuffer;
+        vulkan::fence                              fence;
+        std::vector<std::shared_ptr<asyncTexture>> textures;
+        mipmapGenerator::scratch                   mipmapScratch;
+    };
+
+    threadPool&                                pool;
+    stagingArena                               arena;
+    commandPool                                commandPool_upload;
+    mipmapGenerator                            mipmaps;
+    std::mutex                                 mutex;
+    std::vector<std::shared_ptr<asyncTexture>> decodedTextures;   // 已解码、等待提交的纹理
+    std::deque<uploadBatch>                    uploadBatches;     // 已提交、GPU尚未执行完的批次
+    std::deque<std::shared_ptr<asyncTexture>>  unstagedTextures;  // 已解码、等待写入暂存区的纹理，只在主线程中访问
+    taskCounter                                decodingTasks;
+    ktx_transcode_fmt_e                        transcodeFormat;
+
+    static bool IsKtx2(const mappedFile& file)
+    {
+        static constexpr uint8_t identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+        return file.Size() >= sizeof identifier && memcmp(file.Data(), identifier, sizeof identifier) == 0;
+    }
+    /**
+     * @brief 从暂存区分配内存并写入数据，大于暂存区总容量的数据写入单独创建的缓冲区
+     * @note 暂存区已满时复制一份数据留待WriteUnstaged(...)写入，不在工作线程中等待
+     */
+    bool WriteStaging(asyncTexture& texture, const void* pData, VkDeviceSize size)
+    {
+        // 须以对齐后的大小比较，否则对齐前恰好放得下的数据永远分配不到
+        if (stagingArena::AlignedSize(size) <= arena.Capacity())
+        {
+            if (arena.Allocate(size, texture.stagingRegion))
+            {
+                memcpy(arena.Pointer(texture.stagingRegion), pData, static_cast<size_t>(size));
+            }
+            else
+            {
+                const auto* pBytes = static_cast<const uint8_t*>(pData);
+                texture.unstagedData.assign(pBytes, pBytes + size);
+            }
+            return true;
+        }
+        VkBufferCreateInfo bufferCreateInfo = {
+            .size  = size,
+            .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        };
+        return texture.dedicatedStaging.Create(bufferCreateInfo, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) == VK_SUCCESS &&
+               texture.dedicatedStaging.BufferData(pData, size) == VK_SUCCESS;
+    }
+    bool DecodeImage(asyncTexture& texture, const mappedFile& file)
+    {
+        int      width    = 0;
+        int      height   = 0;
+        int      channels = 0;
+        stbi_uc* pPixels  = stbi_load_from_memory(file.Data(), static_cast<int>(file.Size()), &width, &height,
+                                                  &channels, STBI_rgb_alpha);
+        if (pPixels == nullptr)
+        {
+            LOG(ERROR) << "[ textureLoader ] ERROR\nFailed to decode the image: " << texture.filepath << "\n"
+                       << stbi_failure_reason();
+            return false;
+        }
+        texture.extent      = {static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
+        texture.copyRegions = {{
+            .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+            .imageExtent      = {texture.extent.width, texture.extent.height, 1},
+        }};
+        bool written = WriteStaging(texture, pPixels, VkDeviceSize(width) * height * 4);
+        stbi_image_free(pPixels);
+        return written;
+    }
+    bool DecodeKtx2(asyncTexture& texture, const mappedFile& file)
+    {
+        ktxTexture2*     pKtxTexture2 = nullptr;
+        ktx_error_code_e error        = ktxTexture2_CreateFromMemory(
+            file.Data(), file.Size(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &pKtxTexture2);
+        if (error != KTX_SUCCESS)
+        {
+            LOG(ERROR) << "[ textureLoader ] ERROR\nFailed to read the KTX2 file: " << texture.filepath << "\n"
+                       << ktxErrorString(error);
+            return false;
+        }
+        ktxTexture* pKtxTexture = ktxTexture(pKtxTexture2);
+        bool        succeeded   = false;
+        if (ktxTexture2_NeedsTranscoding(pKtxTexture2))
+        {
+            error = ktxTexture2_TranscodeBasis(pKtxTexture2, transcodeFormat, 0);  // 转码后vkFormat随之更新
+        }
+        if (error != KTX_SUCCESS)
+        {
+            LOG(ERROR) << "[ textureLoader ] ERROR\nFailed to transcode the KTX2 file: " << texture.filepath << "\n"
+                       << ktxErrorString(error);
+        }
+        else if (pKtxTexture->numDimensions != 2 || pKtxTexture->numFaces != 1 || pKtxTexture->isArray)
+        {
+            LOG(ERROR) << "[ textureLoader ] ERROR\nOnly 2D KTX2 textures are supported: " << texture.filepath;
+        }
+        else if (!FormatSupportsSampling(static_cast<VkFormat>(pKtxTexture2->vkFormat)))
+        {
+            LOG(ERROR) << "[ textureLoader ] ERROR\nThe format of the KTX2 file isn't supported by the device: "
+                       << texture.filepath << "\nVkFormat: " << pKtxTexture2->vkFormat;
+        }
+        else
+        {
+            texture.format             = static_cast<VkFormat>(pKtxTexture2->vkFormat);
+            texture.extent             = {pKtxTexture->baseWidth, pKtxTexture->baseHeight};
+            texture.uploadedLevelCount = pKtxTexture->numLevels;
+            texture.generateMipmaps    = texture.generateMipmaps && pKtxTexture->numLevels == 1;
+            texture.copyRegions.resize(pKtxTexture->numLevels);
+            for (uint32_t level = 0; level < pKtxTexture->numLevels; level++)
+            {
+                ktx_size_t offset = 0;
+                ktxTexture_GetImageOffset(pKtxTexture, level, 0, 0, &offset);
+                texture.copyRegions[level] = {
+                    .bufferOffset     = offset,
+                    .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1},
+                    .imageExtent      = {std::max(1U, texture.extent.width >> level),
+                                         std::max(1U, texture.extent.height >> level), 1},
+                };
+            }
+            succeeded = WriteStaging(texture, ktxTexture_GetData(pKtxTexture), ktxTexture_GetDataSize(pKtxTexture));
+        }
+        ktxTexture_Destroy(pKtxTexture);
+        return succeeded;
+    }
+    /**
+     * @brief 在工作线程中执行：解码图像并写入暂存内存
+     */
+    void Decode(const std::shared_ptr<asyncTexture>& pTexture)
+    {
+        asyncTexture& texture = *pTexture;
+        bool          decoded = false;
+        {
+            mappedFile file;
+            if (file.Open(texture.filepath.c_str()) == VK_SUCCESS)
+            {
+                decoded = IsKtx2(file) ? DecodeKtx2(texture, file) : DecodeImage(texture, file);
+            }
+        }
+        if (decoded)
+        {
+            std::lock_guard lock(mutex);
+            decodedTextures.push_back(pTexture);
+            texture.state.store(textureState::decoded, std::memory_order_release);
+        }
+        else { texture.state.store(textureState::failed, std::memory_order_release); }
+    }
+    /**
+     * @brief 在主线程中执行：把解码时未能写入暂存区的数据写入暂存区
+     *
+     * @return bool 暂存区仍没有足够的空间时返回false
+     */
+    bool WriteUnstaged(asyncTexture& texture)
+    {
+        if (!arena.Allocate(texture.unstagedData.size(), texture.stagingRegion)) { return false; }
+        memcpy(arena.Pointer(texture.stagingRegion), texture.unstagedData.data(), texture.unstagedData.size());
+        std::vector<uint8_t>().swap(texture.unstagedData);
+        return true;
+    }
+    void ReleaseStaging(asyncTexture& texture)
+    {
+        if (texture.dedicatedStaging.AllocationSize() != 0U) { texture.dedicatedStaging.~bufferMemory(); }
+        else { arena.Free(texture.stagingRegion); }
+    }
+
+public:
+    /**
+     * @param stagingCapacity 暂存区的总容量，决定了同时处于已解码、未上传完毕状态的纹理的总大小
+     */
+    textureLoader(VkDeviceSize stagingCapacity = 64 << 20, threadPool& pool = threadPool::Shared())
+        : pool(pool),
+          arena(stagingCapacity),
+          commandPool_upload(GraphicsBase::Base().QueueFamilyIndex_Graphics(),
+                             VK_COMMAND_POOL_CREATE_TRANSIENT_BIT),
+          transcodeFormat(SelectKtxTranscodeFormat())
+    {
+        if (result_t result = mipmaps.Create())
+        {
+            LOG(WARNING) << "[ textureLoader ] WARNING\n"
+                         << "Mipmaps will only be generated for formats that support linear blit.";
+        }
+    }
+    textureLoader(const textureLoader&)            = delete;
+    textureLoader& operator=(const textureLoader&) = delete;
+    ~textureLoader() { WaitIdle(); }
+
+    // Getter
+    ktx_transcode_fmt_e TranscodeFormat() const { return transcodeFormat; }
+
+    // Non-const Function
+    /**
+     * @brief 开始异步加载纹理
+     * @note KTX2文件的格式和mip等级由文件决定，其他图像被转换为RGBA8
+     *
+     * @param format VK_FORMAT_R8G8B8A8_UNORM或VK_FORMAT_R8G8B8A8_SRGB，颜色贴图一般用后者，对KTX2文件无效
+     * @param generateMipmaps 文件中只有一级时，在GPU上生成完整的mip链，采样器的maxLod应不小于MipLevelCount() - 1
+     */
+    std::shared_ptr<asyncTexture> Load(const char* filepath,
+                                       VkFormat    format          = VK_FORMAT_R8G8B8A8_UNORM,
+                                       bool        generateMipmaps = true)
+    {
+        auto pTexture             = std::make_shared<asyncTexture>();
+        pTexture->filepath        = filepath;
+        pTexture->format          = format;
+        pTexture->generateMipmaps = generateMipmaps;
+        pool.Submit([this, pTexture] { Decode(pTexture); }, decodingTasks);
+        return pTexture;
+    }
+    /**
+     * @brief 回收执行完毕的批次，并把新解码的纹理作为一个批次提交，应在主线程中每帧调用
+     *
+     * @return uint32_t 本次变为ready的纹理数
+     */
+    uint32_t Update()
+    {
+        // 同一队列上的批次按提交顺序执行完毕，只需检查最早的批次
+        uint32_t readyCount = 0;
+        while (!uploadBatches.empty() && uploadBatches.front().fence.Status() == VK_SUCCESS)
+        {
+            auto& batch = uploadBatches.front();
+            for (auto& i : batch.textures)
+            {
+                ReleaseStaging(*i);
+                i->state.store(textureState::ready, std::memory_order_release);
+                readyCount++;
+            }
+            commandPool_upload.FreeBuffers(batch.commandBuffer);
+            uploadBatches.pop_front();
+        }
+
+        std::vector<std::shared_ptr<asyncTexture>> textures;
+        {
+            std::lock_guard lock(mutex);
+            for (auto& i : decodedTextures)
+            {
+                if (i->unstagedData.empty()) { textures.push_back(std::move(i)); }
+                else { unstagedTextures.push_back(std::move(i)); }
+            }
+            decodedTextures.clear();
+        }
+        // 上面回收了暂存内存，按解码的顺序写入等待中的纹理，直到空间不足
+        while (!unstagedTextures.empty())
+        {
+            std::shared_ptr<asyncTexture>& pTexture = unstagedTextures.front();
+            // 比整个暂存区还大的纹理永远写不进去，若不剔除，WaitIdle()会一直等下去
+            if (stagingArena::AlignedSize(pTexture->unstagedData.size()) > arena.Capacity())
+            {
+                LOG(ERROR) << "[ textureLoader ] ERROR\nThe texture is larger than the staging arena!\nSize: "
+                           << pTexture->unstagedData.size() << ", capacity: " << arena.Capacity();
+                std::vector<uint8_t>().swap(pTexture->unstagedData);
+                pTexture->state.store(textureState::failed, std::memory_order_release);
+            }
+            else if (WriteUnstaged(*pTexture)) { textures.push_back(std::move(pTexture)); }
+            else { break; }
+            unstagedTextures.pop_front();
+        }
+        if (textures.empty()) { return readyCount; }
+
+        // 先创建所有图像，再以一次屏障转换全部上传等级的布局、逐个复制，最后生成mipmap并转换为着色器只读
+        uploadBatch                          batch;
+        std::vector<VkImageMemoryBarrier>    barriers;
+        std::vector<VkImageMemoryBarrier>    barriers_complete;  // 文件中已包含全部mip等级的纹理
+        std::vector<mipmapGenerator::target> mipmapTargets;
+        for (auto& i : textures)
+        {
+            if (i->uploadedLevelCount > 1) { i->mipLevelCount = i->uploadedLevelCount; }
+            else { i->mipLevelCount = i->generateMipmaps ? mipmaps.MipLevelCount(i->format, i->extent) : 1; }
+            VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+            if (i->mipLevelCount > 1) { usage |= mipmaps.ImageUsage(i->format); }
+            VkImageCreateInfo imageCreateInfo = {
+                .imageType   = VK_IMAGE_TYPE_2D,
+                .format      = i->format,
+                .extent      = {i->extent.width, i->extent.height, 1},
+                .mipLevels   = i->mipLevelCount,
+                .arrayLayers = 1,
+                .samples     = VK_SAMPLE_COUNT_1_BIT,
+                .tiling      = VK_IMAGE_TILING_OPTIMAL,
+                .usage       = usage,
+            };
+            VkImageSubresourceRange subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, i->mipLevelCount, 0, 1};
+            if (i->imageMemory.Create(imageCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != VK_SUCCESS ||
+                i->imageView.Create(i->imageMemory.Image(), VK_IMAGE_VIEW_TYPE_2D, i->format, subresourceRange) !=
+                    VK_SUCCESS)
+            {
+                ReleaseStaging(*i);
+                i->state.store(textureState::failed, std::memory_order_release);
+                continue;
+            }
+            barriers.push_back({
+                .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                .srcAccessMask       = 0,
+                .dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
+                .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image               = i->imageMemory.Image(),
+                .subresourceRange    = {VK_IMAGE_ASPECT_COLOR_BIT, 0, i->uploadedLevelCount, 0, 1},
+            });
+            if (i->uploadedLevelCount > 1)
+            {
+                VkImageMemoryBarrier& barrier = barriers_complete.emplace_back(barriers.back());
+                barrier.srcAccessMask         = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask         = VK_ACCESS_SHADER_READ_BIT;
+                barrier.oldLayout             = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                barrier.newLayout             = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            }
+            else { mipmapTargets.push_back({i->imageMemory.Image(), i->format, i->extent, i->mipLevelCount}); }
+            batch.textures.push_back(i);
+        }
+        if (batch.textures.empty()) { return readyCount; }
+
+        commandPool_upload.AllocateBuffers(batch.commandBuffer);
+        batch.commandBuffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                             0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+        for (auto& i : batch.textures)
+        {
+            bool dedicated = i->dedicatedStaging.AllocationSize() != 0U;
+            if (!dedicated)
+            {
+                for (auto& region : i->copyRegions) { region.bufferOffset += i->stagingRegion.offset; }
+            }
+            vkCmdCopyBufferToImage(batch.commandBuffer, dedicated ? i->dedicatedStaging.Buffer() : arena.Buffer(),
+                                   i->imageMemory.Image(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                   static_cast<uint32_t>(i->copyRegions.size()), i->copyRegions.data());
+            i->state.store(textureState::uploading, std::memory_order_release);
+        }
+        if (!barriers_complete.empty())
+        {
+            vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers_complete.size()),
+                                 barriers_complete.data());
+        }
+        if (result_t result = mipmaps.CmdGenerate(batch.commandBuffer, {mipmapTargets.data(), mipmapTargets.size()},
+                                                  batch.mipmapScratch,
+                                                  VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                                                      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT))
+        {
+            batch.commandBuffer.End();
+            commandPool_upload.FreeBuffers(batch.commandBuffer);
+            for (auto& i : batch.textures)
+            {
+                ReleaseStaging(*i);
+                i->state.store(textureState::failed, std::memory_order_release);
+            }
+            return readyCount;
+        }
+        batch.commandBuffer.End();
+        GraphicsBase::Base().SubmitCommandBuffer_Graphics(batch.commandBuffer, batch.fence);
+        uploadBatches.push_back(std::move(batch));
+        return readyCount;
+    }
+    /**
+     * @brief 等待所有已发起的加载完成（成功或失败）
+     */
+    void WaitIdle()
+    {
+        decodingTasks.Wait();  // 解码任务不等待暂存区，总会执行完
+        while (true)
+        {
+            Update();
+            if (!uploadBatches.empty()) { uploadBatches.back().fence.Wait(); }
+            else if (unstagedTextures.empty()) { return; }
+        }
+    }
+};
+
+}  // namespace easyVulkan
@@ -0,0 +1,690 @@
+#pragma once
+#include "EasyVKStart.h"
+#include "TextureLoader.h"
+#include "ThreadPool.h"
+#include "VKBase.h"
+
+/*
+纹理流送：
+1. Add(...)加入的纹理起初只驻留边长不超过minResidentSize的低精度mip等级，这些等级此后始终驻留
+2. 每帧对使用纹理的每个材质调用Request(...)，传入纹理在屏幕上覆盖的像素数，所有请求中最大者决定所需的mip等级
+3. Update(...)比较所需等级与驻留等级：需要更精细的等级时，工作线程读取文件并转码，之后某次Update(...)提交上传；
+   驻留总量超出预算时，最久未被请求、驻留精度高于所需的纹理先被降级
+4. 驻留等级改变时，纹理的图像被替换（旧图像中仍需要的等级以vkCmdCopyImage(...)复制到新图像），Version()随之递增，
+   须在记录下一帧的命令前重新写入引用该纹理的描述符
+
+预算取textureStreamerOptions::budget，开启了VK_EXT_memory_budget时，还不超过设备本地堆的预算减去其他对象的用量。
+驻留量按文件中各等级的数据量估算，不计入对齐的开销。
+
+只支持带完整mip链的2D KTX2文件（可以是Basis Universal编码的），其他文件加载失败。
+*/
+
+namespace easyVulkan {
+
+struct textureStreamerOptions
+{
+    VkDeviceSize budget             = VkDeviceSize(512) << 20;  // 所有流送纹理的驻留总量的上限
+    VkDeviceSize stagingCapacity    = VkDeviceSize(64) << 20;
+    uint32_t     minResidentSize    = 64;   // 始终驻留的等级的最大边长
+    uint32_t     maxConcurrentLoads = 4;    // 同时在工作线程中读取的纹理数
+    uint32_t     evictionDelay      = 120;  // 连续这么多帧未被请求的纹理，所需等级回落到始终驻留的等级
+};
+
+enum class streamState : uint32_t {
+    idle,
+    loading,       // 正在工作线程中读取和转码，或读取失败、等待主线程处理
+    decoded,       // 新的等级已读取，等待提交
+    transferring,  // 驻留等级的变更已提交，GPU尚未执行完
+    failed,
+};
+
+/**
+ * @brief 流送的纹理，由textureStreamer创建和管理
+ * @note 元数据在首次读取完成后才有效，IsResident()为false时不应使用图像和图像视图
+ */
+class streamedTexture {
+    friend class textureStreamer;
+    // 当前驻留的图像，其第0级对应文件中的第residentLevel级
+    struct residentImage
+    {
+        vulkan::imageMemory imageMemory;
+        vulkan::imageView   imageView;
+    };
+
+    std::unique_ptr<residentImage> pResident;
+    std::string                    filepath;
+    VkFormat                       format        = VK_FORMAT_UNDEFINED;
+    VkExtent2D                     extent        = {};  // 文件中第0级的尺寸
+    uint32_t                       mipLevelCount = 0;
+    uint32_t                       baseLevel     = 0;   // 始终驻留的等级中最精细的一级
+    uint32_t                       residentLevel = 0;   // 驻留的等级中最精细的一级，未驻留时为mipLevelCount
+    uint32_t                       version       = 0;
+    std::vector<VkDeviceSize>      levelSizes;
+    std::atomic<streamState>       state = streamState::loading;
+    // 流送的需求，只在主线程中访问
+    float    requestedSize    = 0.F;
+    uint64_t lastRequestFrame = 0;
+    // 正在加载的等级范围[loadFirstLevel, loadEndLevel)
+    uint32_t                       loadFirstLevel = 0;
+    uint32_t                       loadEndLevel   = 0;
+    VkDeviceSize                   loadSize       = 0;
+    stagingArena::region           stagingRegion;
+    vulkan::bufferMemory           dedicatedStaging;
+    std::vector<uint8_t>           unstagedData;  // 读取时暂存区已满，数据暂留于此，由主线程写入暂存区
+    std::vector<VkBufferImageCopy> copyRegions;   // bufferOffset相对于暂存内存的起始位置，mipLevel相对于loadFirstLevel
+
+    VkDeviceSize ResidentSize(uint32_t firstLevel) const
+    {
+        return std::accumulate(levelSizes.begin() + firstLevel, levelSizes.end(), VkDeviceSize(0));
+    }
+
+public:
+    // Getter
+    streamState        State() const { return state.load(std::memory_order_acquire); }
+    bool               IsResident() const { return pResident != nullptr; }
+    const std::string& Filepath() const { return filepath; }
+    VkImage            Image() const { return pResident ? pResident->imageMemory.Image() : VK_NULL_HANDLE; }
+    VkImageView        ImageView() const { return pResident ? VkImageView(pResident->imageView) : VK_NULL_HANDLE; }
+    VkFormat           Format() const { return format; }
+    VkExtent2D         Extent() const { return extent; }
+    uint32_t           MipLevelCount() const { return mipLevelCount; }
+    uint32_t           ResidentLevel() const { return residentLevel; }
+    uint32_t           Version() const { return version; }
+
+    // Const Function
+    VkDescriptorImageInfo DescriptorImageInfo(VkSampler sampler) const
+    {
+        return {sampler, ImageView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    }
+};
+
+/**
+ * @brief 在显存预算内，按屏幕上的需求流送纹理的mip等级
+ */
+class textureStreamer {
+    struct transferBatch
+    {
+        vulkan::commandBuffer                                        commandBuffer;
+        vulkan::fence                                                fence;
+        std::vector<std::shared_ptr<streamedTexture>>                textures;
+        std::vector<std::unique_ptr<streamedTexture::residentImage>> retiredImages;
+        VkDeviceSize                                                 retiredSize = 0;
+    };
+    // 一次驻留等级的变更
+    struct residencyChange
+    {
+        std::shared_ptr<streamedTexture> pTexture;
+        uint32_t                         newLevel;
+    };
+
+    textureStreamerOptions                        options;
+    threadPool&                                   pool;
+    stagingArena                                  arena;
+    commandPool                                   commandPool_transfer;
+    ktx_transcode_fmt_e                           transcodeFormat;
+    std::vector<std::shared_ptr<streamedTexture>> textures;
+    std::mutex                                    mutex;
+    std::vector<std::shared_ptr<streamedTexture>> decodedTextures;
+    std::vector<std::shared_ptr<streamedTexture>> failedTextures;    // 读取失败、尚未从loadingSize中扣除的纹理
+    std::deque<std::shared_ptr<streamedTexture>>  unstagedTextures;  // 等待写入暂存区的纹理，只在主线程中访问
+    std::deque<transferBatch>                     transferBatches;
+    taskCounter                                   loadingTasks;
+    uint64_t                                      frame        = 0;
+    VkDeviceSize                                  residentSize = 0;  // 所有纹理当前图像的驻留量之和
+    VkDeviceSize                                  retiredSize  = 0;  // 已被替换、等待GPU执行完毕后销毁的图像
+    VkDeviceSize                                  loadingSize  = 0;  // 正在加载的等级
+    VkDeviceSize                                  budget       = 0;
+
+    static constexpr VkPipelineStageFlags shaderStages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                                                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+    static VkExtent3D MipExtent(VkExtent2D extent, uint32_t level)
+    {
+        return {std::max(1U, extent.width >> level), std::max(1U, extent.height >> level), 1};
+    }
+    /**
+     * @brief 在工作线程中执行：读取文件并转码，把[loadFirstLevel, loadEndLevel)的数据写入暂存内存
+     * @note 首次读取时确定纹理的元数据和要加载的等级范围
+     */
+    void Load(const std::shared_ptr<streamedTexture>& pTexture)
+    {
+        streamedTexture& texture = *pTexture;
+        bool             loaded  = false;
+        mappedFile       file;
+        ktxTexture2*     pKtxTexture2 = nullptr;
+        ktx_error_code_e error        = KTX_FILE_OPEN_FAILED;
+        if (file.Open(texture.filepath.c_str()) == VK_SUCCESS)
+        {
+            error = ktxTexture2_CreateFromMemory(file.Data(), file.Size(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT,
+                                                 &pKtxTexture2);
+        }
+        if (error == KTX_SUCCESS)
+        {
+            // Basis Universal编码的数据只能整体转码，即便只需要其中的几个等级
+            ktxTexture* pKtxTexture = ktxTexture(pKtxTexture2);
+            if (ktxTexture2_NeedsTranscoding(pKtxTexture2))
+            {
+                error = ktxTexture2_TranscodeBasis(pKtxTexture2, transcodeFormat, 0);
+            }
+            if (error != KTX_SUCCESS)
+            {
+                LOG(ERROR) << "[ textureStreamer ] ERROR\nFailed to transcode the KTX2 file: " << texture.filepath
+                           << "\n"
+                           << ktxErrorString(error);
+            }
+            else if (pKtxTexture->numDimensions != 2 || pKtxTexture->numFaces != 1 || pKtxTexture->isArray ||
+                     pKtxTexture->numLevels == 1)
+            {
+                LOG(ERROR) << "[ textureStreamer ] ERROR\nOnly 2D KTX2 textures with mipmaps can be streamed: "
+                           << texture.filepath;
+            }
+            else if (!FormatSupportsSampling(static_cast<VkFormat>(pKtxTexture2->vkFormat)))
+            {
+                LOG(ERROR) << "[ textureStreamer ] ERROR\nThe format of the KTX2 file isn't supported by the device: "
+                           << texture.filepath << "\nVkFormat: " << pKtxTexture2->vkFormat;
+            }
+            else
+            {
+                if (texture.mipLevelCount == 0)
+                {
+                    texture.format        = static_cast<VkFormat>(pKtxTexture2->vkFormat);
+                    texture.extent        = {pKtxTexture->baseWidth, pKtxTexture->baseHeight};
+                    texture.mipLevelCount = pKtxTexture->numLevels;
+                    texture.levelSizes.resize(texture.mipLevelCount);
+                    for (uint32_t level = 0; level < texture.mipLevelCount; level++)
+                    {
+                        texture.levelSizes[level] = ktxTexture_GetImageSize(pKtxTexture, level);
+                    }
+                    texture.baseLevel = texture.mipLevelCount - 1;
+                    while (texture.baseLevel > 0 &&
+                           std::max(texture.extent.width, texture.extent.height) >> (texture.baseLevel - 1) <=
+                               options.minResidentSize)
+                    {
+                        texture.baseLevel--;
+                    }
+                    texture.residentLevel  = texture.mipLevelCount;
+                    texture.loadFirstLevel = texture.baseLevel;
+                    texture.loadEndLevel   = texture.mipLevelCount;
+                }
+
+                // 文件中的等级由小到大排列，所需的等级是一段连续的数据
+                ktx_size_t beginOffset = SIZE_MAX;
+                ktx_size_t endOffset   = 0;
+                texture.copyRegions.clear();
+                for (uint32_t level = texture.loadFirstLevel; level < texture.loadEndLevel; level++)
+                {
+                    ktx_size_t offset = 0;
+                    ktxTexture_GetImageOffset(pKtxTexture, level, 0, 0, &offset);
+                    beginOffset = std::min(beginOffset, offset);
+                    endOffset   = std::max(endOffset, offset + ktxTexture_GetImageSize(pKtxTexture, level));
+                    texture.copyRegions.push_back({
+                        .bufferOffset     = offset,
+                        .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - texture.loadFirstLevel, 0, 1},
+                        .imageExtent      = MipExtent(texture.extent, level),
+                    });
+                }
+                for (auto& i : texture.copyRegions) { i.bufferOffset -= beginOffset; }
+                loaded = WriteStaging(texture, ktxTexture_GetData(pKtxTexture) + beginOffset, endOffset - beginOffset);
+            }
+            ktxTexture_Destroy(pKtxTexture);
+        }
+        else
+        {
+            LOG(ERROR) << "[ textureStreamer ] ERROR\nFailed to read the KTX2 file: " << texture.filepath << "\n"
+                       << ktxErrorString(error);
+        }
+
+        // 失败的纹理保持loading状态，由主线程扣除loadingSize后再改变状态，以免在此之前开始新的加载
+        std::lock_guard lock(mutex);
+        if (loaded)
+        {
+            decodedTextures.push_back(pTexture);
+            texture.state.store(streamState::decoded, std::memory_order_release);
+        }
+        else { failedTextures.push_back(pTexture); }
+    }
+    /**
+     * @note 暂存区已满时复制一份数据留待WriteUnstaged(...)写入，不在工作线程中等待
+     */
+    bool WriteStaging(streamedTexture& texture, const void* pData, VkDeviceSize size)
+    {
+        // 须以对齐后的大小比较，否则对齐前恰好放得下的数据永远分配不到
+        if (stagingArena::AlignedSize(size) <= arena.Capacity())
+        {
+            if (arena.Allocate(size, texture.stagingRegion))
+            {
+                memcpy(arena.Pointer(texture.stagingRegion), pData, static_cast<size_t>(size));
+            }
+            else
+            {
+                const auto* pBytes = static_cast<const uint8_t*>(pData);
+                texture.unstagedData.assign(pBytes, pBytes + size);
+            }
+            return true;
+        }
+        VkBufferCreateInfo bufferCreateInfo = {
+            .size  = size,
+            .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        };
+        return texture.dedicatedStaging.Create(bufferCreateInfo, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) == VK_SUCCESS &&
+               texture.dedicatedStaging.BufferData(pData, size) == VK_SUCCESS;
+    }
+    /**
+     * @brief 在主线程中执行：把读取时未能写入暂存区的数据写入暂存区
+     *
+     * @return bool 暂存区仍没有足够的空间时返回false
+     */
+    bool WriteUnstaged(streamedTexture& texture)
+    {
+        if (!arena.Allocate(texture.unstagedData.size(), texture.stagingRegion)) { return false; }
+        memcpy(arena.Pointer(texture.stagingRegion), texture.unstagedData.data(), texture.unstagedData.size());
+        std::vector<uint8_t>().swap(texture.unstagedData);
+        return true;
+    }
+    void ReleaseStaging(streamedTexture& texture)
+    {
+        if (texture.dedicatedStaging.AllocationSize() != 0U) { texture.dedicatedStaging.~bufferMemory(); }
+        else { arena.Free(texture.stagingRegion); }
+    }
+    /**
+     * @brief 只等待已开始的读取和已提交的变更，不再开始新的工作，读取完而未提交的数据被丢弃
+     */
+    void Drain()
+    {
+        loadingTasks.Wait();
+        for (auto& i : transferBatches) { i.fence.Wait(); }
+        auto Discard = [this](streamedTexture& texture) {
+            // 数据留在unstagedData中时没有分配暂存内存
+            if (texture.copyRegions.size() != 0U && texture.unstagedData.empty()) { ReleaseStaging(texture); }
+            texture.copyRegions.clear();
+            std::vector<uint8_t>().swap(texture.unstagedData);
+            texture.state.store(texture.pResident ? streamState::idle : streamState::failed, std::memory_order_release);
+        };
+        for (auto& batch : transferBatches)
+        {
+            for (auto& i : batch.textures) { Discard(*i); }
+            commandPool_transfer.FreeBuffers(batch.commandBuffer);
+        }
+        for (auto& i : decodedTextures) { Discard(*i); }
+        for (auto& i : unstagedTextures) { Discard(*i); }
+        for (auto& i : failedTextures) { Discard(*i); }
+        transferBatches.clear();
+        decodedTextures.clear();
+        unstagedTextures.clear();
+        failedTextures.clear();
+    }
+    void StartLoad(const std::shared_ptr<streamedTexture>& pTexture)
+    {
+        pTexture->state.store(streamState::loading, std::memory_order_relaxed);
+        pool.Submit([this, pTexture] { Load(pTexture); }, loadingTasks);
+    }
+    /**
+     * @brief 查询本对象可以使用的显存量
+     */
+    VkDeviceSize QueryBudget() const
+    {
+        const GraphicsBase& base = GraphicsBase::Base();
+        if (!base.DeviceExtensionEnabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) ||
+            base.ApiVersion() < VK_API_VERSION_1_1)
+        {
+            return options.budget;
+        }
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT memoryBudgetProperties = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT,
+        };
+        VkPhysicalDeviceMemoryProperties2 memoryProperties = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+            .pNext = &memoryBudgetProperties,
+        };
+        vkGetPhysicalDeviceMemoryProperties2(base.PhysicalDevice(), &memoryProperties);
+        VkDeviceSize heapBudget = 0;
+        VkDeviceSize heapUsage  = 0;
+        for (uint32_t i = 0; i < memoryProperties.memoryProperties.memoryHeapCount; i++)
+        {
+            if ((memoryProperties.memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) == 0U)
+            {
+                continue;
+            }
+            heapBudget += memoryBudgetProperties.heapBudget[i];
+            heapUsage += memoryBudgetProperties.heapUsage[i];
+        }
+        // 堆的用量中包含本对象的图像，其余部分是其他对象的
+        VkDeviceSize ownSize    = residentSize + retiredSize;
+        VkDeviceSize otherUsage = heapUsage > ownSize ? heapUsage - ownSize : 0;
+        return std::min(options.budget, heapBudget > otherUsage ? heapBudget - otherUsage : 0);
+    }
+    /**
+     * @brief 为纹理创建覆盖[newLevel, mipLevelCount)的新图像
+     */
+    std::unique_ptr<streamedTexture::residentImage> CreateImage(const streamedTexture& texture, uint32_t newLevel)
+    {
+        auto              pImage          = std::make_unique<streamedTexture::residentImage>();
+        uint32_t          levelCount      = texture.mipLevelCount - newLevel;
+        VkImageCreateInfo imageCreateInfo = {
+            .imageType   = VK_IMAGE_TYPE_2D,
+            .format      = texture.format,
+            .extent      = MipExtent(texture.extent, newLevel),
+            .mipLevels   = levelCount,
+            .arrayLayers = 1,
+            .samples     = VK_SAMPLE_COUNT_1_BIT,
+            .tiling      = VK_IMAGE_TILING_OPTIMAL,
+            // 驻留等级再次变更时，本图像作为复制来源
+            .usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        };
+        if (pImage->imageMemory.Create(imageCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != VK_SUCCESS ||
+            pImage->imageView.Create(pImage->imageMemory.Image(), VK_IMAGE_VIEW_TYPE_2D, texture.format,
+                                     {VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount, 0, 1}) != VK_SUCCESS)
+        {
+            return nullptr;
+        }
+        return pImage;
+    }
+    /**
+     * @brief 把驻留等级的变更记录到一个命令缓冲区中并提交
+     * @note 旧图像中仍需要的等级被复制到新图像，加载的等级从暂存内存复制，每个阶段的屏障合并为一次
+     */
+    void SubmitChanges(const std::vector<residencyChange>& changes)
+    {
+        transferBatch                                                batch;
+        std::vector<std::unique_ptr<streamedTexture::residentImage>> newImages;
+        std::vector<VkImageMemoryBarrier>                            barriers;
+        std::vector<const residencyChange*>                          validChanges;
+        auto Barrier = [](VkImage image, uint32_t levelCount, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask,
+                          VkImageLayout oldLayout, VkImageLayout newLayout) {
+            return VkImageMemoryBarrier{
+                .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                .srcAccessMask       = srcAccessMask,
+                .dstAccessMask       = dstAccessMask,
+                .oldLayout           = oldLayout,
+                .newLayout           = newLayout,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image               = image,
+                .subresourceRange    = {VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount, 0, 1},
+            };
+        };
+
+        for (auto& i : changes)
+        {
+            streamedTexture& texture = *i.pTexture;
+            auto             pImage  = CreateImage(texture, i.newLevel);
+            if (!pImage)
+            {
+                if (texture.State() == streamState::decoded)
+                {
+                    ReleaseStaging(texture);
+                    texture.copyRegions.clear();
+                    loadingSize -= texture.loadSize;
+                }
+                texture.state.store(streamState::idle, std::memory_order_release);
+                continue;
+            }
+            barriers.push_back(Barrier(pImage->imageMemory.Image(), texture.mipLevelCount - i.newLevel, 0,
+                                       VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED,
+                                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL));
+            if (texture.pResident)
+            {
+                // 之前的读取只需要执行依赖
+                barriers.push_back(Barrier(texture.pResident->imageMemory.Image(),
+                                           texture.mipLevelCount - texture.residentLevel, 0,
+                                           VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                           VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL));
+            }
+            newImages.push_back(std::move(pImage));
+            validChanges.push_back(&i);
+        }
+        if (validChanges.empty()) { return; }
+
+        commandPool_transfer.AllocateBuffers(batch.commandBuffer);
+        batch.commandBuffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        vkCmdPipelineBarrier(batch.commandBuffer, shaderStages, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
+                             nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+        barriers.clear();
+
+        for (size_t i = 0; i < validChanges.size(); i++)
+        {
+            streamedTexture& texture  = *validChanges[i]->pTexture;
+            uint32_t         newLevel = validChanges[i]->newLevel;
+            VkImage          newImage = newImages[i]->imageMemory.Image();
+            // 新旧图像都有的等级
+            if (texture.pResident)
+            {
+                std::vector<VkImageCopy> regions;
+                for (uint32_t level = std::max(newLevel, texture.residentLevel); level < texture.mipLevelCount; level++)
+                {
+                    regions.push_back({
+                        .srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - texture.residentLevel, 0, 1},
+                        .dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - newLevel, 0, 1},
+                        .extent         = MipExtent(texture.extent, level),
+                    });
+                }
+                vkCmdCopyImage(batch.commandBuffer, texture.pResident->imageMemory.Image(),
+                               VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, newImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               static_cast<uint32_t>(regions.size()), regions.data());
+            }
+            // 新加载的等级
+            if (texture.State() == streamState::decoded)
+            {
+                bool dedicated = texture.dedicatedStaging.AllocationSize() != 0U;
+                if (!dedicated)
+                {
+                    for (auto& region : texture.copyRegions) { region.bufferOffset += texture.stagingRegion.offset; }
+                }
+                vkCmdCopyBufferToImage(batch.commandBuffer,
+                                       dedicated ? texture.dedicatedStaging.Buffer() : arena.Buffer(), newImage,
+                                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                       static_cast<uint32_t>(texture.copyRegions.size()), texture.copyRegions.data());
+                loadingSize -= texture.loadSize;
+            }
+            barriers.push_back(Barrier(newImage, texture.mipLevelCount - newLevel, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                       VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                       VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+
+            // 替换图像，旧图像在GPU执行完毕后销毁
+            if (texture.pResident)
+            {
+                VkDeviceSize size = texture.ResidentSize(texture.residentLevel);
+                residentSize -= size;
+                retiredSize += size;
+                batch.retiredSize += size;
+                batch.retiredImages.push_back(std::move(texture.pResident));
+            }
+            texture.pResident     = std::move(newImages[i]);
+            texture.residentLevel = newLevel;
+            texture.version++;
+            residentSize += texture.ResidentSize(newLevel);
+            texture.state.store(streamState::transferring, std::memory_order_release);
+        }
+        vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, shaderStages, 0, 0, nullptr, 0,
+                             nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+        batch.commandBuffer.End();
+        GraphicsBase::Base().SubmitCommandBuffer_Graphics(batch.commandBuffer, batch.fence);
+        for (auto i : validChanges) { batch.textures.push_back(i->pTexture); }
+        transferBatches.push_back(std::move(batch));
+    }
+
+public:
+    textureStreamer(const textureStreamerOptions& options = {}, threadPool& pool = threadPool::Shared())
+        : options(options),
+          pool(pool),
+          arena(options.stagingCapacity),
+          commandPool_transfer(GraphicsBase::Base().QueueFamilyIndex_Graphics(),
+                               VK_COMMAND_POOL_CREATE_TRANSIENT_BIT),
+          transcodeFormat(SelectKtxTranscodeFormat()),
+          budget(options.budget)
+    {
+    }
+    textureStreamer(const textureStreamer&)            = delete;
+    textureStreamer& operator=(const textureStreamer&) = delete;
+    // 析构时不能调用WaitIdle()，其中的Update(...)会开始新的加载和变更
+    ~textureStreamer() { Drain(); }
+
+    // Getter
+    VkDeviceSize ResidentSize() const { return residentSize; }
+    VkDeviceSize Budget() const { return budget; }  // 上一次Update(...)时的有效预算
+
+    // Non-const Function
+    /**
+     * @brief 加入一张流送的纹理，开始异步加载其始终驻留的等级
+     */
+    std::shared_ptr<streamedTexture> Add(const char* filepath)
+    {
+        auto pTexture      = std::make_shared<streamedTexture>();
+        pTexture->filepath = filepath;
+        textures.push_back(pTexture);
+        StartLoad(pTexture);
+        return pTexture;
+    }
+    /**
+     * @brief 记录本帧对纹理的需求，每个使用该纹理的材质各调用一次
+     *
+     * @param projectedSize 纹理铺满一次时在屏幕上覆盖的像素数（边长），
+     * 如lodSelector::ProjectedError(物体的尺寸 / 纹理的重复次数, 距离)
+     */
+    void Request(streamedTexture& texture, float projectedSize)
+    {
+        texture.requestedSize    = std::max(texture.requestedSize, projectedSize);
+        texture.lastRequestFrame = frame;
+    }
+    /**
+     * @brief 处理执行完毕的变更、提交新的变更并开始新的加载，应在主线程中每帧调用一次，在记录命令之前
+     *
+     * @return uint32_t 本次图像被替换的纹理数，它们的Version()已递增
+     */
+    uint32_t Update()
+    {
+        // 回收执行完毕的批次
+        while (!transferBatches.empty() && transferBatches.front().fence.Status() == VK_SUCCESS)
+        {
+            auto& batch = transferBatches.front();
+            for (auto& i : batch.textures)
+            {
+                if (i->copyRegions.size() != 0U)
+                {
+                    ReleaseStaging(*i);
+                    i->copyRegions.clear();
+                }
+                i->state.store(streamState::idle, std::memory_order_release);
+            }
+            retiredSize -= batch.retiredSize;
+            commandPool_transfer.FreeBuffers(batch.commandBuffer);
+            transferBatches.pop_front();
+        }
+
+        budget = QueryBudget();
+        std::vector<residencyChange> changes;
+
+        // 已加载的等级，以及读取失败的纹理
+        {
+            std::lock_guard lock(mutex);
+            for (auto& i : decodedTextures)
+            {
+                if (i->unstagedData.empty()) { changes.push_back({i, i->loadFirstLevel}); }
+                else { unstagedTextures.push_back(i); }
+            }
+            decodedTextures.clear();
+            for (auto& i : failedTextures)
+            {
+                loadingSize -= i->loadSize;
+                // 首次读取失败的纹理不再被流送，之后的失败只是放弃这一次升级
+                i->state.store(i->mipLevelCount == 0 ? streamState::failed : streamState::idle,
+                               std::memory_order_release);
+            }
+            failedTextures.clear();
+        }
+        // 上面回收了暂存内存，按读取的顺序写入等待中的纹理，直到空间不足
+        while (!unstagedTextures.empty())
+        {
+            std::shared_ptr<streamedTexture>& pTexture = unstagedTextures.front();
+            // 比整个暂存区还大的数据永远写不进去，若不放弃这次加载，WaitIdle()会一直等下去
+            if (stagingArena::AlignedSize(pTexture->unstagedData.size()) > arena.Capacity())
+            {
+                LOG(ERROR) << "[ textureStreamer ] ERROR\nThe loaded levels are larger than the staging arena!\nSize: "
+                           << pTexture->unstagedData.size() << ", capacity: " << arena.Capacity();
+                std::vector<uint8_t>().swap(pTexture->unstagedData);
+                pTexture->copyRegions.clear();
+                loadingSize -= pTexture->loadSize;
+                // 与读取失败一样，始终驻留的等级都加载不了的纹理不再被流送
+                pTexture->state.store(pTexture->pResident ? streamState::idle : streamState::failed,
+                                      std::memory_order_release);
+            }
+            else if (WriteUnstaged(*pTexture)) { changes.push_back({pTexture, pTexture->loadFirstLevel}); }
+            else { break; }
+            unstagedTextures.pop_front();
+        }
+
+        // 由需求得到所需的等级
+        std::vector<std::pair<std::shared_ptr<streamedTexture>, uint32_t>> upgrades;
+        std::vector<std::pair<std::shared_ptr<streamedTexture>, uint32_t>> downgrades;
+        for (auto& i : textures)
+        {
+            streamedTexture& texture = *i;
+            if (texture.State() != streamState::idle) { continue; }
+            uint32_t wantedLevel = texture.residentLevel;
+            if (texture.requestedSize > 0.F)
+            {
+                float level = std::log2(std::max(texture.extent.width, texture.extent.height) / texture.requestedSize);
+                wantedLevel = std::min(static_cast<uint32_t>(std::max(level, 0.F)), texture.baseLevel);
+            }
+            else if (frame - texture.lastRequestFrame > options.evictionDelay) { wantedLevel = texture.baseLevel; }
+            texture.requestedSize = 0.F;
+            if (wantedLevel < texture.residentLevel) { upgrades.push_back({i, wantedLevel}); }
+            else if (wantedLevel > texture.residentLevel) { downgrades.push_back({i, wantedLevel}); }
+        }
+
+        // 最久未被请求的先降级
+        std::sort(downgrades.begin(), downgrades.end(),
+                  [](auto& a, auto& b) { return a.first->lastRequestFrame < b.first->lastRequestFrame; });
+        size_t       downgradeCount = 0;
+        VkDeviceSize usage          = residentSize + retiredSize + loadingSize;
+        auto         Downgrade      = [&] {
+            auto& [pTexture, level] = downgrades[downgradeCount++];
+            // 降级时新旧图像并存到GPU执行完毕，但之后的用量减少
+            usage -= pTexture->ResidentSize(pTexture->residentLevel) - pTexture->ResidentSize(level);
+            changes.push_back({pTexture, level});
+        };
+        while (usage > budget && downgradeCount < downgrades.size()) { Downgrade(); }
+
+        // 缺得最多的先升级，预算不足时先降级其他纹理，仍不足时少加载几级
+        std::sort(upgrades.begin(), upgrades.end(), [](auto& a, auto& b) {
+            return a.first->residentLevel - a.second > b.first->residentLevel - b.second;
+        });
+        for (auto& upgrade : upgrades)
+        {
+            const auto& pTexture = upgrade.first;
+            uint32_t    level    = upgrade.second;
+            if (loadingTasks.Count() >= options.maxConcurrentLoads) { break; }
+            auto Cost = [&] { return pTexture->ResidentSize(level) - pTexture->ResidentSize(pTexture->residentLevel); };
+            while (usage + Cost() > budget && downgradeCount < downgrades.size()) { Downgrade(); }
+            while (level < pTexture->residentLevel && usage + Cost() > budget) { level++; }
+            if (level == pTexture->residentLevel) { continue; }
+            pTexture->loadFirstLevel = level;
+            pTexture->loadEndLevel   = pTexture->residentLevel;
+            pTexture->loadSize       = Cost();
+            usage += pTexture->loadSize;
+            loadingSize += pTexture->loadSize;
+            StartLoad(pTexture);
+        }
+
+        if (!changes.empty()) { SubmitChanges(changes); }
+        frame++;
+        return static_cast<uint32_t>(changes.size());
+    }
+    /**
+     * @brief 等待所有加载和已提交的变更完成
+     * @note 其间仍会调用Update(...)，可能开始新的加载和变更
+     */
+    void WaitIdle()
+    {
+        while (true)
+        {
+            loadingTasks.Wait();  // 读取任务不等待暂存区，总会执行完
+            Update();             // 可能开始新的加载
+            if (!transferBatches.empty()) { transferBatches.back().fence.Wait(); }
+            else if (unstagedTextures.empty() && loadingTasks.Count() == 0) { return; }
+        }
+    }
+};
+
+}  // namespace easyVulkan
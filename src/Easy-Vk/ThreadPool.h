@@ -0,0 +1,126 @@
+#pragma once
+#include "EasyVKStart.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace easyVulkan {
+
+/**
+ * @brief 已提交到线程池而尚未执行完的任务的计数，Wait()阻塞到计数归零
+ * @note 以threadPool::Submit(task, counter)提交的任务执行完后自动递减计数，此后不再访问任务的捕获
+ */
+class taskCounter {
+    std::atomic<uint32_t>   count = 0;
+    std::mutex              mutex;
+    std::condition_variable condition;
+
+public:
+    taskCounter() = default;
+    taskCounter(const taskCounter&)            = delete;
+    taskCounter& operator=(const taskCounter&) = delete;
+
+    // Getter
+    uint32_t Count() const { return count.load(std::memory_order_acquire); }
+
+    // Non-const Function
+    void Add() { count.fetch_add(1, std::memory_order_relaxed); }
+    void Done()
+    {
+        if (count.fetch_sub(1, std::memory_order_acq_rel) != 1) { return; }
+        // 在锁内通知，否则Wait()可能在检查计数之后、开始等待之前错过通知
+        std::lock_guard lock(mutex);
+        condition.notify_all();
+    }
+    void Wait()
+    {
+        std::unique_lock lock(mutex);
+        condition.wait(lock, [this] { return Count() == 0; });
+    }
+};
+
+/**
+ * @brief 固定线程数的线程池，任务按提交的顺序取出执行
+ * @note 析构时会先执行完队列中剩余的任务再回收线程
+ */
+class threadPool {
+    std::vector<std::thread>          workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex                        mutex;
+    std::condition_variable           condition;
+    bool                              stopping = false;
+
+    void WorkerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(mutex);
+                condition.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) { return; }  // stopping且没有剩余任务
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+public:
+    explicit threadPool(uint32_t threadCount = DefaultThreadCount())
+    {
+        workers.reserve(threadCount);
+        for (uint32_t i = 0; i < threadCount; i++) { workers.emplace_back(&threadPool::WorkerLoop, this); }
+    }
+    threadPool(const threadPool&)            = delete;
+    threadPool& operator=(const threadPool&) = delete;
+    ~threadPool()
+    {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        for (auto& i : workers) { i.join(); }
+    }
+
+    // Getter
+    uint32_t ThreadCount() const { return static_cast<uint32_t>(workers.size()); }
+
+    // Non-const Function
+    void Submit(std::function<void()> task)
+    {
+        {
+            std::lock_guard lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        condition.notify_one();
+    }
+    /**
+     * @brief 提交任务并计入counter，任务的捕获先于计数的递减被销毁，计数归零后调用者便可以安全地析构
+     */
+    void Submit(std::function<void()> task, taskCounter& counter)
+    {
+        counter.Add();
+        Submit([task = std::move(task), &counter]() mutable {
+            task();
+            task = nullptr;
+            counter.Done();
+        });
+    }
+
+    // Static Function
+    // 留出一个核心给主线程
+    static uint32_t DefaultThreadCount() { return std::max(2U, std::thread::hardware_concurrency()) - 1; }
+    // 加载资源所用的共享线程池，首次调用时创建
+    static threadPool& Shared()
+    {
+        static threadPool pool;
+        return pool;
+    }
+};
+
+}  // namespace easyVulkan
@@ -1,19 +1,319 @@
+#pragma once
 #include "VKBase.h"
 
 using namespace vulkan;
 
+namespace vulkan {
+
+/**
+ * @brief 管线状态的规范化表示，用于判断两份创建信息是否描述同一管线
+ * @note 按成员逐个写入字节，跳过sType、pNext和结构体中的填充，数组写入其元素个数和内容；
+ * pNext链中的VkPipelineRenderingCreateInfo和管线库的创建信息计入，创建反馈只是输出，不计入，
+ * 链中有其他结构体时无法判断其影响，此时Comparable()为false，与任何键都不相等；
+ * 着色器模块、管线布局和渲染通道以句柄区分，内容相同的着色器模块应经shaderModuleCache去重；
+ * 各部分的划分与VK_EXT_graphics_pipeline_library的四个部分一致，可分别用于管线库的缓存；
+ * 列于pDynamicState中的状态不计入，仅动态状态的值不同的管线视为同一管线
+ */
+class pipelineStateKey {
+    std::vector<uint8_t> bytes;
+    bool                 comparable = true;
+
+    void Append(const void* pData, size_t size)
+    {
+        bytes.insert(bytes.end(), static_cast<const uint8_t*>(pData), static_cast<const uint8_t*>(pData) + size);
+    }
+    template <typename T>
+    void AppendArray(const T* pArray, uint32_t count)
+    {
+        Append(&count, sizeof count);
+        if (pArray != nullptr) { Append(pArray, sizeof(T) * count); }
+    }
+    // 写入从first到last（含）的连续成员
+    template <typename First, typename Last>
+    void AppendFields(const First& first, const Last& last)
+    {
+        const auto* pBegin = reinterpret_cast<const uint8_t*>(&first);
+        Append(pBegin, reinterpret_cast<const uint8_t*>(&last) + sizeof last - pBegin);
+    }
+    void AppendNext(const void* pNext)
+    {
+        const auto* pStructure = static_cast<const VkBaseInStructure*>(pNext);
+        for (; pStructure != nullptr; pStructure = pStructure->pNext)
+        {
+            switch (pStructure->sType)
+            {
+                case VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO:
+                {
+                    const auto& info = *reinterpret_cast<const VkPipelineRenderingCreateInfo*>(pStructure);
+                    Append(&info.sType, sizeof info.sType);
+                    Append(&info.viewMask, sizeof info.viewMask);
+                    AppendArray(info.pColorAttachmentFormats, info.colorAttachmentCount);
+                    AppendFields(info.depthAttachmentFormat, info.stencilAttachmentFormat);
+                    break;
+                }
+                case VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT:
+                {
+                    const auto& info = *reinterpret_cast<const VkGraphicsPipelineLibraryCreateInfoEXT*>(pStructure);
+                    Append(&info.sType, sizeof info.sType);
+                    Append(&info.flags, sizeof info.flags);
+                    break;
+                }
+                case VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR:
+                {
+                    const auto& info = *reinterpret_cast<const VkPipelineLibraryCreateInfoKHR*>(pStructure);
+                    Append(&info.sType, sizeof info.sType);
+                    AppendArray(info.pLibraries, info.libraryCount);
+                    break;
+                }
+                case VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO: break;
+                default: comparable = false; break;
+            }
+        }
+    }
+    void AppendStage(const VkPipelineShaderStageCreateInfo& stage)
+    {
+        AppendNext(stage.pNext);
+        AppendFields(stage.flags, stage.module);
+        Append(stage.pName, strlen(stage.pName) + 1);
+        const VkSpecializationInfo* pInfo = stage.pSpecializationInfo;
+        AppendArray(pInfo != nullptr ? pInfo->pMapEntries : nullptr, pInfo != nullptr ? pInfo->mapEntryCount : 0);
+        if (pInfo != nullptr) { AppendArray(static_cast<const uint8_t*>(pInfo->pData), pInfo->dataSize); }
+    }
+    void AppendStages(const VkGraphicsPipelineCreateInfo& info, bool fragment)
+    {
+        for (uint32_t i = 0; i < info.stageCount; i++)
+        {
+            if ((info.pStages[i].stage == VK_SHADER_STAGE_FRAGMENT_BIT) == fragment) { AppendStage(info.pStages[i]); }
+        }
+    }
+    // 状态为动态时，其在创建信息中的值被忽略，将其置零
+    template <typename T>
+    static void Mask(const VkGraphicsPipelineCreateInfo& info, VkDynamicState state, T& field)
+    {
+        if (IsDynamic(info, state)) { field = T{}; }
+    }
+    void AppendMultisample(const VkPipelineMultisampleStateCreateInfo* pState)
+    {
+        if (pState == nullptr) { return; }
+        AppendFields(pState->rasterizationSamples, pState->minSampleShading);
+        AppendFields(pState->alphaToCoverageEnable, pState->alphaToOneEnable);
+        AppendArray(pState->pSampleMask, pState->pSampleMask != nullptr ? (pState->rasterizationSamples + 31) / 32 : 0);
+    }
+
+public:
+    pipelineStateKey() = default;
+    /**
+     * @brief 由完整的图形管线创建信息构造
+     */
+    explicit pipelineStateKey(const VkGraphicsPipelineCreateInfo& info)
+    {
+        // 派生关系不影响管线的行为
+        VkPipelineCreateFlags flags =
+            info.flags & ~(VK_PIPELINE_CREATE_ALLOW_DERIVATIVES_BIT | VK_PIPELINE_CREATE_DERIVATIVE_BIT);
+        Append(&flags, sizeof flags);
+        AppendNext(info.pNext);
+        DynamicState(info).VertexInput(info).PreRasterization(info).FragmentShader(info).FragmentOutput(info);
+    }
+    /**
+     * @brief 由计算管线创建信息构造
+     */
+    explicit pipelineStateKey(const VkComputePipelineCreateInfo& info)
+    {
+        Append(&info.flags, sizeof info.flags);
+        AppendNext(info.pNext);
+        AppendStage(info.stage);
+        Append(&info.layout, sizeof info.layout);
+    }
+
+    // Getter
+    const std::vector<uint8_t>& Bytes() const { return bytes; }
+    bool                        Comparable() const { return comparable; }
+
+    // Const Function
+    uint64_t Hash() const { return HashBytes(bytes.data(), bytes.size()); }
+    bool     operator==(const pipelineStateKey& other) const
+    {
+        return comparable && other.comparable && bytes == other.bytes;
+    }
+
+    // Non-const Function
+    pipelineStateKey& DynamicState(const VkGraphicsPipelineCreateInfo& info)
+    {
+        std::vector<VkDynamicState> dynamicStates;
+        if (const auto* pState = info.pDynamicState)
+        {
+            dynamicStates.assign(pState->pDynamicStates, pState->pDynamicStates + pState->dynamicStateCount);
+        }
+        std::sort(dynamicStates.begin(), dynamicStates.end());  // 动态状态的顺序不影响管线
+        AppendArray(dynamicStates.data(), static_cast<uint32_t>(dynamicStates.size()));
+        return *this;
+    }
+    pipelineStateKey& VertexInput(const VkGraphicsPipelineCreateInfo& info)
+    {
+        const auto* pVertexInputState = info.pVertexInputState;
+        if (pVertexInputState != nullptr && !IsDynamic(info, VK_DYNAMIC_STATE_VERTEX_INPUT_EXT))
+        {
+            std::vector<VkVertexInputBindingDescription> bindings(
+                pVertexInputState->pVertexBindingDescriptions,
+                pVertexInputState->pVertexBindingDescriptions + pVertexInputState->vertexBindingDescriptionCount);
+            for (auto& i : bindings) { Mask(info, VK_DYNAMIC_STATE_VERTEX_INPUT_BINDING_STRIDE, i.stride); }
+            AppendArray(bindings.data(), static_cast<uint32_t>(bindings.size()));
+            AppendArray(pVertexInputState->pVertexAttributeDescriptions,
+                        pVertexInputState->vertexAttributeDescriptionCount);
+        }
+        if (info.pInputAssemblyState != nullptr)
+        {
+            VkPipelineInputAssemblyStateCreateInfo state = *info.pInputAssemblyState;
+            // 拓扑动态时，管线中只需指定拓扑类型
+            if (IsDynamic(info, VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY))
+            {
+                state.topology = TopologyClass(state.topology);
+            }
+            Mask(info, VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE, state.primitiveRestartEnable);
+            AppendFields(state.topology, state.primitiveRestartEnable);
+        }
+        return *this;
+    }
+    pipelineStateKey& PreRasterization(const VkGraphicsPipelineCreateInfo& info)
+    {
+        AppendStages(info, false);
+        if (const auto* pState = info.pViewportState)
+        {
+            uint32_t viewportCount = IsDynamic(info, VK_DYNAMIC_STATE_VIEWPORT_WITH_COUNT) ? 0 : pState->viewportCount;
+            uint32_t scissorCount  = IsDynamic(info, VK_DYNAMIC_STATE_SCISSOR_WITH_COUNT) ? 0 : pState->scissorCount;
+            AppendArray(IsDynamic(info, VK_DYNAMIC_STATE_VIEWPORT) ? nullptr : pState->pViewports, viewportCount);
+            AppendArray(IsDynamic(info, VK_DYNAMIC_STATE_SCISSOR) ? nullptr : pState->pScissors, scissorCount);
+        }
+        if (info.pRasterizationState != nullptr)
+        {
+            VkPipelineRasterizationStateCreateInfo state = *info.pRasterizationState;
+            Mask(info, VK_DYNAMIC_STATE_DEPTH_CLAMP_ENABLE_EXT, state.depthClampEnable);
+            Mask(info, VK_DYNAMIC_STATE_RASTERIZER_DISCARD_ENABLE, state.rasterizerDiscardEnable);
+            Mask(info, VK_DYNAMIC_STATE_POLYGON_MODE_EXT, state.polygonMode);
+            Mask(info, VK_DYNAMIC_STATE_CULL_MODE, state.cullMode);
+            Mask(info, VK_DYNAMIC_STATE_FRONT_FACE, state.frontFace);
+            Mask(info, VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE, state.depthBiasEnable);
+            Mask(info, VK_DYNAMIC_STATE_DEPTH_BIAS, state.depthBiasConstantFactor);
+            Mask(info, VK_DYNAMIC_STATE_DEPTH_BIAS, state.depthBiasClamp);
+            Mask(info, VK_DYNAMIC_STATE_DEPTH_BIAS, state.depthBiasSlopeFactor);
+            Mask(info, VK_DYNAMIC_STATE_LINE_WIDTH, state.lineWidth);
+            AppendFields(state.depthClampEnable, state.lineWidth);
+        }
+        if (info.pTessellationState != nullptr)
+        {
+            uint32_t patchControlPoints = info.pTessellationState->patchControlPoints;
+            Mask(info, VK_DYNAMIC_STATE_PATCH_CONTROL_POINTS_EXT, patchControlPoints);
+            Append(&patchControlPoints, sizeof patchControlPoints);
+        }
+        Append(&info.layout, sizeof info.layout);
+        AppendFields(info.renderPass, info.subpass);
+        return *this;
+    }
+    pipelineStateKey& FragmentShader(const VkGraphicsPipelineCreateInfo& info)
+    {
+        AppendStages(info, true);
+        if (info.pDepthStencilState != nullptr)
+        {
+            VkPipelineDepthStencilStateCreateInfo state = *info.pDepthStencilState;
+            Mask(info, VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE, state.depthTestEnable);
+            Mask(info, VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE, state.depthWriteEnable);
+            Mask(info, VK_DYNAMIC_STATE_DEPTH_COMPARE_OP, state.depthCompareOp);
+            Mask(info, VK_DYNAMIC_STATE_DEPTH_BOUNDS_TEST_ENABLE, state.depthBoundsTestEnable);
+            Mask(info, VK_DYNAMIC_STATE_STENCIL_TEST_ENABLE, state.stencilTestEnable);
+            for (VkStencilOpState* pStencil : {&state.front, &state.back})
+            {
+                if (IsDynamic(info, VK_DYNAMIC_STATE_STENCIL_OP))
+                {
+                    pStencil->failOp = pStencil->passOp = pStencil->depthFailOp = VK_STENCIL_OP_KEEP;
+                    pStencil->compareOp                                        = VK_COMPARE_OP_NEVER;
+                }
+                Mask(info, VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK, pStencil->compareMask);
+                Mask(info, VK_DYNAMIC_STATE_STENCIL_WRITE_MASK, pStencil->writeMask);
+                Mask(info, VK_DYNAMIC_STATE_STENCIL_REFERENCE, pStencil->reference);
+            }
+            Mask(info, VK_DYNAMIC_STATE_DEPTH_BOUNDS, state.minDepthBounds);
+            Mask(info, VK_DYNAMIC_STATE_DEPTH_BOUNDS, state.maxDepthBounds);
+            AppendFields(state.depthTestEnable, state.maxDepthBounds);
+        }
+        AppendMultisample(info.pMultisampleState);
+        Append(&info.layout, sizeof info.layout);
+        AppendFields(info.renderPass, info.subpass);
+        return *this;
+    }
+    pipelineStateKey& FragmentOutput(const VkGraphicsPipelineCreateInfo& info)
+    {
+        if (info.pColorBlendState != nullptr)
+        {
+            VkPipelineColorBlendStateCreateInfo state = *info.pColorBlendState;
+            Mask(info, VK_DYNAMIC_STATE_LOGIC_OP_ENABLE_EXT, state.logicOpEnable);
+            Mask(info, VK_DYNAMIC_STATE_LOGIC_OP_EXT, state.logicOp);
+            AppendFields(state.logicOpEnable, state.logicOp);
+            std::vector<VkPipelineColorBlendAttachmentState> attachments(state.pAttachments,
+                                                                         state.pAttachments + state.attachmentCount);
+            for (auto& i : attachments)
+            {
+                Mask(info, VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT, i.blendEnable);
+                if (IsDynamic(info, VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT))
+                {
+                    i.srcColorBlendFactor = i.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+                    i.srcAlphaBlendFactor = i.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+                    i.colorBlendOp = i.alphaBlendOp = VK_BLEND_OP_ADD;
+                }
+                Mask(info, VK_DYNAMIC_STATE_COLOR_WRITE_MASK_EXT, i.colorWriteMask);
+            }
+            AppendArray(attachments.data(), static_cast<uint32_t>(attachments.size()));
+            if (!IsDynamic(info, VK_DYNAMIC_STATE_BLEND_CONSTANTS))
+            {
+                Append(state.blendConstants, sizeof state.blendConstants);
+            }
+        }
+        AppendMultisample(info.pMultisampleState);
+        AppendFields(info.renderPass, info.subpass);
+        return *this;
+    }
+
+    // Static Function
+    static bool IsDynamic(const VkGraphicsPipelineCreateInfo& info, VkDynamicState state)
+    {
+        const VkPipelineDynamicStateCreateInfo* pState = info.pDynamicState;
+        if (pState == nullptr) { return false; }
+        const VkDynamicState* pEnd = pState->pDynamicStates + pState->dynamicStateCount;
+        return std::find(pState->pDynamicStates, pEnd, state) != pEnd;
+    }
+    /**
+     * @brief 拓扑所属的类型，以该类型的第一个拓扑表示
+     */
+    static VkPrimitiveTopology TopologyClass(VkPrimitiveTopology topology)
+    {
+        switch (topology)
+        {
+            case VK_PRIMITIVE_TOPOLOGY_POINT_LIST: return VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+            case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
+            case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+            case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY:
+            case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY: return VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+            case VK_PRIMITIVE_TOPOLOGY_PATCH_LIST: return VK_PRIMITIVE_TOPOLOGY_PATCH_LIST;
+            default: return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        }
+    }
+};
+
+}  // namespace vulkan
+
 struct graphicsPipelineCreateInfoPack
 {
     VkGraphicsPipelineCreateInfo createInfo = {
         VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
     };
-    std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
+    // 各数组元素个数不超过模板参数时不分配内存
+    smallVector<VkPipelineShaderStageCreateInfo, 4> shaderStages;
+    smallVector<specializationConstants, 4>         specializations;  // 与shaderStages一一对应，非空时覆盖pSpecializationInfo
     // Vertex Input
     VkPipelineVertexInputStateCreateInfo vertexInputStateCi = {
         VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
     };
-    std::vector<VkVertexInputBindingDescription>   vertexInputBindings;
-    std::vector<VkVertexInputAttributeDescription> vertexInputAttributes;
+    smallVector<VkVertexInputBindingDescription, 4>   vertexInputBindings;
+    smallVector<VkVertexInputAttributeDescription, 8> vertexInputAttributes;
     // Input Assembly
     VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCi = {
         VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
@@ -26,8 +326,8 @@ struct graphicsPipelineCreateInfoPack
     VkPipelineViewportStateCreateInfo viewportStateCi = {
         VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
     };
-    std::vector<VkViewport> viewports;
-    std::vector<VkRect2D>   scissors;
+    smallVector<VkViewport, 1> viewports;
+    smallVector<VkRect2D, 1>   scissors;
     uint32_t dynamicViewportCount = 1;  // 动态视口/剪裁不会用到上述的vector，因此动态视口和剪裁的个数向这俩变量手动指定
     uint32_t dynamicScissorCount = 1;
     // Rasterization
@@ -46,12 +346,12 @@ struct graphicsPipelineCreateInfoPack
     VkPipelineColorBlendStateCreateInfo colorBlendStateCi = {
         VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
     };
-    std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachmentStates;
+    smallVector<VkPipelineColorBlendAttachmentState, 8> colorBlendAttachmentStates;
     // Dynamic
     VkPipelineDynamicStateCreateInfo dynamicStateCi = {
         VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
     };
-    std::vector<VkDynamicState> dynamicStates;
+    smallVector<VkDynamicState, 16> dynamicStates;
 
     graphicsPipelineCreateInfoPack()
     {
@@ -59,22 +359,12 @@ struct graphicsPipelineCreateInfoPack
         // 若非派生管线，createInfo.basePipelineIndex不得为0，设置为-1
         createInfo.basePipelineIndex = -1;
     }
-    // 移动构造器，所有指针都要重新赋值
-    graphicsPipelineCreateInfoPack(const graphicsPipelineCreateInfoPack& other) noexcept
+    // 复制和移动后，所有指针都要重新赋值
+    graphicsPipelineCreateInfoPack(const graphicsPipelineCreateInfoPack& other) { *this = other; }
+    graphicsPipelineCreateInfoPack(graphicsPipelineCreateInfoPack&& other) noexcept { *this = std::move(other); }
+    graphicsPipelineCreateInfoPack& operator=(const graphicsPipelineCreateInfoPack& other)
     {
-        createInfo = other.createInfo;
-        SetCreateInfos();
-
-        vertexInputStateCi   = other.vertexInputStateCi;
-        inputAssemblyStateCi = other.inputAssemblyStateCi;
-        tessellationStateCi  = other.tessellationStateCi;
-        viewportStateCi      = other.viewportStateCi;
-        rasterizationStateCi = other.rasterizationStateCi;
-        multisampleStateCi   = other.multisampleStateCi;
-        depthStencilStateCi  = other.depthStencilStateCi;
-        colorBlendStateCi    = other.colorBlendStateCi;
-        dynamicStateCi       = other.dynamicStateCi;
-
+        CopyCreateInfos(other);
         shaderStages               = other.shaderStages;
         vertexInputBindings        = other.vertexInputBindings;
         vertexInputAttributes      = other.vertexInputAttributes;
@@ -82,13 +372,72 @@ struct graphicsPipelineCreateInfoPack
         scissors                   = other.scissors;
         colorBlendAttachmentStates = other.colorBlendAttachmentStates;
         dynamicStates              = other.dynamicStates;
+        specializations            = other.specializations;
+        UpdateAllArrayAddresses();
+        return *this;
+    }
+    graphicsPipelineCreateInfoPack& operator=(graphicsPipelineCreateInfoPack&& other) noexcept
+    {
+        CopyCreateInfos(other);
+        shaderStages               = std::move(other.shaderStages);
+        vertexInputBindings        = std::move(other.vertexInputBindings);
+        vertexInputAttributes      = std::move(other.vertexInputAttributes);
+        viewports                  = std::move(other.viewports);
+        scissors                   = std::move(other.scissors);
+        colorBlendAttachmentStates = std::move(other.colorBlendAttachmentStates);
+        dynamicStates              = std::move(other.dynamicStates);
+        specializations            = std::move(other.specializations);
         UpdateAllArrayAddresses();
+        return *this;
     }
 
     // Getter，这里我没用const修饰符
     operator VkGraphicsPipelineCreateInfo&() { return createInfo; }
 
+    // Const Function
+    /**
+     * @brief 管线状态的哈希，状态相同的两个创建信息包的哈希相同
+     * @note 须已调用UpdateAllArrays()
+     */
+    uint64_t Hash() const { return pipelineStateKey(createInfo).Hash(); }
+    bool     operator==(const graphicsPipelineCreateInfoPack& other) const
+    {
+        return pipelineStateKey(createInfo) == pipelineStateKey(other.createInfo);
+    }
+
     // Non-const Function
+    /**
+     * @brief 取得第stageIndex个着色器阶段的特化常量，常量由创建信息包持有，复制创建信息包时指针随之更新
+     * @note 设置完毕后须调用UpdateAllArrays()
+     */
+    specializationConstants& Specialization(size_t stageIndex)
+    {
+        if (specializations.size() <= stageIndex) { specializations.resize(stageIndex + 1); }
+        return specializations[stageIndex];
+    }
+    /**
+     * @brief 允许以该管线为基础管线创建派生管线
+     */
+    void AllowDerivatives() { createInfo.flags |= VK_PIPELINE_CREATE_ALLOW_DERIVATIVES_BIT; }
+    /**
+     * @brief 作为派生管线，以已创建的base为基础管线
+     * @note base须以AllowDerivatives()创建
+     */
+    void DeriveFrom(VkPipeline base)
+    {
+        createInfo.flags             |= VK_PIPELINE_CREATE_DERIVATIVE_BIT;
+        createInfo.basePipelineHandle = base;
+        createInfo.basePipelineIndex  = -1;
+    }
+    /**
+     * @brief 作为派生管线，以同一批创建的管线中的第baseIndex个为基础管线
+     */
+    void DeriveFrom(int32_t baseIndex)
+    {
+        createInfo.flags             |= VK_PIPELINE_CREATE_DERIVATIVE_BIT;
+        createInfo.basePipelineHandle = VK_NULL_HANDLE;
+        createInfo.basePipelineIndex  = baseIndex;
+    }
     // 该函数用于将各个vector中数据的地址赋值给各个创建信息中相应成员，并相应改变各个count
     void UpdateAllArrays()
     {
@@ -105,6 +454,23 @@ struct graphicsPipelineCreateInfoPack
     }
 
 private:
+    void CopyCreateInfos(const graphicsPipelineCreateInfoPack& other)
+    {
+        createInfo = other.createInfo;
+        SetCreateInfos();
+
+        vertexInputStateCi   = other.vertexInputStateCi;
+        inputAssemblyStateCi = other.inputAssemblyStateCi;
+        tessellationStateCi  = other.tessellationStateCi;
+        viewportStateCi      = other.viewportStateCi;
+        rasterizationStateCi = other.rasterizationStateCi;
+        multisampleStateCi   = other.multisampleStateCi;
+        depthStencilStateCi  = other.depthStencilStateCi;
+        colorBlendStateCi    = other.colorBlendStateCi;
+        dynamicStateCi       = other.dynamicStateCi;
+        dynamicViewportCount = other.dynamicViewportCount;
+        dynamicScissorCount  = other.dynamicScissorCount;
+    }
     // 该函数用于将创建信息的地址赋值给basePipelineIndex中相应成员
     void SetCreateInfos()
     {
@@ -128,5 +494,387 @@ private:
         viewportStateCi.pScissors                       = scissors.data();
         colorBlendStateCi.pAttachments                  = colorBlendAttachmentStates.data();
         dynamicStateCi.pDynamicStates                   = dynamicStates.data();
+        for (size_t i = 0; i < std::min(shaderStages.size(), specializations.size()); i++)
+        {
+            if (!specializations[i].Empty()) { shaderStages[i].pSpecializationInfo = specializations[i].Info(); }
+        }
+    }
+};
+
+namespace vulkan {
+
+/**
+ * @brief 管线变体，以同一份创建信息为模板，按特化常量的取值创建并缓存管线
+ * @note 光源数量、工作组大小、功能开关等以特化常量给出后，驱动可以折叠分支、展开循环，
+ * 代价是每种取值各编译一次管线，因此变体在首次使用时创建，之后以特化常量查找
+ */
+class pipelineVariants {
+    struct variant
+    {
+        specializationConstants   constants;
+        std::unique_ptr<pipeline> handle;
+    };
+    std::unique_ptr<graphicsPipelineCreateInfoPack>    graphicsPack;
+    VkComputePipelineCreateInfo                        computeCreateInfo = {};
+    specializationConstants                            baseSpecialization;  // 仅用于计算管线
+    VkShaderStageFlags                                 stages = VK_SHADER_STAGE_ALL;
+    std::unordered_map<uint64_t, std::vector<variant>> pipelines;  // 哈希可能冲突，同一哈希下比较完整的常量
+    size_t                                             count = 0;
+
+public:
+    /**
+     * @param stages 变体的特化常量被应用到这些着色器阶段，阶段原有的特化常量被覆盖或补充
+     */
+    pipelineVariants(const graphicsPipelineCreateInfoPack& pack, VkShaderStageFlags stages = VK_SHADER_STAGE_ALL)
+        : graphicsPack(std::make_unique<graphicsPipelineCreateInfoPack>(pack)), stages(stages)
+    {
+        // 以StageCreateInfo(...)等方式直接给出的特化常量复制到创建信息包中，否则合并变体的常量时会被替换掉
+        for (size_t i = 0; i < graphicsPack->shaderStages.size(); i++)
+        {
+            const VkSpecializationInfo* pInfo = graphicsPack->shaderStages[i].pSpecializationInfo;
+            if (pInfo != nullptr && graphicsPack->Specialization(i).Empty())
+            {
+                graphicsPack->Specialization(i).Merge(*pInfo);
+            }
+        }
+        graphicsPack->UpdateAllArrays();
+    }
+    /**
+     * @param base 各变体共有的特化常量，createInfo.stage.pSpecializationInfo被忽略
+     */
+    pipelineVariants(const VkComputePipelineCreateInfo& createInfo, const specializationConstants& base = {})
+        : computeCreateInfo(createInfo), baseSpecialization(base), stages(VK_SHADER_STAGE_COMPUTE_BIT)
+    {
+    }
+
+    // Getter
+    size_t Count() const { return count; }
+
+    // Non-const Function
+    /**
+     * @brief 取得特化常量为constants的管线，不存在时创建
+     *
+     * @return VkPipeline 创建失败时返回VK_NULL_HANDLE
+     */
+    VkPipeline Get(const specializationConstants& constants)
+    {
+        uint64_t hash = constants.Hash();
+        if (auto iterator = pipelines.find(hash); iterator != pipelines.end())
+        {
+            for (auto& i : iterator->second)
+            {
+                if (i.constants == constants) { return *i.handle; }
+            }
+        }
+
+        auto newVariant = std::make_unique<pipeline>();
+        if (graphicsPack)
+        {
+            graphicsPipelineCreateInfoPack pack = *graphicsPack;
+            for (size_t i = 0; i < pack.shaderStages.size(); i++)
+            {
+                if ((pack.shaderStages[i].stage & stages) != 0U) { pack.Specialization(i).Merge(constants); }
+            }
+            pack.UpdateAllArrays();
+            if (newVariant->Create(pack) != VK_SUCCESS) { return VK_NULL_HANDLE; }
+        }
+        else
+        {
+            specializationConstants specialization = baseSpecialization;
+            specialization.Merge(constants);
+            VkComputePipelineCreateInfo createInfo = computeCreateInfo;
+            createInfo.stage.pSpecializationInfo   = specialization.Info();
+            if (newVariant->Create(createInfo) != VK_SUCCESS) { return VK_NULL_HANDLE; }
+        }
+        VkPipeline handle = *newVariant;
+        pipelines[hash].push_back({constants, std::move(newVariant)});
+        count++;
+        return handle;
+    }
+    /**
+     * @brief 销毁所有变体，须确保它们已不再被GPU使用
+     */
+    void Clear()
+    {
+        pipelines.clear();
+        count = 0;
+    }
+};
+
+/**
+ * @brief 一同创建的一批图形管线
+ * @note 一次vkCreateGraphicsPipelines(...)创建整批管线，相近的变体可派生自同一基础管线，驱动可能借此复用编译结果。
+ * 能否缩短创建时间因驱动而异，CreationTime()给出上一次Create(...)的耗时，可与逐个创建的耗时比较
+ */
+class pipelineBatch {
+    std::vector<graphicsPipelineCreateInfoPack> packs;
+    std::vector<int32_t>                        baseIndices;
+    std::vector<pipeline>                       pipelines;
+    std::chrono::duration<double, std::milli>   creationTime{};
+
+public:
+    // Getter
+    uint32_t                                  Count() const { return static_cast<uint32_t>(packs.size()); }
+    std::chrono::duration<double, std::milli> CreationTime() const { return creationTime; }
+
+    // Const Function
+    /**
+     * @return VkPipeline 尚未创建或创建失败时返回VK_NULL_HANDLE
+     */
+    VkPipeline Pipeline(uint32_t index) const { return index < pipelines.size() ? pipelines[index] : VK_NULL_HANDLE; }
+
+    // Non-const Function
+    /**
+     * @brief 添加一个管线，pack被复制，之后对其的修改不影响本批
+     * @param baseIndex 非负时，该管线派生自本批中的第baseIndex个管线，后者须先被添加
+     *
+     * @return uint32_t 该管线在本批中的索引
+     */
+    uint32_t Add(const graphicsPipelineCreateInfoPack& pack, int32_t baseIndex = -1)
+    {
+        if (baseIndex >= static_cast<int32_t>(packs.size()))
+        {
+            LOG(WARNING) << "[ pipelineBatch ] WARNING\nThe base pipeline must be added before its derivatives!";
+            baseIndex = -1;
+        }
+        auto& newPack = packs.emplace_back(pack);
+        if (baseIndex >= 0)
+        {
+            packs[baseIndex].AllowDerivatives();
+            newPack.DeriveFrom(baseIndex);
+        }
+        newPack.UpdateAllArrays();
+        baseIndices.push_back(baseIndex);
+        return Count() - 1;
+    }
+    /**
+     * @brief 创建本批的所有管线，此前创建的管线被销毁
+     * @param batched 为false时逐个创建，派生管线改以句柄指定基础管线，用于比较两种方式的耗时
+     */
+    result_t Create(bool batched = true)
+    {
+        pipelines = std::vector<pipeline>(packs.size());
+        auto     start  = std::chrono::steady_clock::now();
+        VkResult result = VK_SUCCESS;
+        if (batched)
+        {
+            std::vector<VkGraphicsPipelineCreateInfo> createInfos;
+            createInfos.reserve(packs.size());
+            for (auto& i : packs) { createInfos.push_back(i.createInfo); }
+            result = pipeline::Create(arrayRef<VkGraphicsPipelineCreateInfo>(createInfos.data(), createInfos.size()),
+                                      {pipelines.data(), pipelines.size()});
+        }
+        else
+        {
+            for (size_t i = 0; i < packs.size(); i++)
+            {
+                VkGraphicsPipelineCreateInfo createInfo = packs[i].createInfo;
+                if (baseIndices[i] >= 0)
+                {
+                    createInfo.basePipelineHandle = pipelines[baseIndices[i]];
+                    createInfo.basePipelineIndex  = -1;
+                }
+                if (VkResult r = pipelines[i].Create(createInfo); r != VK_SUCCESS) { result = r; }
+            }
+        }
+        creationTime = std::chrono::steady_clock::now() - start;
+        return result;
+    }
+    /**
+     * @brief 清空本批，已创建的管线被销毁，须确保它们已不再被GPU使用
+     */
+    void Clear()
+    {
+        packs.clear();
+        baseIndices.clear();
+        pipelines.clear();
+    }
+};
+
+/**
+ * @brief 对GraphicsBase的补充，提供加载资源时所需的命令池和一次性提交命令缓冲区的功能
+ * @note 首次调用Plus()时才会创建命令池，因此须在创建逻辑设备之后使用
+ */
+class graphicsBasePlus {
+    commandPool   commandPool_graphics;
+    commandBuffer commandBuffer_transfer;
+
+    graphicsBasePlus()
+    {
+        commandPool_graphics.Create(GraphicsBase::Base().QueueFamilyIndex_Graphics(),
+                                    VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+        commandPool_graphics.AllocateBuffers(commandBuffer_transfer);
+    }
+
+public:
+    graphicsBasePlus(const graphicsBasePlus&)            = delete;
+    graphicsBasePlus& operator=(const graphicsBasePlus&) = delete;
+
+    static graphicsBasePlus& Plus()
+    {
+        static graphicsBasePlus plus;
+        return plus;
     }
-};
\ No newline at end of file
+
+    // Getter
+    const commandPool&   CommandPool_Graphics() const { return commandPool_graphics; }
+    const commandBuffer& CommandBuffer_Transfer() const { return commandBuffer_transfer; }
+
+    // Const Function
+    /**
+     * @brief 将命令缓冲区提交到图形队列，并等待其执行完毕
+     */
+    result_t ExecuteCommandBuffer_Graphics(VkCommandBuffer commandBuffer) const
+    {
+        fence        fence;
+        VkSubmitInfo submitInfo = {
+            .commandBufferCount = 1,
+            .pCommandBuffers    = &commandBuffer,
+        };
+        VkResult result = GraphicsBase::Base().SubmitCommandBuffer_Graphics(submitInfo, fence);
+        if (result == VK_SUCCESS) { result = fence.Wait(); }
+        return result;
+    }
+};
+
+/**
+ * @brief 暂存缓冲区，用于把数据从CPU一侧搬运到device local的缓冲区或图像
+ * @note 容量不足时自动重新分配，只增不减
+ */
+class stagingBuffer {
+protected:
+    vulkan::bufferMemory bufferMemory;
+    VkDeviceSize         memoryUsage = 0;
+
+public:
+    stagingBuffer() = default;
+    stagingBuffer(VkDeviceSize size) { Expand(size); }
+
+    // Getter
+    operator VkBuffer() const { return bufferMemory.Buffer(); }
+    const VkBuffer* Address() const { return bufferMemory.AddressOfBuffer(); }
+    VkDeviceSize    AllocationSize() const { return bufferMemory.AllocationSize(); }
+
+    // Const Function
+    void RetrieveData(void* pData_dst, VkDeviceSize size) const { bufferMemory.RetrieveData(pData_dst, size); }
+
+    // Non-const Function
+    void Expand(VkDeviceSize size)
+    {
+        if (size <= AllocationSize()) { return; }
+        Release();
+        VkBufferCreateInfo bufferCreateInfo = {
+            .size  = size,
+            .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        };
+        bufferMemory.Create(bufferCreateInfo, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+    }
+    void Release() { bufferMemory.~bufferMemory(); }
+    /**
+     * @brief 映射暂存缓冲区，调用者直接向返回的地址写入数据，写完后须调用UnmapMemory()
+     */
+    void* MapMemory(VkDeviceSize size)
+    {
+        Expand(size);
+        void* pData_dst = nullptr;
+        bufferMemory.MapMemory(pData_dst, size);
+        memoryUsage = size;
+        return pData_dst;
+    }
+    void UnmapMemory()
+    {
+        bufferMemory.UnmapMemory(memoryUsage);
+        memoryUsage = 0;
+    }
+    void BufferData(const void* pData_src, VkDeviceSize size)
+    {
+        Expand(size);
+        bufferMemory.BufferData(pData_src, size);
+    }
+
+    // Static Function
+    // 主线程所用的暂存缓冲区，在逻辑设备销毁前随静态对象一并析构
+    static stagingBuffer& MainThread()
+    {
+        static stagingBuffer stagingBuffer_mainThread;
+        return stagingBuffer_mainThread;
+    }
+};
+
+/**
+ * @brief 设备本地的缓冲区，用于顶点、索引等很少在CPU一侧更新的数据
+ */
+class deviceLocalBuffer {
+protected:
+    vulkan::bufferMemory bufferMemory;
+
+public:
+    deviceLocalBuffer() = default;
+    deviceLocalBuffer(VkDeviceSize size, VkBufferUsageFlags desiredUsages_Without_transfer_dst)
+    {
+        Create(size, desiredUsages_Without_transfer_dst);
+    }
+
+    // Getter
+    operator VkBuffer() const { return bufferMemory.Buffer(); }
+    const VkBuffer* Address() const { return bufferMemory.AddressOfBuffer(); }
+    VkDeviceSize    AllocationSize() const { return bufferMemory.AllocationSize(); }
+    bool            IsHostVisible() const
+    {
+        return (bufferMemory.MemoryProperties() & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0U;
+    }
+
+    // Const Function
+    /**
+     * @brief 向缓冲区写入数据，若内存不是host visible的，则经由主线程的暂存缓冲区转移
+     */
+    void TransferData(const void* pData_src, VkDeviceSize size, VkDeviceSize offset = 0) const
+    {
+        if (IsHostVisible())
+        {
+            bufferMemory.BufferData(pData_src, size, offset);
+            return;
+        }
+        stagingBuffer::MainThread().BufferData(pData_src, size);
+        const auto&  commandBuffer = graphicsBasePlus::Plus().CommandBuffer_Transfer();
+        VkBufferCopy region        = {0, offset, size};
+        commandBuffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        vkCmdCopyBuffer(commandBuffer, stagingBuffer::MainThread(), bufferMemory.Buffer(), 1, &region);
+        commandBuffer.End();
+        graphicsBasePlus::Plus().ExecuteCommandBuffer_Graphics(commandBuffer);
+    }
+    void CmdUpdateBuffer(VkCommandBuffer commandBuffer,
+                         const void*     pData_src,
+                         VkDeviceSize    size_Limited_to_65536,
+                         VkDeviceSize    offset = 0) const
+    {
+        vkCmdUpdateBuffer(commandBuffer, bufferMemory.Buffer(), offset, size_Limited_to_65536, pData_src);
+    }
+
+    // Non-const Function
+    /**
+     * @brief 创建缓冲区，优先使用同时device local和host visible的内存（即ReBAR/UMA），以省去暂存的开销
+     */
+    result_t Create(VkDeviceSize size, VkBufferUsageFlags desiredUsages_Without_transfer_dst)
+    {
+        VkBufferCreateInfo bufferCreateInfo = {
+            .size  = size,
+            .usage = desiredUsages_Without_transfer_dst | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        };
+        if (result_t result = bufferMemory.CreateBuffer(bufferCreateInfo)) { return result; }
+        if (bufferMemory.AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) !=
+            VK_SUCCESS)
+        {
+            if (result_t result = bufferMemory.AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) { return result; }
+        }
+        return bufferMemory.BindMemory();
+    }
+    result_t Recreate(VkDeviceSize size, VkBufferUsageFlags desiredUsages_Without_transfer_dst)
+    {
+        GraphicsBase::Base().WaitIdle();  // deviceLocalBuffer封装的缓冲区可能会在每一帧中被频繁使用，重建它之前应确保物理设备没有在使用它
+        bufferMemory.~bufferMemory();
+        return Create(size, desiredUsages_Without_transfer_dst);
+    }
+};
+
+}  // namespace vulkan
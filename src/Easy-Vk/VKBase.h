@@ -1,11 +1,23 @@
 #pragma once
 #include "EasyVKStart.h"
+#include "ShaderRegistry.h"
+#include <algorithm>
 #include <array>
 #include <cstdint>
+#include <atomic>
+#include <deque>
 #include <functional>
+#include <mutex>
 #include <vector>
 #include <vulkan/vulkan_core.h>
 
+#ifndef _WIN32
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
 /**
  * @brief 定义vulkan命名空间，之后会把Vulkan中一些基本对象的封装写在其中
  *
@@ -167,6 +179,7 @@ private:
     VkPhysicalDeviceMemoryProperties   physicalDeviceMemoryProperties{};
     std::vector<VkPhysicalDevice>      availablePhysicalDevices;
     std::vector<const char*>           deviceExtensions;
+    std::vector<VkBaseOutStructure*>   deviceFeatures;  // 扩展的特性结构体，创建逻辑设备时以pNext链接
     std::vector<std::function<void()>> callbacks_createDevice;
     std::vector<std::function<void()>> callbacks_destroyDevice;
 
@@ -192,12 +205,32 @@ private:
         .pNext = nullptr,
         .flags = 0,
     };  // 保存交换链的创建信息以便重建交换链
+    uint32_t                           requestedSwapchainImageCount = 0;  // 为0时使用默认的图像数量
     std::vector<std::function<void()>> callbacks_createSwapchain;
     std::vector<std::function<void()>> callbacks_destroySwapchain;
 
     // rendering loop
     uint32_t currentImageIndex = 0;
 
+    // Deferred Destruction
+    struct retiredObject
+    {
+        uint64_t              frame;      // 序号小于该值的帧都执行完毕后才销毁
+        VkSwapchainKHR        swapchain;  // 旧交换链，还须等到呈现到它的呈现栅栏都被置位
+        std::function<void()> destroy;
+    };
+    std::deque<retiredObject>                       retiredObjects;              // 队首的对象未到期时，其后的对象也暂不销毁
+    uint64_t                                        frameCount             = 0;  // 已呈现的帧数，即当前帧的序号
+    uint64_t                                        completedFrameCount    = 0;  // 已在GPU上执行完毕的帧数
+    bool                                            frameCompletionTracked = false;
+    bool                                            swapchainMaintenance1  = false;
+    std::vector<std::pair<VkFence, VkSwapchainKHR>> presentFences;  // 尚未确认被置位的呈现栅栏及其交换链
+    std::vector<VkFence>                            freePresentFences;
+    // 由AddSwapchainMaintenance1Features()加入设备特性，创建逻辑设备后记录该特性是否被开启
+    VkPhysicalDeviceSwapchainMaintenance1FeaturesEXT swapchainMaintenance1Features = {
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SWAPCHAIN_MAINTENANCE_1_FEATURES_EXT,
+    };
+
     // ANCHOR - Private Function
 
     GraphicsBase()                               = default;
@@ -212,6 +245,7 @@ private:
         if (device != nullptr)
         {
             WaitIdle();
+            WaitPresentFences();  // 当前交换链也可能仍被呈现引擎使用
             if (swapchain != nullptr)
             {
                 for (auto& i : callbacks_destroySwapchain) { i(); }
@@ -221,6 +255,7 @@ private:
                 }
                 vkDestroySwapchainKHR(device, swapchain, nullptr);
             }
+            DestroyRetiredObjects();
             for (auto& i : callbacks_destroyDevice) { i(); }
             vkDestroyDevice(device, nullptr);
         }
@@ -343,6 +378,25 @@ private:
         return VK_SUCCESS;
     }
 
+    /**
+     * @brief 按请求的图像数量和表面的限制确定交换链图像的最少数量
+     */
+    uint32_t SwapchainMinImageCount(const VkSurfaceCapabilitiesKHR& surfaceCapabilities) const
+    {
+        /*
+        未请求时，如果容许的最大数量与最小数量不等，那么使用最小数量+1，
+        一般VkSurfaceCapabilitiesKHR::minImageCount会是2，多一张图像可以实现三重缓冲。
+        maxImageCount为0表示没有上限
+        */
+        if (requestedSwapchainImageCount == 0)
+        {
+            return surfaceCapabilities.minImageCount +
+                   static_cast<uint32_t>(surfaceCapabilities.maxImageCount > surfaceCapabilities.minImageCount);
+        }
+        uint32_t count = std::max(requestedSwapchainImageCount, surfaceCapabilities.minImageCount);
+        if (surfaceCapabilities.maxImageCount != 0) { count = std::min(count, surfaceCapabilities.maxImageCount); }
+        return count;
+    }
     /**
      * @brief 该函数被CreateSwapchain(...)和RecreateSwapchain()调用
      */
@@ -388,6 +442,85 @@ private:
         }
         return VK_SUCCESS;
     }
+    /**
+     * @brief 取得一个未置位的栅栏，供VK_EXT_swapchain_maintenance1在呈现时置位
+     */
+    VkFence AcquirePresentFence()
+    {
+        if (!freePresentFences.empty())
+        {
+            VkFence fence = freePresentFences.back();
+            freePresentFences.pop_back();
+            return fence;
+        }
+        VkFenceCreateInfo fenceCreateInfo = {VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+        VkFence           fence           = VK_NULL_HANDLE;
+        if (VkResult result = vkCreateFence(device, &fenceCreateInfo, nullptr, &fence))
+        {
+            LOG(ERROR) << "[ graphicsBase ] ERROR\nFailed to create a present fence!\nError code: "
+                       << static_cast<int32_t>(result);
+            return VK_NULL_HANDLE;
+        }
+        return fence;
+    }
+    /**
+     * @brief 回收已置位的呈现栅栏，销毁删除队列中已不再被使用的对象
+     */
+    void RetireObjects()
+    {
+        for (size_t i = 0; i < presentFences.size();)
+        {
+            VkFence fence = presentFences[i].first;
+            if (vkGetFenceStatus(device, fence) != VK_SUCCESS)
+            {
+                i++;
+                continue;
+            }
+            vkResetFences(device, 1, &fence);
+            freePresentFences.push_back(fence);
+            presentFences[i] = presentFences.back();
+            presentFences.pop_back();
+        }
+        while (!retiredObjects.empty())
+        {
+            retiredObject& object = retiredObjects.front();
+            if (object.frame > completedFrameCount) { break; }
+            if (object.swapchain != VK_NULL_HANDLE &&
+                std::any_of(presentFences.begin(), presentFences.end(),
+                            [&object](const auto& i) { return i.second == object.swapchain; }))
+            {
+                break;
+            }
+            object.destroy();
+            retiredObjects.pop_front();
+        }
+    }
+    /**
+     * @brief 等待所有尚未确认的呈现栅栏
+     */
+    void WaitPresentFences() const
+    {
+        // 呈现栅栏由呈现引擎置位，不受逻辑设备闲置的约束，设超时以免呈现引擎出错时卡住
+        std::vector<VkFence> fences;
+        for (auto& i : presentFences) { fences.push_back(i.first); }
+        if (!fences.empty())
+        {
+            vkWaitForFences(device, static_cast<uint32_t>(fences.size()), fences.data(), VK_TRUE, 1'000'000'000);
+        }
+    }
+    /**
+     * @brief 销毁删除队列中的所有对象和呈现栅栏，须已等待逻辑设备闲置
+     */
+    void DestroyRetiredObjects()
+    {
+        WaitPresentFences();
+        for (auto& i : retiredObjects) { i.destroy(); }
+        retiredObjects.clear();
+        for (auto& i : presentFences) { vkDestroyFence(device, i.first, nullptr); }
+        for (auto i : freePresentFences) { vkDestroyFence(device, i, nullptr); }
+        presentFences.clear();
+        freePresentFences.clear();
+    }
 
 public:
     /**
@@ -412,6 +545,12 @@ public:
         swapchainImageViews.resize(0);
         swapchainCreateInfo = {};
         debugUtilsMessenger = VK_NULL_HANDLE;
+
+        frameCount                    = 0;
+        completedFrameCount           = 0;
+        frameCompletionTracked        = false;
+        swapchainMaintenance1         = false;
+        swapchainMaintenance1Features = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SWAPCHAIN_MAINTENANCE_1_FEATURES_EXT};
         /*
         对于需要在运行过程中切换图形API的情况，我更推荐你单独写一个专用的函数，销毁其他
         对象但保留Vulkan实例，原因在于创建Vulkan实例是初始化过程中最耗时的一步（Release
@@ -460,6 +599,8 @@ public:
     const VkSwapchainCreateInfoKHR& SwapchainCreateInfo() const { return swapchainCreateInfo; }
 
     uint32_t CurrentImageIndex() const { return currentImageIndex; }
+    uint64_t FrameCount() const { return frameCount; }
+    bool     SwapchainMaintenance1() const { return swapchainMaintenance1; }
 
     // ANCHOR - Setter
 
@@ -508,7 +649,69 @@ public:
         if (swapchain != nullptr) { return RecreateSwapchain(); }
         return VK_SUCCESS;
     }
+    /**
+     * @brief 在运行时切换呈现模式，交换链已存在时重建交换链
+     * @note 在CreateSwapchain(...)前调用时，其选择会被CreateSwapchain(...)按limitFrameRate覆盖
+     */
+    result_t SetPresentMode(VkPresentModeKHR presentMode)
+    {
+        uint32_t surfacePresentModeCount = 0;
+        if (result_t result =
+                vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, surface, &surfacePresentModeCount, nullptr))
+        {
+            LOG(ERROR) << "[ graphicsBase ] ERROR\nFailed to get the count of surface present modes!\nError code: "
+                       << static_cast<int32_t>(result);
+            return result;
+        }
+        std::vector<VkPresentModeKHR> surfacePresentModes(surfacePresentModeCount);
+        if (result_t result = vkGetPhysicalDeviceSurfacePresentModesKHR(
+                physicalDevice, surface, &surfacePresentModeCount, surfacePresentModes.data()))
+        {
+            LOG(ERROR) << "[ graphicsBase ] ERROR\nFailed to get surface present modes!\nError code: "
+                       << static_cast<int32_t>(result);
+            return result;
+        }
+        // 如果表面不支持该呈现模式，恰好有个语义相符的错误代码
+        if (std::find(surfacePresentModes.begin(), surfacePresentModes.end(), presentMode) ==
+            surfacePresentModes.end())
+        {
+            return VK_ERROR_FEATURE_NOT_PRESENT;
+        }
+        if (swapchainCreateInfo.presentMode == presentMode) { return VK_SUCCESS; }
+        swapchainCreateInfo.presentMode = presentMode;
+        if (swapchain != nullptr) { return RecreateSwapchain(); }
+        return VK_SUCCESS;
+    }
+    /**
+     * @brief 指定交换链图像的数量，会被限制在表面容许的范围内，为0时恢复默认，交换链已存在时重建交换链
+     */
+    result_t SetSwapchainImageCount(uint32_t count)
+    {
+        if (requestedSwapchainImageCount == count) { return VK_SUCCESS; }
+        requestedSwapchainImageCount = count;
+        if (swapchain != nullptr) { return RecreateSwapchain(); }
+        return VK_SUCCESS;
+    }
     void AddDeviceExtension(const char* extensionName) { AddLayerOrExtension(deviceExtensions, extensionName); }
+    /**
+     * @brief 添加扩展的特性结构体，如VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT
+     * @note 结构体须设置好sType，且生命周期须长于逻辑设备；CreateDevice()查询物理设备支持的特性并将其全部开启，
+     * 之后可从结构体中读取哪些特性被开启了。对应的扩展须已开启，且须使用Vulkan1.1及以上版本
+     */
+    void AddDeviceFeatures(void* pFeatures)
+    {
+        auto* pStructure = static_cast<VkBaseOutStructure*>(pFeatures);
+        // 重复添加会使pNext链成环
+        if (std::find(deviceFeatures.begin(), deviceFeatures.end(), pStructure) == deviceFeatures.end())
+        {
+            deviceFeatures.push_back(pStructure);
+        }
+    }
+    /**
+     * @brief 添加VK_EXT_swapchain_maintenance1的特性结构体，开启后以呈现栅栏判断旧交换链何时可被销毁
+     * @note 须在CreateDevice()之前调用，该设备级扩展须已添加
+     */
+    void AddSwapchainMaintenance1Features() { AddDeviceFeatures(&swapchainMaintenance1Features); }
     void DeviceExtensions(const std::vector<const char*>& extensionNames) { deviceExtensions = extensionNames; }
     void AddCallback_CreateDevice(std::function<void()>& function) { callbacks_createDevice.push_back(function); }
     void AddCallback_DestroyDevice(std::function<void()>& function) { callbacks_destroyDevice.push_back(function); }
@@ -517,6 +720,24 @@ public:
     {
         callbacks_destroySwapchain.push_back(function);
     }
+    /**
+     * @brief 推迟销毁可能仍被GPU使用的对象，在当前帧之前的帧都执行完毕后调用destroy
+     * @note 重建交换链时，销毁交换链的回调函数应将旧的帧缓冲等对象移入destroy中，而非立即销毁
+     */
+    void DeferDestruction(std::function<void()> destroy)
+    {
+        retiredObjects.push_back({frameCount, VK_NULL_HANDLE, std::move(destroy)});
+    }
+    /**
+     * @brief 告知序号小于count的帧都已在GPU上执行完毕（如等待了这些帧的栅栏之后），并销毁不再被使用的对象
+     * @note 一经调用，RecreateSwapchain()便不再等待队列闲置，因此须在每帧等待栅栏后调用
+     */
+    void FramesCompleted(uint64_t count)
+    {
+        frameCompletionTracked = true;
+        completedFrameCount    = std::max(completedFrameCount, count);
+        RetireObjects();
+    }
 
     // ANCHOR - General Vulkan Setting
 
@@ -886,6 +1107,20 @@ public:
         // 获取物理设备特性
         VkPhysicalDeviceFeatures physicalDeviceFeatures;  // 这里获取到的是Vulkan1.0的特性
         vkGetPhysicalDeviceFeatures(physicalDevice, &physicalDeviceFeatures);
+        // 扩展的特性以VkPhysicalDeviceFeatures2的pNext链查询，此时pEnabledFeatures须为nullptr
+        VkPhysicalDeviceFeatures2 physicalDeviceFeatures2 = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2};
+        bool                      useFeatures2            = apiVersion >= VK_API_VERSION_1_1 && !deviceFeatures.empty();
+        if (useFeatures2)
+        {
+            VkBaseOutStructure* pNext = nullptr;
+            for (auto i = deviceFeatures.rbegin(); i != deviceFeatures.rend(); ++i)
+            {
+                (*i)->pNext = pNext;
+                pNext       = *i;
+            }
+            physicalDeviceFeatures2.pNext = pNext;
+            vkGetPhysicalDeviceFeatures2(physicalDevice, &physicalDeviceFeatures2);
+        }
 
         VkDeviceCreateInfo deviceCreateInfo = {
             .sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
@@ -896,6 +1131,11 @@ public:
             .ppEnabledExtensionNames = deviceExtensions.data(),
             .pEnabledFeatures        = &physicalDeviceFeatures,
         };
+        if (useFeatures2)
+        {
+            deviceCreateInfo.pNext            = &physicalDeviceFeatures2;
+            deviceCreateInfo.pEnabledFeatures = nullptr;
+        }
         if (result_t result = vkCreateDevice(physicalDevice, &deviceCreateInfo, nullptr, &device))
         {
             LOG(ERROR) << "[ graphicsBase ] ERROR\nFailed to create a vulkan logical device!";
@@ -926,13 +1166,65 @@ public:
         return VK_SUCCESS;
     }
 
-    result_t CheckDeviceExtensions(const std::vector<const char*>& extensionsToCheck,
-                                   const char*                     layerName = nullptr) const
+    /**
+     * @brief 将传入中当前物理设备不支持的扩展设置为nullptr，须在DeterminePhysicalDevice(...)之后调用
+     *
+     * @return VkResult 返回值则指示在获取可用扩展列表时是否发生错误。
+     */
+    result_t CheckDeviceExtensions(std::vector<const char*>& extensionsToCheck, const char* layerName = nullptr) const
     {
-        // TODO - /*待Ch1-3填充*/
+        uint32_t                           extensionCount = 0;
+        std::vector<VkExtensionProperties> availableExtensions;
+        if (result_t result = vkEnumerateDeviceExtensionProperties(physicalDevice, layerName, &extensionCount, nullptr))
+        {
+            LOG(ERROR) << "[ graphicsBase ] ERROR\nFailed to get the count of device extensions!\nError code: "
+                       << static_cast<int32_t>(result);
+            return result;
+        }
+
+        if (extensionCount != 0U)
+        {
+            availableExtensions.resize(extensionCount);
+            if (result_t result = vkEnumerateDeviceExtensionProperties(physicalDevice, layerName, &extensionCount,
+                                                                       availableExtensions.data()))
+            {
+                LOG(ERROR) << "[ graphicsBase ] ERROR\nFailed to enumerate device extension properties!\nError code: "
+                           << static_cast<int32_t>(result);
+                return result;
+            }
+
+            for (auto& i : extensionsToCheck)
+            {
+                bool found = false;
+                for (auto& j : availableExtensions)
+                {
+                    if (strcmp(i, static_cast<char*>(j.extensionName)) == 0)
+                    {
+                        found = true;
+                        break;
+                    }
+                }
+                if (!found) { i = nullptr; }
+            }
+        }
+        else
+        {
+            for (auto& i : extensionsToCheck) { i = nullptr; }
+        }
 
         return VK_SUCCESS;
     }
+    /**
+     * @brief 扩展是否在创建逻辑设备时被开启
+     */
+    bool DeviceExtensionEnabled(const char* extensionName) const
+    {
+        for (auto i : deviceExtensions)
+        {
+            if (strcmp(i, extensionName) == 0) { return true; }
+        }
+        return false;
+    }
 
     /**
      * @brief 该函数用于等待逻辑设备空闲
@@ -976,13 +1268,9 @@ public:
         /* 配置交换链
         对于交换链图像的数量，尽量不要太少，避免阻塞（所谓阻塞，即当需要渲染一张新图像时，
         所有交换链图像不是正在被呈现引擎读取就是正在被渲染），但也不要太多，避免多余的显存开销。
-
-        于是，如果容许的最大数量与最小数量不等，那么使用最小数量+1
-        一般VkSurfaceCapabilitiesKHR::minImageCount会是2，多一张图像可以实现三重缓冲。
+        注重延迟的程序可以SetSwapchainImageCount(...)减少图像数量，从而减少排队等待呈现的帧。
         */
-        swapchainCreateInfo.minImageCount =
-            surfaceCapabilities.minImageCount +
-            static_cast<uint32_t>(surfaceCapabilities.maxImageCount > surfaceCapabilities.minImageCount);
+        swapchainCreateInfo.minImageCount = SwapchainMinImageCount(surfaceCapabilities);
         swapchainCreateInfo.imageExtent =
             (surfaceCapabilities.currentExtent.width == -1) ?
                 VkExtent2D{glm::clamp(defaultWindowSize.width, surfaceCapabilities.minImageExtent.width,
@@ -1116,6 +1404,10 @@ public:
             }
         }
 
+        // 开启了VK_EXT_swapchain_maintenance1时，以呈现栅栏判断旧交换链何时可被销毁
+        swapchainMaintenance1 = DeviceExtensionEnabled(VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME) &&
+                                swapchainMaintenance1Features.swapchainMaintenance1 != VK_FALSE;
+
         // 填写剩余的参数
         swapchainCreateInfo.surface          = surface;
         swapchainCreateInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
@@ -1150,54 +1442,62 @@ public:
             执行视为不完全成功返回VK_SUBOPTIMAL_KHR
             */
         }
-        swapchainCreateInfo.imageExtent  = surfaceCapabilities.currentExtent;
-        swapchainCreateInfo.oldSwapchain = swapchain;  // 有利于重用一些资源
+        swapchainCreateInfo.imageExtent   = surfaceCapabilities.currentExtent;
+        swapchainCreateInfo.minImageCount = SwapchainMinImageCount(surfaceCapabilities);
+        swapchainCreateInfo.oldSwapchain  = swapchain;  // 有利于重用一些资源
 
         /*
-        在重建交换链前，须确保程序没有正在使用旧的交换链，在渲染循环（rendering loop）中，
-        交换链的使用并没有明确的停滞时机，因此需要等待逻辑设备闲置，或者更精细点，等待图形
-        和呈现队列闲置（交换链图像被图形队列写入，被呈现队列读取），这么一来计算队列就可以
-        在重建交换链时继续其任务
+        旧的交换链、image view、帧缓冲等可能仍被尚未执行完毕的帧使用，它们被移入删除队列，
+        待使用它们的帧执行完毕后才销毁，这样重建交换链时不必等待GPU闲置，拖动窗口大小时不会每帧卡顿。
+        帧的完成由FramesCompleted(...)告知（如framePacer在等待每个即时帧的栅栏后），
+        未告知时无从判断，只能等待图形和呈现队列闲置（交换链图像被图形队列写入，被呈现队列读取），
+        这么一来计算队列仍可以在重建交换链时继续其任务
         */
-        result_t result = vkQueueWaitIdle(queue_graphics);
-        // 仅在等待图形队列成功，且图形与呈现所用队列不同时等待呈现队列
-        if ((result == VK_SUCCESS) && queue_graphics != queue_presentation)
+        if (!frameCompletionTracked)
         {
-            result = vkQueueWaitIdle(queue_presentation);
-        }
-        if (result != VK_SUCCESS)
-        {
-            LOG(ERROR) << "[ graphicsBase ] ERROR\nFailed to wait for the queue to be idle!\nError code: "
-                       << static_cast<int32_t>(result);
-            return result;
+            result_t result = vkQueueWaitIdle(queue_graphics);
+            // 仅在等待图形队列成功，且图形与呈现所用队列不同时等待呈现队列
+            if ((result == VK_SUCCESS) && queue_graphics != queue_presentation)
+            {
+                result = vkQueueWaitIdle(queue_presentation);
+            }
+            if (result != VK_SUCCESS)
+            {
+                LOG(ERROR) << "[ graphicsBase ] ERROR\nFailed to wait for the queue to be idle!\nError code: "
+                           << static_cast<int32_t>(result);
+                return result;
+            }
+            completedFrameCount = frameCount;
         }
 
-        // TODO - /*待后续填充*/
-
-        // 用vkDestroyImageView(...)销毁旧有的image view
-        for (auto& i : swapchainImageViews)
-        {
-            if (i != nullptr) { vkDestroyImageView(device, i, nullptr); }
-        }
-        swapchainImageViews.resize(0);
+        // 销毁旧交换链相关对象，回调函数应以DeferDestruction(...)推迟销毁
+        for (auto& i : callbacks_destroySwapchain) { i(); }
+        auto oldImageViews = std::make_shared<std::vector<VkImageView>>(std::move(swapchainImageViews));
+        swapchainImageViews.clear();
+        DeferDestruction([this, oldImageViews] {
+            for (auto i : *oldImageViews)
+            {
+                if (i != nullptr) { vkDestroyImageView(device, i, nullptr); }
+            }
+        });
         /*
-        值得注意的是，这里只销毁了image view，而没销毁其对应的交换链图像，这是因为在销毁
-        旧交换链时会被一并销毁交换链图像。而尽管图形和呈现队列都没有在使用旧图像，无法确
-        保呈现引擎在CPU上做的操作或不会使用旧图像，因此销毁旧交换链的时机需要延后，之后
-        会在Ch2-1 Rendering Loop中进行相应处理。
+        旧交换链的图像随旧交换链一并销毁。尽管使用过旧图像的帧执行完毕后，图形队列不再使用它们，
+        呈现引擎在CPU上做的操作仍可能使用旧图像，开启了VK_EXT_swapchain_maintenance1时，
+        还须等到呈现到旧交换链的呈现栅栏都被置位，否则只能以使用它的帧执行完毕为准，
+        为此多等一帧，即当前帧也执行完毕后才销毁。
+        即便新交换链创建失败，旧交换链也已退役，因此先将其移入删除队列
         */
-
-        // 销毁旧交换链相关对象
-        for (auto& i : callbacks_destroySwapchain) { i(); }
-        for (auto& i : swapchainImageViews)
-        {
-            if (i != nullptr) { vkDestroyImageView(device, i, nullptr); }
-        }
-        swapchainImageViews.resize(0);
-
-        // 创建新交换链及与之相关的对象
-        if (result_t result = CreateSwapchain_Internal()) { return result; }
+        VkSwapchainKHR oldSwapchain = swapchainCreateInfo.oldSwapchain;
+        retiredObjects.push_back({frameCount + 1, oldSwapchain,
+                                  [this, oldSwapchain] { vkDestroySwapchainKHR(device, oldSwapchain, nullptr); }});
+
+        // 创建新交换链及与之相关的对象，失败时swapchain为空，旧交换链只由删除队列销毁
+        swapchain                        = VK_NULL_HANDLE;
+        result_t result                  = CreateSwapchain_Internal();
+        swapchainCreateInfo.oldSwapchain = VK_NULL_HANDLE;
+        if (result != VK_SUCCESS) { return result; }
         for (auto& i : callbacks_createSwapchain) { i(); }
+        RetireObjects();  // 若等待了队列闲置，除旧交换链外的对象在此即被销毁
         return VK_SUCCESS;
     }
 
@@ -1209,17 +1509,13 @@ public:
      */
     result_t SwapImage(VkSemaphore semaphore_imageIsAvailable)
     {
-        // 销毁旧交换链（若存在）
-        if ((swapchainCreateInfo.oldSwapchain != nullptr) && swapchainCreateInfo.oldSwapchain != swapchain)
-        {
-            vkDestroySwapchainKHR(device, swapchainCreateInfo.oldSwapchain, nullptr);
-            swapchainCreateInfo.oldSwapchain = VK_NULL_HANDLE;
-        }
         /*
-        如之前在Ch1-4 创建交换链中所说，不能在重建交换链后立刻销毁旧交换链。SwapImage(...)
-        中的逻辑是，若在当前帧重建交换链，那么在下一帧销毁交换链（这也是为什么重建交换链后
-        使用了break来再次执行while，而非递归地调用SwapImage(...)）。
+        销毁删除队列中不再被使用的对象（包括旧交换链）。
+        未以FramesCompleted(...)告知帧的完成时，视调用者在此之前已等待了上一帧的栅栏（如只用一个栅栏的渲染循环），
+        于是若在当前帧重建交换链，旧交换链在下一帧或再下一帧被销毁
         */
+        if (!frameCompletionTracked) { completedFrameCount = frameCount; }
+        RetireObjects();
 
         // 获取交换链图像索引
         while (VkResult result = vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, semaphore_imageIsAvailable,
@@ -1346,7 +1642,36 @@ public:
     result_t PresentImage(VkPresentInfoKHR& presentInfo)
     {
         presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-        switch (VkResult result = vkQueuePresentKHR(queue_presentation, &presentInfo))
+        // 开启了VK_EXT_swapchain_maintenance1时附上呈现栅栏，据此判断旧交换链何时不再被呈现引擎使用
+        VkSwapchainPresentFenceInfoEXT presentFenceInfo = {VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_FENCE_INFO_EXT};
+        VkFence                        presentFence     = VK_NULL_HANDLE;
+        if (swapchainMaintenance1 && presentInfo.swapchainCount == 1) { presentFence = AcquirePresentFence(); }
+        if (presentFence != VK_NULL_HANDLE)
+        {
+            presentFenceInfo.pNext          = presentInfo.pNext;
+            presentFenceInfo.swapchainCount = 1;
+            presentFenceInfo.pFences        = &presentFence;
+            presentInfo.pNext               = &presentFenceInfo;
+        }
+        VkResult result = vkQueuePresentKHR(queue_presentation, &presentInfo);
+        if (presentFence != VK_NULL_HANDLE)
+        {
+            presentInfo.pNext = presentFenceInfo.pNext;
+            // 仅这些返回值下呈现操作被视为已入队，栅栏会被置位；其他错误（如设备丢失）下栅栏不会被置位
+            switch (result)
+            {
+                case VK_SUCCESS:
+                case VK_SUBOPTIMAL_KHR:
+                case VK_ERROR_OUT_OF_DATE_KHR:
+                case VK_ERROR_SURFACE_LOST_KHR:
+                case VK_ERROR_FULL_SCREEN_EXCLUSIVE_MODE_LOST_EXT:
+                    presentFences.emplace_back(presentFence, presentInfo.pSwapchains[0]);
+                    break;
+                default: freePresentFences.push_back(presentFence); break;
+            }
+        }
+        frameCount++;
+        switch (result)
         {
             case VK_SUCCESS: {
                 return VK_SUCCESS;
@@ -1729,94 +2054,383 @@ public:
 };
 
 /**
- * @brief 着色器模块
+ * @brief 以FNV-1a算法计算一段字节的64位哈希值
+ * @note 用于判断缓存文件是否与源文件对应，不具备密码学强度
  */
-class shaderModule {
-    VkShaderModule handle = VK_NULL_HANDLE;
+inline uint64_t HashBytes(const void* pData, size_t size, uint64_t seed = 0xcbf29ce484222325ULL)
+{
+    const auto* pBytes = static_cast<const uint8_t*>(pData);
+    uint64_t    hash   = seed;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= pBytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief 只读的内存映射文件
+ * @note 文件内容由操作系统按页调入，读取时不需要先复制到std::vector之类的容器中，
+ * 映射在对象析构时解除，因此从Data()取得的指针只在对象存活期间有效。
+ */
+class mappedFile {
+    const uint8_t* pData = nullptr;
+    size_t         size  = 0;
+#ifdef _WIN32
+    HANDLE file    = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
 
 public:
-    shaderModule() = default;
-    shaderModule(VkShaderModuleCreateInfo& createInfo) { Create(createInfo); }
-    shaderModule(const char* filepath /*VkShaderModuleCreateFlags flags*/) { Create(filepath); }
-    shaderModule(size_t codeSize, const uint32_t* pCode /*VkShaderModuleCreateFlags flags*/)
-    {
-        Create(codeSize, pCode);
+    mappedFile() = default;
+    mappedFile(const char* filepath) { Open(filepath); }
+    mappedFile(mappedFile&& other) noexcept { *this = std::move(other); }
+    mappedFile& operator=(mappedFile&& other) noexcept
+    {
+        if (this == &other) { return *this; }
+        Close();
+        pData = other.pData;
+        size  = other.size;
+#ifdef _WIN32
+        file          = other.file;
+        mapping       = other.mapping;
+        other.file    = INVALID_HANDLE_VALUE;
+        other.mapping = nullptr;
+#endif
+        other.pData = nullptr;
+        other.size  = 0;
+        return *this;
     }
-    shaderModule(shaderModule&& other) noexcept { MoveHandle; }
-    ~shaderModule() { DestroyHandleBy(vkDestroyShaderModule); }
+    ~mappedFile() { Close(); }
 
     // Getter
-    DefineHandleTypeOperator;
-    DefineAddressFunction;
+    const uint8_t* Data() const { return pData; }
+    size_t         Size() const { return size; }
+    bool           IsOpen() const { return pData != nullptr; }
 
-    // Const Function
-    VkPipelineShaderStageCreateInfo StageCreateInfo(VkShaderStageFlagBits stage, const char* entry = "main") const
-    {
-        return {
-            VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,  // sType
-            nullptr,                                              // pNext
-            0,                                                    // flags
-            stage,                                                // stage
-            handle,                                               // module
-            entry,                                                // pName
-            nullptr                                               // pSpecializationInfo
-        };
-    }
     // Non-const Function
-    result_t Create(VkShaderModuleCreateInfo& createInfo)
+    result_t Open(const char* filepath)
     {
-        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        VkResult result  = vkCreateShaderModule(GraphicsBase::Base().Device(), &createInfo, nullptr, &handle);
-        if (result != 0)
+        Close();
+#ifdef _WIN32
+        file = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
         {
-            LOG(ERROR) << "[ shader ] ERROR\nFailed to create a shader module!\nError code: {}\n" << int32_t(result);
+            LOG(ERROR) << "[ mappedFile ] ERROR\nFailed to open the file: " << filepath;
+            return VK_RESULT_MAX_ENUM;
         }
-        return result;
-    }
-    result_t Create(const char* filepath /*VkShaderModuleCreateFlags flags*/)
-    {
-        std::ifstream file(filepath, std::ios::ate | std::ios::binary);
-        if (!file)
+        LARGE_INTEGER fileSize = {};
+        GetFileSizeEx(file, &fileSize);
+        size = static_cast<size_t>(fileSize.QuadPart);
+        if (size == 0U) { return VK_SUCCESS; }  // 空文件无法被映射，视作打开成功但没有内容
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr) { pData = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)); }
+#else
+        int fd = open(filepath, O_RDONLY);
+        if (fd < 0)
         {
-            LOG(ERROR) << "[ shader ] ERROR\nFailed to open the file: {}\n" << filepath;
-            return VK_RESULT_MAX_ENUM;  // 没有合适的错误代码，别用VK_ERROR_UNKNOWN
+            LOG(ERROR) << "[ mappedFile ] ERROR\nFailed to open the file: " << filepath;
+            return VK_RESULT_MAX_ENUM;
+        }
+        struct stat fileStat = {};
+        fstat(fd, &fileStat);
+        size = static_cast<size_t>(fileStat.st_size);
+        if (size == 0U)
+        {
+            close(fd);
+            return VK_SUCCESS;
+        }
+        void* pMapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);  // 映射建立后即可关闭文件描述符，映射本身会持有对文件的引用
+        if (pMapped != MAP_FAILED) { pData = static_cast<const uint8_t*>(pMapped); }
+#endif
+        if (pData == nullptr)
+        {
+            LOG(ERROR) << "[ mappedFile ] ERROR\nFailed to map the file: " << filepath;
+            Close();
+            return VK_RESULT_MAX_ENUM;
         }
-        size_t                fileSize = static_cast<size_t>(file.tellg());
-        std::vector<uint32_t> binaries(fileSize / 4);
-        file.seekg(0);
-        file.read(reinterpret_cast<char*>(binaries.data()), fileSize);
-        file.close();
-        return Create(fileSize, binaries.data());
+        return VK_SUCCESS;
     }
-    result_t Create(size_t codeSize, const uint32_t* pCode /*VkShaderModuleCreateFlags flags*/)
+    void Close()
     {
-        VkShaderModuleCreateInfo createInfo = {.codeSize = codeSize, .pCode = pCode};
-        return Create(createInfo);
+#ifdef _WIN32
+        if (pData != nullptr) { UnmapViewOfFile(pData); }
+        if (mapping != nullptr) { CloseHandle(mapping); }
+        if (file != INVALID_HANDLE_VALUE) { CloseHandle(file); }
+        mapping = nullptr;
+        file    = INVALID_HANDLE_VALUE;
+#else
+        if (pData != nullptr) { munmap(const_cast<uint8_t*>(pData), size); }
+#endif
+        pData = nullptr;
+        size  = 0;
     }
 };
 
 /**
- * @brief 反转矩阵的y方向
- * @note 之前已经定义了GLM_FORCE_DEPTH_ZERO_TO_ONE来指定深度范围为[ 0, 1]。
- * GLM生成的投影矩阵适用于OpenGL，但对于Vulkan程序还需要解决+y方向问题，
+ * @brief 特化常量，按constant_id打包各常量的值和VkSpecializationMapEntry
+ * @note 着色器中的bool常量须以bool或VkBool32设置，打包为4字节；Info()返回的指针在本对象被修改或析构前有效
  */
-inline glm::mat4 FlipVertical(const glm::mat4& projection)
-{
-    glm::mat4 _projection = projection;
-    for (uint32_t i = 0; i < 4; i++) { _projection[i][1] *= -1; }
-    return _projection;
-}
+class specializationConstants {
+    smallVector<VkSpecializationMapEntry, 8> mapEntries;  // 常量通常不多，不分配内存
+    smallVector<uint8_t, 32>                 data;
+    mutable VkSpecializationInfo             specializationInfo = {};
 
-/**
- * @brief 管线布局
- */
-class pipelineLayout {
-    VkPipelineLayout handle = VK_NULL_HANDLE;
+    template <typename T>
+    static constexpr bool isScalar = std::is_same_v<T, int32_t> || std::is_same_v<T, uint32_t> ||
+                                     std::is_same_v<T, float> || std::is_same_v<T, int64_t> ||
+                                     std::is_same_v<T, uint64_t> || std::is_same_v<T, double>;
+
+    void Set(uint32_t constantId, const void* pValue, size_t size)
+    {
+        for (const auto& i : mapEntries)
+        {
+            if (i.constantID != constantId) { continue; }
+            if (i.size != size)
+            {
+                LOG(ERROR) << "[ specializationConstants ] ERROR\nThe constant " << constantId
+                           << " was set with a different size: " << i.size << " -> " << size;
+                return;
+            }
+            memcpy(data.data() + i.offset, pValue, size);
+            return;
+        }
+        // 按值的大小对齐，64位的常量不会跨越8字节边界
+        size_t offset = (data.size() + size - 1) / size * size;
+        data.resize(offset + size);
+        memcpy(data.data() + offset, pValue, size);
+        mapEntries.push_back({constantId, static_cast<uint32_t>(offset), size});
+    }
 
 public:
-    pipelineLayout() = default;
-    pipelineLayout(VkPipelineLayoutCreateInfo& createInfo) { Create(createInfo); }
-    pipelineLayout(pipelineLayout&& other) noexcept { MoveHandle; }
+    specializationConstants() = default;
+    specializationConstants(const specializationConstants& other) : mapEntries(other.mapEntries), data(other.data) {}
+    specializationConstants(specializationConstants&& other) noexcept
+        : mapEntries(std::move(other.mapEntries)), data(std::move(other.data))
+    {
+    }
+    specializationConstants& operator=(const specializationConstants& other)
+    {
+        mapEntries = other.mapEntries;
+        data       = other.data;
+        return *this;
+    }
+    specializationConstants& operator=(specializationConstants&& other) noexcept
+    {
+        mapEntries = std::move(other.mapEntries);
+        data       = std::move(other.data);
+        return *this;
+    }
+
+    // Getter
+    bool     Empty() const { return mapEntries.empty(); }
+    uint32_t Count() const { return static_cast<uint32_t>(mapEntries.size()); }
+
+    // Const Function
+    /**
+     * @return const VkSpecializationInfo* 没有常量时返回nullptr，可直接用作pSpecializationInfo
+     */
+    const VkSpecializationInfo* Info() const
+    {
+        if (mapEntries.empty()) { return nullptr; }
+        specializationInfo = {
+            .mapEntryCount = static_cast<uint32_t>(mapEntries.size()),
+            .pMapEntries   = mapEntries.data(),
+            .dataSize      = data.size(),
+            .pData         = data.data(),
+        };
+        return &specializationInfo;
+    }
+    /**
+     * @brief 以constant_id排序后计算哈希，与设置各常量的顺序无关
+     */
+    uint64_t Hash() const
+    {
+        smallVector<VkSpecializationMapEntry, 8> sorted = mapEntries;
+        std::sort(sorted.begin(), sorted.end(),
+                  [](const auto& a, const auto& b) { return a.constantID < b.constantID; });
+        uint32_t count = Count();
+        uint64_t hash  = HashBytes(&count, sizeof count);
+        for (const auto& i : sorted)
+        {
+            hash = HashBytes(&i.constantID, sizeof i.constantID, hash);
+            hash = HashBytes(data.data() + i.offset, i.size, hash);
+        }
+        return hash;
+    }
+    /**
+     * @brief 各常量的constant_id和值都相同时相等，与设置各常量的顺序无关
+     */
+    bool operator==(const specializationConstants& other) const
+    {
+        if (Count() != other.Count()) { return false; }
+        for (const auto& i : mapEntries)
+        {
+            auto j = std::find_if(other.mapEntries.begin(), other.mapEntries.end(),
+                                  [&](const auto& entry) { return entry.constantID == i.constantID; });
+            if (j == other.mapEntries.end() || j->size != i.size ||
+                memcmp(data.data() + i.offset, other.data.data() + j->offset, i.size) != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Non-const Function
+    template <typename T>
+    specializationConstants& Set(uint32_t constantId, T value)
+    {
+        static_assert(isScalar<T>, "Specialization constants must be 32-bit or 64-bit integers or floats.");
+        Set(constantId, &value, sizeof value);
+        return *this;
+    }
+    specializationConstants& Set(uint32_t constantId, bool value)
+    {
+        return Set(constantId, static_cast<VkBool32>(value));
+    }
+    /**
+     * @brief 以other中的值覆盖或补充本对象中的常量
+     */
+    specializationConstants& Merge(const specializationConstants& other)
+    {
+        for (const auto& i : other.mapEntries) { Set(i.constantID, other.data.data() + i.offset, i.size); }
+        return *this;
+    }
+    /**
+     * @brief 以info中的值覆盖或补充本对象中的常量，用于接管由其他方式给出的特化常量
+     */
+    specializationConstants& Merge(const VkSpecializationInfo& info)
+    {
+        for (uint32_t i = 0; i < info.mapEntryCount; i++)
+        {
+            const VkSpecializationMapEntry& entry = info.pMapEntries[i];
+            Set(entry.constantID, static_cast<const uint8_t*>(info.pData) + entry.offset, entry.size);
+        }
+        return *this;
+    }
+    void Clear()
+    {
+        mapEntries.clear();
+        data.clear();
+    }
+};
+
+/**
+ * @brief 着色器模块
+ */
+class shaderModule {
+    VkShaderModule handle = VK_NULL_HANDLE;
+
+public:
+    shaderModule() = default;
+    shaderModule(VkShaderModuleCreateInfo& createInfo) { Create(createInfo); }
+    shaderModule(const char* filepath /*VkShaderModuleCreateFlags flags*/) { Create(filepath); }
+    shaderModule(size_t codeSize, const uint32_t* pCode /*VkShaderModuleCreateFlags flags*/)
+    {
+        Create(codeSize, pCode);
+    }
+    template <size_t N>
+    shaderModule(const uint32_t (&code)[N])
+    {
+        Create(sizeof code, code);
+    }
+    shaderModule(shaderModule&& other) noexcept { MoveHandle; }
+    ~shaderModule() { DestroyHandleBy(vkDestroyShaderModule); }
+
+    // Getter
+    DefineHandleTypeOperator;
+    DefineAddressFunction;
+
+    // Const Function
+    /**
+     * @param pSpecializationInfo 可由specializationConstants::Info()取得，须在创建管线前保持有效
+     */
+    VkPipelineShaderStageCreateInfo StageCreateInfo(VkShaderStageFlagBits       stage,
+                                                    const char*                 entry               = "main",
+                                                    const VkSpecializationInfo* pSpecializationInfo = nullptr) const
+    {
+        return {
+            VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,  // sType
+            nullptr,                                              // pNext
+            0,                                                    // flags
+            stage,                                                // stage
+            handle,                                               // module
+            entry,                                                // pName
+            pSpecializationInfo                                   // pSpecializationInfo
+        };
+    }
+    // Non-const Function
+    result_t Create(VkShaderModuleCreateInfo& createInfo)
+    {
+        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        VkResult result  = vkCreateShaderModule(GraphicsBase::Base().Device(), &createInfo, nullptr, &handle);
+        if (result != 0)
+        {
+            LOG(ERROR) << "[ shader ] ERROR\nFailed to create a shader module!\nError code: {}\n" << int32_t(result);
+        }
+        return result;
+    }
+    /**
+     * @note 若路径登记在shaderRegistry中（即构建时嵌入的shader/下的着色器），直接使用嵌入的SPIR-V，不读取文件；
+     * 否则文件被映射到内存后直接交给vkCreateShaderModule，不经过中间的复制；映射的起始地址按页对齐，满足pCode的对齐要求
+     */
+    result_t Create(const char* filepath /*VkShaderModuleCreateFlags flags*/)
+    {
+        embeddedSpirv spirv = shaderRegistry::Shared().Find(filepath);
+        if (spirv) { return Create(spirv.codeSize, spirv.pCode); }
+        mappedFile file;
+        if (result_t result = file.Open(filepath)) { return result; }
+        if (!IsSpirv(file.Data(), file.Size()))
+        {
+            LOG(ERROR) << "[ shader ] ERROR\nThe file isn't valid SPIR-V: " << filepath;
+            return VK_RESULT_MAX_ENUM;  // 没有合适的错误代码，别用VK_ERROR_UNKNOWN
+        }
+        return Create(file.Size(), reinterpret_cast<const uint32_t*>(file.Data()));
+    }
+    result_t Create(size_t codeSize, const uint32_t* pCode /*VkShaderModuleCreateFlags flags*/)
+    {
+        VkShaderModuleCreateInfo createInfo = {.codeSize = codeSize, .pCode = pCode};
+        return Create(createInfo);
+    }
+
+    // Static Function
+    /**
+     * @brief 检查大小是否为4的倍数且以SPIR-V的魔数开头
+     */
+    static bool IsSpirv(const void* pCode, size_t codeSize)
+    {
+        constexpr uint32_t magic = 0x07230203;
+        return pCode != nullptr && codeSize >= 20 && codeSize % 4 == 0 &&
+               *static_cast<const uint32_t*>(pCode) == magic;
+    }
+};
+
+/**
+ * @brief 反转矩阵的y方向
+ * @note 之前已经定义了GLM_FORCE_DEPTH_ZERO_TO_ONE来指定深度范围为[ 0, 1]。
+ * GLM生成的投影矩阵适用于OpenGL，但对于Vulkan程序还需要解决+y方向问题，
+ */
+inline glm::mat4 FlipVertical(const glm::mat4& projection)
+{
+    glm::mat4 _projection = projection;
+    for (uint32_t i = 0; i < 4; i++) { _projection[i][1] *= -1; }
+    return _projection;
+}
+
+/**
+ * @brief 管线布局
+ */
+class pipelineLayout {
+    VkPipelineLayout handle = VK_NULL_HANDLE;
+
+public:
+    pipelineLayout() = default;
+    pipelineLayout(VkPipelineLayoutCreateInfo& createInfo) { Create(createInfo); }
+    pipelineLayout(pipelineLayout&& other) noexcept { MoveHandle; }
     ~pipelineLayout() { DestroyHandleBy(vkDestroyPipelineLayout); }
 
     // Getter
@@ -1824,54 +2438,1338 @@ public:
     DefineAddressFunction;
 
     // Non-const Function
-    result_t Create(VkPipelineLayoutCreateInfo& createInfo)
+    result_t Create(VkPipelineLayoutCreateInfo& createInfo)
+    {
+        createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        VkResult result  = vkCreatePipelineLayout(GraphicsBase::Base().Device(), &createInfo, nullptr, &handle);
+        if (result != 0)
+        {
+            LOG(ERROR) << "[ pipelineLayout ] ERROR\nFailed to create a pipeline layout!\nError code: {}\n"
+                       << static_cast<int32_t>(result);
+        }
+        return result;
+    }
+};
+
+/**
+ * @brief 管线创建反馈的汇总
+ * @note pipeline::Create(...)在设备支持时（Vulkan1.3或VK_EXT_pipeline_creation_feedback）为每个管线附上
+ * VkPipelineCreationFeedbackCreateInfo，结果汇总于此，可得出最慢的管线和管线缓存的命中率；线程安全；
+ * 只保留最近的Capacity()条记录，记录中的句柄仅用于区分管线，对应的管线可能已被销毁
+ */
+class pipelineFeedbackReport {
+public:
+    struct stageFeedback
+    {
+        VkShaderStageFlagBits      stage;
+        VkPipelineCreationFeedback feedback;
+    };
+    struct pipelineFeedback
+    {
+        VkPipeline                    pipeline;
+        VkPipelineCreationFeedback    feedback;
+        smallVector<stageFeedback, 4> stages;  // 驱动未提供有效反馈的阶段不计入
+    };
+
+private:
+    std::deque<pipelineFeedback> feedbacks;
+    size_t                       capacity = 4096;
+    mutable std::mutex           mutex;
+    std::atomic<bool>            enabled = true;
+
+    static bool CacheHit(const VkPipelineCreationFeedback& feedback)
+    {
+        return (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT) != 0U;
+    }
+
+public:
+    // Getter
+    size_t Count() const
+    {
+        std::lock_guard lock(mutex);
+        return feedbacks.size();
+    }
+    size_t Capacity() const
+    {
+        std::lock_guard lock(mutex);
+        return capacity;
+    }
+    bool Enabled() const { return enabled; }
+
+    // Const Function
+    /**
+     * @brief 设备是否支持创建反馈，须在创建逻辑设备后调用
+     */
+    bool Supported() const
+    {
+        GraphicsBase& base = GraphicsBase::Base();
+        return std::min(base.ApiVersion(), base.PhysicalDeviceProperties().apiVersion) >= VK_API_VERSION_1_3 ||
+               base.DeviceExtensionEnabled(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+    }
+    /**
+     * @brief 以管线缓存命中的管线占比表示的命中率，没有记录时返回0
+     */
+    double CacheHitRate() const
+    {
+        std::lock_guard lock(mutex);
+        if (feedbacks.empty()) { return 0; }
+        auto hitCount = std::count_if(feedbacks.begin(), feedbacks.end(),
+                                      [](const pipelineFeedback& i) { return CacheHit(i.feedback); });
+        return static_cast<double>(hitCount) / static_cast<double>(feedbacks.size());
+    }
+    /**
+     * @brief 所有管线的创建耗时之和，以纳秒计
+     */
+    uint64_t TotalDuration() const
+    {
+        std::lock_guard lock(mutex);
+        uint64_t        duration = 0;
+        for (const auto& i : feedbacks) { duration += i.feedback.duration; }
+        return duration;
+    }
+    /**
+     * @brief 生成文本形式的报告，列出总耗时、缓存命中率，以及最慢的若干个管线及其各阶段的耗时
+     */
+    std::string Report(size_t slowestCount = 10) const
+    {
+        std::vector<pipelineFeedback> sorted;
+        {
+            std::lock_guard lock(mutex);
+            sorted.assign(feedbacks.begin(), feedbacks.end());
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const pipelineFeedback& a, const pipelineFeedback& b) {
+            return a.feedback.duration > b.feedback.duration;
+        });
+        uint64_t totalDuration = 0;
+        size_t   hitCount      = 0;
+        for (const auto& i : sorted)
+        {
+            totalDuration += i.feedback.duration;
+            hitCount += CacheHit(i.feedback);
+        }
+        std::string report = std::format("Pipelines: {}, total {:.3f} ms, cache hits: {} ({:.1f}%)\n", sorted.size(),
+                                          totalDuration / 1e6, hitCount,
+                                          sorted.empty() ? 0.0 : 100.0 * hitCount / sorted.size());
+        for (size_t i = 0; i < std::min(slowestCount, sorted.size()); i++)
+        {
+            const pipelineFeedback& pipeline = sorted[i];
+            report += std::format("{:>3}. 0x{:016x} {:10.3f} ms{}\n", i + 1,
+                                  reinterpret_cast<uint64_t>(pipeline.pipeline), pipeline.feedback.duration / 1e6,
+                                  CacheHit(pipeline.feedback) ? " (cache hit)" : "");
+            for (const auto& j : pipeline.stages)
+            {
+                report += std::format("       stage 0x{:02x} {:10.3f} ms{}\n", static_cast<uint32_t>(j.stage),
+                                      j.feedback.duration / 1e6, CacheHit(j.feedback) ? " (cache hit)" : "");
+            }
+        }
+        return report;
+    }
+
+    // Non-const Function
+    /**
+     * @brief 开启或关闭反馈的收集，关闭时pipeline::Create(...)不再附上反馈结构体
+     */
+    void Enable(bool enable) { enabled = enable; }
+    /**
+     * @brief 设置保留的记录条数，超出时丢弃最早的记录
+     */
+    void Capacity(size_t capacity)
+    {
+        std::lock_guard lock(mutex);
+        this->capacity = capacity;
+        while (feedbacks.size() > capacity) { feedbacks.pop_front(); }
+    }
+    void Add(pipelineFeedback&& feedback)
+    {
+        std::lock_guard lock(mutex);
+        if (capacity == 0) { return; }
+        if (feedbacks.size() == capacity) { feedbacks.pop_front(); }
+        feedbacks.push_back(std::move(feedback));
+    }
+    void Clear()
+    {
+        std::lock_guard lock(mutex);
+        feedbacks.clear();
+    }
+
+    // Static Function
+    static pipelineFeedbackReport& Shared()
+    {
+        static pipelineFeedbackReport report;
+        return report;
+    }
+};
+
+/**
+ * @brief 管线可执行体的统计与内部表示的汇总，用于诊断着色器的开销
+ * @note 以Enable(...)开启诊断模式后，pipeline::Create(...)在设备支持VK_KHR_pipeline_executable_properties时
+ * 为管线附上捕获统计数据（及内部表示）的标志，并在创建后读取每个可执行体（通常对应一个着色器阶段）的
+ * 指令数、寄存器用量、溢出等统计数据；诊断模式会影响编译耗时，须在创建管线前开启；线程安全
+ */
+class pipelineExecutableReport {
+public:
+    struct statistic
+    {
+        std::string                            name;
+        VkPipelineExecutableStatisticFormatKHR format;
+        VkPipelineExecutableStatisticValueKHR  value;
+    };
+    struct internalRepresentation
+    {
+        std::string name;
+        std::string data;  // 非文本的内部表示不保存数据
+        bool        isText;
+    };
+    struct executable
+    {
+        VkPipeline                          pipeline;
+        std::string                         name;
+        std::string                         description;
+        VkShaderStageFlags                  stages;
+        uint32_t                            subgroupSize;
+        std::vector<statistic>              statistics;
+        std::vector<internalRepresentation> internalRepresentations;
+    };
+
+private:
+    std::vector<executable>                     executables;
+    std::unordered_map<VkPipeline, std::string> labels;
+    mutable std::mutex                          mutex;
+    std::atomic<VkPipelineCreateFlags>          captureFlags = 0;
+    // 扩展的特性结构体须活过逻辑设备
+    inline static VkPhysicalDevicePipelineExecutablePropertiesFeaturesKHR executablePropertiesFeatures = {
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PIPELINE_EXECUTABLE_PROPERTIES_FEATURES_KHR,
+    };
+
+    static double Value(const statistic& statistic)
+    {
+        switch (statistic.format)
+        {
+            case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_BOOL32_KHR:  return statistic.value.b32;
+            case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_INT64_KHR:   return static_cast<double>(statistic.value.i64);
+            case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_UINT64_KHR:  return static_cast<double>(statistic.value.u64);
+            case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_FLOAT64_KHR: return statistic.value.f64;
+            default:                                                  return 0;
+        }
+    }
+    static std::string ValueJson(const statistic& statistic)
+    {
+        switch (statistic.format)
+        {
+            case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_BOOL32_KHR: return statistic.value.b32 ? "true" : "false";
+            case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_INT64_KHR:  return std::to_string(statistic.value.i64);
+            case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_UINT64_KHR: return std::to_string(statistic.value.u64);
+            default: return std::isfinite(statistic.value.f64) ? std::format("{}", statistic.value.f64) : "null";
+        }
+    }
+    static std::string Escape(std::string_view string)
+    {
+        std::string result = "\"";
+        for (char i : string)
+        {
+            switch (i)
+            {
+                case '"':  result += "\\\""; break;
+                case '\\': result += "\\\\"; break;
+                case '\n': result += "\\n"; break;
+                case '\r': result += "\\r"; break;
+                case '\t': result += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(i) < 0x20) { result += std::format("\\u{:04x}", +i); }
+                    else { result += i; }
+            }
+        }
+        return result += '"';
+    }
+    /**
+     * @brief 以名称中含有key（不区分大小写）的第一个统计数据作为可执行体的开销，没有时为0
+     */
+    static double Cost(const executable& target, std::string_view key)
+    {
+        auto lower = [](std::string_view string) {
+            std::string result(string);
+            for (char& i : result) { i = static_cast<char>(std::tolower(static_cast<unsigned char>(i))); }
+            return result;
+        };
+        std::string lowerKey = lower(key);
+        for (const auto& i : target.statistics)
+        {
+            if (lower(i.name).find(lowerKey) != std::string::npos) { return Value(i); }
+        }
+        return 0;
+    }
+
+public:
+    // Getter
+    size_t Count() const
+    {
+        std::lock_guard lock(mutex);
+        return executables.size();
+    }
+    /**
+     * @brief 诊断模式下须附加到管线创建信息的标志，未开启时为0
+     */
+    VkPipelineCreateFlags CaptureFlags() const { return captureFlags; }
+
+    // Const Function
+    /**
+     * @brief 逻辑设备是否开启了读取管线可执行体的属性，须在创建逻辑设备后调用
+     */
+    bool Supported() const
+    {
+        return GraphicsBase::Base().DeviceExtensionEnabled(VK_KHR_PIPELINE_EXECUTABLE_PROPERTIES_EXTENSION_NAME) &&
+               executablePropertiesFeatures.pipelineExecutableInfo != VK_FALSE;
+    }
+    /**
+     * @brief 生成JSON形式的报告，可执行体按开销从高到低排列
+     *
+     * @param costStatistic 用作开销的统计数据的名称（的一部分，不区分大小写），各厂商的命名不同，
+     * 默认取名称中含"instruction"的第一个统计数据，即指令数
+     */
+    std::string Json(std::string_view costStatistic = "instruction", bool includeInternalRepresentations = true) const
+    {
+        std::vector<std::pair<double, const executable*>> sorted;
+        std::lock_guard                                   lock(mutex);
+        sorted.reserve(executables.size());
+        for (const auto& i : executables) { sorted.emplace_back(Cost(i, costStatistic), &i); }
+        std::stable_sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+        std::string json = std::format("{{\n\"costStatistic\": {},\n\"executables\": [", Escape(costStatistic));
+        for (size_t i = 0; i < sorted.size(); i++)
+        {
+            const auto& [cost, pExecutable] = sorted[i];
+            auto        label               = labels.find(pExecutable->pipeline);
+            json += std::format("{}\n{{\"pipeline\": \"0x{:016x}\", \"label\": {}, \"name\": {}, \"description\": {}, "
+                                "\"stages\": {}, \"subgroupSize\": {}, \"cost\": {},\n \"statistics\": [",
+                                i ? "," : "", reinterpret_cast<uint64_t>(pExecutable->pipeline),
+                                label == labels.end() ? "null" : Escape(label->second), Escape(pExecutable->name),
+                                Escape(pExecutable->description), pExecutable->stages, pExecutable->subgroupSize,
+                                cost);
+            for (size_t j = 0; j < pExecutable->statistics.size(); j++)
+            {
+                const statistic& statistic = pExecutable->statistics[j];
+                json += std::format("{}{{\"name\": {}, \"value\": {}}}", j ? ", " : "", Escape(statistic.name),
+                                    ValueJson(statistic));
+            }
+            json += ']';
+            if (includeInternalRepresentations)
+            {
+                json += ",\n \"internalRepresentations\": [";
+                for (size_t j = 0; j < pExecutable->internalRepresentations.size(); j++)
+                {
+                    const internalRepresentation& representation = pExecutable->internalRepresentations[j];
+                    json += std::format("{}{{\"name\": {}, \"text\": {}}}", j ? ", " : "", Escape(representation.name),
+                                        representation.isText ? Escape(representation.data) : "null");
+                }
+                json += ']';
+            }
+            json += '}';
+        }
+        return json += "\n]\n}\n";
+    }
+    result_t Save(const char* filepath, std::string_view costStatistic = "instruction",
+                  bool includeInternalRepresentations = true) const
+    {
+        std::ofstream file(filepath, std::ios::trunc);
+        file << Json(costStatistic, includeInternalRepresentations);
+        if (!file)
+        {
+            LOG(ERROR) << "[ pipelineExecutableReport ] ERROR\nFailed to write the report: " << filepath;
+            return VK_RESULT_MAX_ENUM;
+        }
+        return VK_SUCCESS;
+    }
+
+    // Non-const Function
+    /**
+     * @brief 开启或关闭诊断模式，设备不支持时保持关闭，须在创建逻辑设备后调用
+     *
+     * @param captureInternalRepresentations 是否同时读取着色器的内部表示（如中间代码、汇编），开销较大
+     */
+    void Enable(bool enable, bool captureInternalRepresentations = false)
+    {
+        if (enable && !Supported())
+        {
+            LOG(WARNING) << "[ pipelineExecutableReport ] WARNING\nPipeline executable properties are not supported!";
+            enable = false;
+        }
+        VkPipelineCreateFlags flags = 0;
+        if (enable)
+        {
+            flags = VK_PIPELINE_CREATE_CAPTURE_STATISTICS_BIT_KHR;
+            if (captureInternalRepresentations)
+            {
+                flags |= VK_PIPELINE_CREATE_CAPTURE_INTERNAL_REPRESENTATIONS_BIT_KHR;
+            }
+        }
+        captureFlags = flags;
+    }
+    /**
+     * @brief 为管线指定在报告中显示的名称
+     */
+    void Label(VkPipeline pipeline, std::string_view label)
+    {
+        std::lock_guard lock(mutex);
+        labels[pipeline] = label;
+    }
+    /**
+     * @brief 读取以CaptureFlags()创建的管线的各个可执行体，由pipeline::Create(...)调用
+     */
+    void Capture(VkPipeline pipeline)
+    {
+        VkDevice device        = GraphicsBase::Base().Device();
+        auto     getProperties = reinterpret_cast<PFN_vkGetPipelineExecutablePropertiesKHR>(
+            vkGetDeviceProcAddr(device, "vkGetPipelineExecutablePropertiesKHR"));
+        auto getStatistics = reinterpret_cast<PFN_vkGetPipelineExecutableStatisticsKHR>(
+            vkGetDeviceProcAddr(device, "vkGetPipelineExecutableStatisticsKHR"));
+        auto getInternalRepresentations = reinterpret_cast<PFN_vkGetPipelineExecutableInternalRepresentationsKHR>(
+            vkGetDeviceProcAddr(device, "vkGetPipelineExecutableInternalRepresentationsKHR"));
+        if (getProperties == nullptr || getStatistics == nullptr) { return; }
+
+        VkPipelineInfoKHR pipelineInfo = {VK_STRUCTURE_TYPE_PIPELINE_INFO_KHR, nullptr, pipeline};
+        uint32_t          count        = 0;
+        if (getProperties(device, &pipelineInfo, &count, nullptr) != VK_SUCCESS) { return; }
+        std::vector<VkPipelineExecutablePropertiesKHR> properties(
+            count, {VK_STRUCTURE_TYPE_PIPELINE_EXECUTABLE_PROPERTIES_KHR});
+        if (getProperties(device, &pipelineInfo, &count, properties.data()) < 0) { return; }
+
+        std::vector<executable> captured;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            captured.push_back({pipeline, properties[i].name, properties[i].description, properties[i].stages,
+                                properties[i].subgroupSize});
+            executable&                 current        = captured.back();
+            VkPipelineExecutableInfoKHR executableInfo = {
+                VK_STRUCTURE_TYPE_PIPELINE_EXECUTABLE_INFO_KHR, nullptr, pipeline, i,
+            };
+            uint32_t statisticCount = 0;
+            if (getStatistics(device, &executableInfo, &statisticCount, nullptr) == VK_SUCCESS)
+            {
+                std::vector<VkPipelineExecutableStatisticKHR> statistics(
+                    statisticCount, {VK_STRUCTURE_TYPE_PIPELINE_EXECUTABLE_STATISTIC_KHR});
+                if (getStatistics(device, &executableInfo, &statisticCount, statistics.data()) >= 0)
+                {
+                    for (uint32_t j = 0; j < statisticCount; j++)
+                    {
+                        current.statistics.push_back({statistics[j].name, statistics[j].format, statistics[j].value});
+                    }
+                }
+            }
+
+            uint32_t representationCount = 0;
+            if ((captureFlags & VK_PIPELINE_CREATE_CAPTURE_INTERNAL_REPRESENTATIONS_BIT_KHR) == 0U ||
+                getInternalRepresentations == nullptr ||
+                getInternalRepresentations(device, &executableInfo, &representationCount, nullptr) != VK_SUCCESS)
+            {
+                continue;
+            }
+            // 先取得各个内部表示的大小，再分配内存并取得数据
+            std::vector<VkPipelineExecutableInternalRepresentationKHR> representations(
+                representationCount, {VK_STRUCTURE_TYPE_PIPELINE_EXECUTABLE_INTERNAL_REPRESENTATION_KHR});
+            if (getInternalRepresentations(device, &executableInfo, &representationCount, representations.data()) < 0)
+            {
+                continue;
+            }
+            std::vector<std::string> data(representationCount);
+            for (uint32_t j = 0; j < representationCount; j++)
+            {
+                data[j].resize(representations[j].dataSize);
+                representations[j].pData = data[j].data();
+            }
+            if (getInternalRepresentations(device, &executableInfo, &representationCount, representations.data()) < 0)
+            {
+                continue;
+            }
+            for (uint32_t j = 0; j < representationCount; j++)
+            {
+                bool isText = representations[j].isText != VK_FALSE;
+                if (isText) { data[j].resize(std::min(data[j].find('\0'), data[j].size())); }  // 去掉末尾的空字符
+                current.internalRepresentations.push_back(
+                    {representations[j].name, isText ? std::move(data[j]) : std::string(), isText});
+            }
+        }
+
+        std::lock_guard lock(mutex);
+        executables.insert(executables.end(), std::make_move_iterator(captured.begin()),
+                           std::make_move_iterator(captured.end()));
+    }
+    void Clear()
+    {
+        std::lock_guard lock(mutex);
+        executables.clear();
+        labels.clear();
+    }
+
+    // Static Function
+    /**
+     * @brief 检查并添加VK_KHR_pipeline_executable_properties及其特性，须在创建逻辑设备前调用
+     * @note 物理设备不支持时不开启，不视为错误
+     */
+    static result_t EnableDeviceExtensions()
+    {
+        std::vector<const char*> extensions = {VK_KHR_PIPELINE_EXECUTABLE_PROPERTIES_EXTENSION_NAME};
+        if (result_t result = GraphicsBase::Base().CheckDeviceExtensions(extensions)) { return result; }
+        if (extensions[0] == nullptr) { return VK_SUCCESS; }
+        GraphicsBase::Base().AddDeviceExtension(extensions[0]);
+        GraphicsBase::Base().AddDeviceFeatures(&executablePropertiesFeatures);
+        return VK_SUCCESS;
+    }
+    static pipelineExecutableReport& Shared()
+    {
+        static pipelineExecutableReport report;
+        return report;
+    }
+};
+
+class pipeline {
+    VkPipeline handle = VK_NULL_HANDLE;
+
+    // 附在创建信息的pNext链首的反馈结构体
+    struct feedbackChain
+    {
+        VkPipelineCreationFeedbackCreateInfo createInfo = {
+            VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO,
+        };
+        VkPipelineCreationFeedback                 pipelineFeedback = {};
+        smallVector<VkPipelineCreationFeedback, 4> stageFeedbacks;
+        bool                                       attached = false;
+    };
+
+    static bool HasFeedback(const void* pNext)
+    {
+        const auto* pStructure = static_cast<const VkBaseInStructure*>(pNext);
+        while (pStructure != nullptr)
+        {
+            if (pStructure->sType == VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO) { return true; }
+            pStructure = pStructure->pNext;
+        }
+        return false;
+    }
+    /**
+     * @brief 创建管线，设备支持时附上创建反馈并汇总到pipelineFeedbackReport::Shared()，
+     * 开启了诊断模式时读取可执行体的统计数据并汇总到pipelineExecutableReport::Shared()
+     * @note 已在pNext链中提供了反馈结构体的创建信息不被改动
+     */
+    template <typename CreateInfo>
+    static VkResult CreatePipelines(arrayRef<CreateInfo> createInfos, VkPipeline* pHandles)
+    {
+        constexpr bool graphics = std::is_same_v<CreateInfo, VkGraphicsPipelineCreateInfo>;
+        auto stageCount = [](const CreateInfo& createInfo) -> uint32_t {
+            if constexpr (graphics) { return createInfo.stageCount; }
+            else { return 1; }
+        };
+        auto stage = [](const CreateInfo& createInfo, uint32_t index) -> VkShaderStageFlagBits {
+            if constexpr (graphics) { return createInfo.pStages[index].stage; }
+            else { return createInfo.stage.stage; }
+        };
+
+        pipelineFeedbackReport&    report = pipelineFeedbackReport::Shared();
+        std::vector<feedbackChain> chains(report.Enabled() && report.Supported() ? createInfos.Count() : 0);
+        for (size_t i = 0; i < chains.size(); i++)
+        {
+            if (HasFeedback(createInfos[i].pNext)) { continue; }
+            feedbackChain& chain = chains[i];
+            chain.stageFeedbacks.resize(stageCount(createInfos[i]));
+            chain.createInfo.pNext                              = createInfos[i].pNext;
+            chain.createInfo.pPipelineCreationFeedback          = &chain.pipelineFeedback;
+            chain.createInfo.pipelineStageCreationFeedbackCount = static_cast<uint32_t>(chain.stageFeedbacks.size());
+            chain.createInfo.pPipelineStageCreationFeedbacks    = chain.stageFeedbacks.data();
+            chain.attached                                      = true;
+            createInfos[i].pNext                                = &chain.createInfo;
+        }
+        // 诊断模式下附加捕获可执行体统计数据的标志，创建后恢复
+        pipelineExecutableReport&             executableReport = pipelineExecutableReport::Shared();
+        VkPipelineCreateFlags                 captureFlags     = executableReport.CaptureFlags();
+        smallVector<VkPipelineCreateFlags, 4> originalFlags;
+        if (captureFlags != 0U)
+        {
+            for (auto& i : createInfos)
+            {
+                originalFlags.push_back(i.flags);
+                i.flags |= captureFlags;
+            }
+        }
+
+        VkResult result;
+        if constexpr (graphics)
+        {
+            result = vkCreateGraphicsPipelines(GraphicsBase::Base().Device(), VK_NULL_HANDLE, createInfos.Count(),
+                                               createInfos.Pointer(), nullptr, pHandles);
+        }
+        else
+        {
+            result = vkCreateComputePipelines(GraphicsBase::Base().Device(), VK_NULL_HANDLE, createInfos.Count(),
+                                              createInfos.Pointer(), nullptr, pHandles);
+        }
+
+        for (size_t i = 0; i < chains.size(); i++)
+        {
+            feedbackChain& chain = chains[i];
+            if (!chain.attached) { continue; }
+            createInfos[i].pNext = chain.createInfo.pNext;
+            if (pHandles[i] == VK_NULL_HANDLE ||
+                (chain.pipelineFeedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT) == 0U)
+            {
+                continue;
+            }
+            pipelineFeedbackReport::pipelineFeedback feedback = {pHandles[i], chain.pipelineFeedback};
+            for (uint32_t j = 0; j < chain.stageFeedbacks.size(); j++)
+            {
+                if ((chain.stageFeedbacks[j].flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT) == 0U) { continue; }
+                feedback.stages.push_back({stage(createInfos[i], j), chain.stageFeedbacks[j]});
+            }
+            report.Add(std::move(feedback));
+        }
+        for (size_t i = 0; i < originalFlags.size(); i++)
+        {
+            createInfos[i].flags = originalFlags[i];
+            // 管线库不能单独执行，其可执行体在链接后的管线上读取
+            if (pHandles[i] != VK_NULL_HANDLE && (originalFlags[i] & VK_PIPELINE_CREATE_LIBRARY_BIT_KHR) == 0U)
+            {
+                executableReport.Capture(pHandles[i]);
+            }
+        }
+        return result;
+    }
+    static void Adopt(const std::vector<VkPipeline>& handles, arrayRef<pipeline> pipelines)
+    {
+        for (size_t i = 0; i < std::min(handles.size(), pipelines.Count()); i++)
+        {
+            pipeline& target = pipelines[i];
+            if (target.handle != VK_NULL_HANDLE)
+            {
+                vkDestroyPipeline(GraphicsBase::Base().Device(), target.handle, nullptr);
+            }
+            target.handle = handles[i];
+        }
+    }
+
+public:
+    pipeline() = default;
+    pipeline(VkGraphicsPipelineCreateInfo& createInfo) { Create(createInfo); }
+    pipeline(VkComputePipelineCreateInfo& createInfo) { Create(createInfo); }
+    pipeline(pipeline&& other) noexcept { MoveHandle; }
+    ~pipeline() { DestroyHandleBy(vkDestroyPipeline); }
+
+    // Getter
+    DefineHandleTypeOperator;
+    DefineAddressFunction;
+
+    // Non-const Function
+    result_t Create(VkGraphicsPipelineCreateInfo& createInfo)
+    {
+        createInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        VkResult result  = CreatePipelines<VkGraphicsPipelineCreateInfo>(createInfo, &handle);
+        if (result != 0)
+        {
+            LOG(ERROR) << "[ pipeline ] ERROR\nFailed to create a graphics pipeline!\nError code: {}\n"
+                       << static_cast<int32_t>(result);
+        }
+        return result;
+    }
+    result_t Create(VkComputePipelineCreateInfo& createInfo)
+    {
+        createInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        VkResult result  = CreatePipelines<VkComputePipelineCreateInfo>(createInfo, &handle);
+        if (result != 0)
+        {
+            LOG(ERROR) << "[ pipeline ] ERROR\nFailed to create a compute pipeline!\nError code: {}\n"
+                       << static_cast<int32_t>(result);
+        }
+        return result;
+    }
+
+    // Static Function
+    /**
+     * @brief 以一次调用创建多个图形管线，驱动可在同一批管线间分摊编译工作
+     * @note 派生管线可以basePipelineIndex指定同一批中位于其前面的基础管线；
+     * 部分管线创建失败时，其余管线仍被创建，失败的管线的句柄为VK_NULL_HANDLE
+     *
+     * @param pipelines 个数须与createInfos相同，其中原有的管线被销毁
+     */
+    static result_t Create(arrayRef<VkGraphicsPipelineCreateInfo> createInfos, arrayRef<pipeline> pipelines)
+    {
+        for (auto& i : createInfos) { i.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO; }
+        std::vector<VkPipeline> handles(createInfos.Count());
+        VkResult                result = CreatePipelines(createInfos, handles.data());
+        if (result != 0)
+        {
+            LOG(ERROR) << "[ pipeline ] ERROR\nFailed to create graphics pipelines in a batch!\nError code: "
+                       << static_cast<int32_t>(result);
+        }
+        Adopt(handles, pipelines);
+        return result;
+    }
+    static result_t Create(arrayRef<VkComputePipelineCreateInfo> createInfos, arrayRef<pipeline> pipelines)
+    {
+        for (auto& i : createInfos) { i.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO; }
+        std::vector<VkPipeline> handles(createInfos.Count());
+        VkResult                result = CreatePipelines(createInfos, handles.data());
+        if (result != 0)
+        {
+            LOG(ERROR) << "[ pipeline ] ERROR\nFailed to create compute pipelines in a batch!\nError code: "
+                       << static_cast<int32_t>(result);
+        }
+        Adopt(handles, pipelines);
+        return result;
+    }
+};
+
+/**
+ * @brief 描述符布局
+ */
+class descriptorSetLayout {
+    VkDescriptorSetLayout handle = VK_NULL_HANDLE;
+
+public:
+    descriptorSetLayout() = default;
+    descriptorSetLayout(VkDescriptorSetLayoutCreateInfo& createInfo) { Create(createInfo); }
+    descriptorSetLayout(descriptorSetLayout&& other) noexcept { MoveHandle; }
+    ~descriptorSetLayout() { DestroyHandleBy(vkDestroyDescriptorSetLayout); }
+
+    // Getter
+    DefineHandleTypeOperator;
+    DefineAddressFunction;
+
+    // Non-const Function
+    result_t Create(VkDescriptorSetLayoutCreateInfo& createInfo)
+    {
+        createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        VkResult result  = vkCreateDescriptorSetLayout(GraphicsBase::Base().Device(), &createInfo, nullptr, &handle);
+        if (result != 0)
+        {
+            LOG(ERROR) << "[ descriptorSetLayout ] ERROR\nFailed to create a descriptor set layout!\nError code: "
+                       << static_cast<int32_t>(result);
+        }
+        return result;
+    }
+};
+
+/**
+ * @brief 描述符集
+ * @note 描述符集由descriptorPool分配和释放，因此没有析构器
+ */
+class descriptorSet {
+    friend class descriptorPool;
+    VkDescriptorSet handle = VK_NULL_HANDLE;
+
+public:
+    descriptorSet() = default;
+    descriptorSet(descriptorSet&& other) noexcept { MoveHandle; }
+
+    // Getter
+    DefineHandleTypeOperator;
+    DefineAddressFunction;
+
+    // Const Function
+    void Write(arrayRef<const VkDescriptorImageInfo> descriptorInfos,
+               VkDescriptorType                      descriptorType,
+               uint32_t                              dstBinding      = 0,
+               uint32_t                              dstArrayElement = 0) const
+    {
+        VkWriteDescriptorSet writeDescriptorSet = {
+            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet          = handle,
+            .dstBinding      = dstBinding,
+            .dstArrayElement = dstArrayElement,
+            .descriptorCount = static_cast<uint32_t>(descriptorInfos.Count()),
+            .descriptorType  = descriptorType,
+            .pImageInfo      = descriptorInfos.Pointer(),
+        };
+        Update(writeDescriptorSet);
+    }
+    void Write(arrayRef<const VkDescriptorBufferInfo> descriptorInfos,
+               VkDescriptorType                       descriptorType,
+               uint32_t                               dstBinding      = 0,
+               uint32_t                               dstArrayElement = 0) const
+    {
+        VkWriteDescriptorSet writeDescriptorSet = {
+            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet          = handle,
+            .dstBinding      = dstBinding,
+            .dstArrayElement = dstArrayElement,
+            .descriptorCount = static_cast<uint32_t>(descriptorInfos.Count()),
+            .descriptorType  = descriptorType,
+            .pBufferInfo     = descriptorInfos.Pointer(),
+        };
+        Update(writeDescriptorSet);
+    }
+
+    // Static Function
+    static void Update(arrayRef<VkWriteDescriptorSet> writes, arrayRef<VkCopyDescriptorSet> copies = {})
+    {
+        for (auto& i : writes) { i.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET; }
+        for (auto& i : copies) { i.sType = VK_STRUCTURE_TYPE_COPY_DESCRIPTOR_SET; }
+        vkUpdateDescriptorSets(GraphicsBase::Base().Device(), writes.Count(), writes.Pointer(), copies.Count(),
+                               copies.Pointer());
+    }
+};
+
+/**
+ * @brief 描述符池
+ */
+class descriptorPool {
+    VkDescriptorPool handle = VK_NULL_HANDLE;
+
+public:
+    descriptorPool() = default;
+    descriptorPool(VkDescriptorPoolCreateInfo& createInfo) { Create(createInfo); }
+    descriptorPool(uint32_t                             maxSetCount,
+                   arrayRef<const VkDescriptorPoolSize> poolSizes,
+                   VkDescriptorPoolCreateFlags          flags = 0)
+    {
+        Create(maxSetCount, poolSizes, flags);
+    }
+    descriptorPool(descriptorPool&& other) noexcept { MoveHandle; }
+    ~descriptorPool() { DestroyHandleBy(vkDestroyDescriptorPool); }
+
+    // Getter
+    DefineHandleTypeOperator;
+    DefineAddressFunction;
+
+    // Const Function
+    result_t AllocateSets(arrayRef<VkDescriptorSet> sets, arrayRef<const VkDescriptorSetLayout> setLayouts) const
+    {
+        if (sets.Count() != setLayouts.Count())
+        {
+            if (sets.Count() < setLayouts.Count())
+            {
+                LOG(ERROR) << "[ descriptorPool ] ERROR\nFor each descriptor set, must provide a corresponding layout!";
+                return VK_RESULT_MAX_ENUM;
+            }
+            LOG(WARNING) << "[ descriptorPool ] WARNING\nProvided layouts are more than sets!";
+        }
+        VkDescriptorSetAllocateInfo allocateInfo = {
+            .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .descriptorPool     = handle,
+            .descriptorSetCount = static_cast<uint32_t>(sets.Count()),
+            .pSetLayouts        = setLayouts.Pointer(),
+        };
+        VkResult result = vkAllocateDescriptorSets(GraphicsBase::Base().Device(), &allocateInfo, sets.Pointer());
+        if (result != 0)
+        {
+            LOG(ERROR) << "[ descriptorPool ] ERROR\nFailed to allocate descriptor sets!\nError code: "
+                       << static_cast<int32_t>(result);
+        }
+        return result;
+    }
+    result_t AllocateSets(arrayRef<descriptorSet> sets, arrayRef<const descriptorSetLayout> setLayouts) const
+    {
+        return AllocateSets({&sets[0].handle, sets.Count()},
+                            {reinterpret_cast<const VkDescriptorSetLayout*>(setLayouts.Pointer()), setLayouts.Count()});
+    }
+    /**
+     * @brief 单独释放描述符集
+     * @note 池须以VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT创建
+     */
+    result_t FreeSets(arrayRef<VkDescriptorSet> sets) const
+    {
+        VkResult result = vkFreeDescriptorSets(GraphicsBase::Base().Device(), handle, sets.Count(), sets.Pointer());
+        memset(sets.Pointer(), 0, sets.Count() * sizeof(VkDescriptorSet));
+        return result;  // 仅返回VK_SUCCESS
+    }
+    result_t FreeSets(arrayRef<descriptorSet> sets) const { return FreeSets({&sets[0].handle, sets.Count()}); }
+
+    // Non-const Function
+    result_t Create(VkDescriptorPoolCreateInfo& createInfo)
     {
-        createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        VkResult result  = vkCreatePipelineLayout(GraphicsBase::Base().Device(), &createInfo, nullptr, &handle);
+        createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        VkResult result  = vkCreateDescriptorPool(GraphicsBase::Base().Device(), &createInfo, nullptr, &handle);
         if (result != 0)
         {
-            LOG(ERROR) << "[ pipelineLayout ] ERROR\nFailed to create a pipeline layout!\nError code: {}\n"
+            LOG(ERROR) << "[ descriptorPool ] ERROR\nFailed to create a descriptor pool!\nError code: "
                        << static_cast<int32_t>(result);
         }
         return result;
     }
+    result_t
+    Create(uint32_t maxSetCount, arrayRef<const VkDescriptorPoolSize> poolSizes, VkDescriptorPoolCreateFlags flags = 0)
+    {
+        VkDescriptorPoolCreateInfo createInfo = {
+            .flags         = flags,
+            .maxSets       = maxSetCount,
+            .poolSizeCount = static_cast<uint32_t>(poolSizes.Count()),
+            .pPoolSizes    = poolSizes.Pointer(),
+        };
+        return Create(createInfo);
+    }
 };
 
-class pipeline {
-    VkPipeline handle = VK_NULL_HANDLE;
+/**
+ * @brief 设备内存
+ */
+class deviceMemory {
+    VkDeviceMemory        handle           = VK_NULL_HANDLE;
+    VkDeviceSize          allocationSize   = 0;  // 实际分配的内存大小
+    VkMemoryPropertyFlags memoryProperties = 0;  // 内存属性
+
+    /**
+     * @brief 调整非host coherent的内存区域的范围，使其满足nonCoherentAtomSize的对齐要求
+     *
+     * @return VkDeviceSize 调整前后offset的差值，映射得到的地址需要加上这个值
+     */
+    VkDeviceSize AdjustNonCoherentMemoryRange(VkDeviceSize& size, VkDeviceSize& offset) const
+    {
+        const VkDeviceSize& nonCoherentAtomSize =
+            GraphicsBase::Base().PhysicalDeviceProperties().limits.nonCoherentAtomSize;
+        VkDeviceSize _offset = offset;
+        offset               = offset / nonCoherentAtomSize * nonCoherentAtomSize;
+        size = std::min((size + _offset + nonCoherentAtomSize - 1) / nonCoherentAtomSize * nonCoherentAtomSize,
+                        allocationSize) -
+               offset;
+        return _offset - offset;
+    }
 
 public:
-    pipeline() = default;
-    pipeline(VkGraphicsPipelineCreateInfo& createInfo) { Create(createInfo); }
-    pipeline(VkComputePipelineCreateInfo& createInfo) { Create(createInfo); }
-    pipeline(pipeline&& other) noexcept { MoveHandle; }
-    ~pipeline() { DestroyHandleBy(vkDestroyPipeline); }
+    deviceMemory() = default;
+    deviceMemory(VkMemoryAllocateInfo& allocateInfo) { Allocate(allocateInfo); }
+    deviceMemory(deviceMemory&& other) noexcept
+    {
+        MoveHandle;
+        allocationSize         = other.allocationSize;
+        memoryProperties       = other.memoryProperties;
+        other.allocationSize   = 0;
+        other.memoryProperties = 0;
+    }
+    ~deviceMemory()
+    {
+        DestroyHandleBy(vkFreeMemory);
+        allocationSize   = 0;
+        memoryProperties = 0;
+    }
 
     // Getter
     DefineHandleTypeOperator;
     DefineAddressFunction;
+    VkDeviceSize          AllocationSize() const { return allocationSize; }
+    VkMemoryPropertyFlags MemoryProperties() const { return memoryProperties; }
+
+    // Const Function
+    /**
+     * @brief 映射host visible的内存区
+     */
+    result_t MapMemory(void*& pData, VkDeviceSize size, VkDeviceSize offset = 0) const
+    {
+        VkDeviceSize inverseDeltaOffset = 0;
+        if ((memoryProperties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) == 0U)
+        {
+            inverseDeltaOffset = AdjustNonCoherentMemoryRange(size, offset);
+        }
+        if (result_t result = vkMapMemory(GraphicsBase::Base().Device(), handle, offset, size, 0, &pData))
+        {
+            LOG(ERROR) << "[ deviceMemory ] ERROR\nFailed to map the memory!\nError code: "
+                       << static_cast<int32_t>(result);
+            return result;
+        }
+        if ((memoryProperties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) == 0U)
+        {
+            pData = static_cast<uint8_t*>(pData) + inverseDeltaOffset;
+
+            VkMappedMemoryRange memoryRange = {
+                .sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+                .memory = handle,
+                .offset = offset,
+                .size   = size,
+            };
+            if (result_t result = vkInvalidateMappedMemoryRanges(GraphicsBase::Base().Device(), 1, &memoryRange))
+            {
+                LOG(ERROR) << "[ deviceMemory ] ERROR\nFailed to invalidate the memory!\nError code: "
+                           << static_cast<int32_t>(result);
+                return result;
+            }
+        }
+        return VK_SUCCESS;
+    }
+    /**
+     * @brief 取消映射host visible的内存区，非host coherent的内存会在取消映射前被刷新
+     */
+    result_t UnmapMemory(VkDeviceSize size, VkDeviceSize offset = 0) const
+    {
+        if ((memoryProperties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) == 0U)
+        {
+            AdjustNonCoherentMemoryRange(size, offset);
+            VkMappedMemoryRange memoryRange = {
+                .sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+                .memory = handle,
+                .offset = offset,
+                .size   = size,
+            };
+            if (result_t result = vkFlushMappedMemoryRanges(GraphicsBase::Base().Device(), 1, &memoryRange))
+            {
+                LOG(ERROR) << "[ deviceMemory ] ERROR\nFailed to flush the memory!\nError code: "
+                           << static_cast<int32_t>(result);
+                return result;
+            }
+        }
+        vkUnmapMemory(GraphicsBase::Base().Device(), handle);
+        return VK_SUCCESS;
+    }
+    /**
+     * @brief 向host visible的内存区写入数据
+     */
+    result_t BufferData(const void* pData_src, VkDeviceSize size, VkDeviceSize offset = 0) const
+    {
+        void* pData_dst = nullptr;
+        if (result_t result = MapMemory(pData_dst, size, offset)) { return result; }
+        memcpy(pData_dst, pData_src, static_cast<size_t>(size));
+        return UnmapMemory(size, offset);
+    }
+    /**
+     * @brief 从host visible的内存区读取数据
+     */
+    result_t RetrieveData(void* pData_dst, VkDeviceSize size, VkDeviceSize offset = 0) const
+    {
+        void* pData_src = nullptr;
+        if (result_t result = MapMemory(pData_src, size, offset)) { return result; }
+        memcpy(pData_dst, pData_src, static_cast<size_t>(size));
+        return UnmapMemory(size, offset);
+    }
 
     // Non-const Function
-    result_t Create(VkGraphicsPipelineCreateInfo& createInfo)
+    result_t Allocate(VkMemoryAllocateInfo& allocateInfo)
     {
-        createInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-        VkResult result =
-            vkCreateGraphicsPipelines(GraphicsBase::Base().Device(), VK_NULL_HANDLE, 1, &createInfo, nullptr, &handle);
+        if (allocateInfo.memoryTypeIndex >= GraphicsBase::Base().PhysicalDeviceMemoryProperties().memoryTypeCount)
+        {
+            LOG(ERROR) << "[ deviceMemory ] ERROR\nInvalid memory type index!";
+            return VK_RESULT_MAX_ENUM;
+        }
+        allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        if (result_t result = vkAllocateMemory(GraphicsBase::Base().Device(), &allocateInfo, nullptr, &handle))
+        {
+            LOG(ERROR) << "[ deviceMemory ] ERROR\nFailed to allocate memory!\nError code: "
+                       << static_cast<int32_t>(result);
+            return result;
+        }
+        allocationSize   = allocateInfo.allocationSize;
+        memoryProperties = GraphicsBase::Base()
+                               .PhysicalDeviceMemoryProperties()
+                               .memoryTypes[allocateInfo.memoryTypeIndex]
+                               .propertyFlags;
+        return VK_SUCCESS;
+    }
+};
+
+/**
+ * @brief 根据内存需求和所需的内存属性填写内存分配信息
+ * @note 找不到满足条件的内存类型时，memoryTypeIndex为UINT32_MAX
+ */
+inline VkMemoryAllocateInfo MemoryAllocateInfo(const VkMemoryRequirements& memoryRequirements,
+                                               VkMemoryPropertyFlags       desiredMemoryProperties)
+{
+    VkMemoryAllocateInfo memoryAllocateInfo = {
+        .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize  = memoryRequirements.size,
+        .memoryTypeIndex = UINT32_MAX,
+    };
+    const auto& physicalDeviceMemoryProperties = GraphicsBase::Base().PhysicalDeviceMemoryProperties();
+    for (uint32_t i = 0; i < physicalDeviceMemoryProperties.memoryTypeCount; i++)
+    {
+        if (((memoryRequirements.memoryTypeBits & (1U << i)) != 0U) &&
+            (physicalDeviceMemoryProperties.memoryTypes[i].propertyFlags & desiredMemoryProperties) ==
+                desiredMemoryProperties)
+        {
+            memoryAllocateInfo.memoryTypeIndex = i;
+            break;
+        }
+    }
+    return memoryAllocateInfo;
+}
+
+/**
+ * @brief 缓冲区
+ */
+class buffer {
+    VkBuffer handle = VK_NULL_HANDLE;
+
+public:
+    buffer() = default;
+    buffer(VkBufferCreateInfo& createInfo) { Create(createInfo); }
+    buffer(buffer&& other) noexcept { MoveHandle; }
+    ~buffer() { DestroyHandleBy(vkDestroyBuffer); }
+
+    // Getter
+    DefineHandleTypeOperator;
+    DefineAddressFunction;
+
+    // Const Function
+    VkMemoryAllocateInfo MemoryAllocateInfo(VkMemoryPropertyFlags desiredMemoryProperties) const
+    {
+        VkMemoryRequirements memoryRequirements;
+        vkGetBufferMemoryRequirements(GraphicsBase::Base().Device(), handle, &memoryRequirements);
+        return vulkan::MemoryAllocateInfo(memoryRequirements, desiredMemoryProperties);
+    }
+    result_t BindMemory(VkDeviceMemory deviceMemory, VkDeviceSize memoryOffset = 0) const
+    {
+        VkResult result = vkBindBufferMemory(GraphicsBase::Base().Device(), handle, deviceMemory, memoryOffset);
         if (result != 0)
         {
-            LOG(ERROR) << "[ pipeline ] ERROR\nFailed to create a graphics pipeline!\nError code: {}\n"
+            LOG(ERROR) << "[ buffer ] ERROR\nFailed to attach the memory!\nError code: "
                        << static_cast<int32_t>(result);
         }
         return result;
     }
-    result_t Create(VkComputePipelineCreateInfo& createInfo)
+
+    // Non-const Function
+    result_t Create(VkBufferCreateInfo& createInfo)
     {
-        createInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
-        VkResult result =
-            vkCreateComputePipelines(GraphicsBase::Base().Device(), VK_NULL_HANDLE, 1, &createInfo, nullptr, &handle);
+        createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        VkResult result  = vkCreateBuffer(GraphicsBase::Base().Device(), &createInfo, nullptr, &handle);
         if (result != 0)
         {
-            LOG(ERROR) << "[ pipeline ] ERROR\nFailed to create a compute pipeline!\nError code: {}\n"
+            LOG(ERROR) << "[ buffer ] ERROR\nFailed to create a buffer!\nError code: " << static_cast<int32_t>(result);
+        }
+        return result;
+    }
+};
+
+/**
+ * @brief 缓冲区及其所绑定的设备内存
+ */
+class bufferMemory : buffer, deviceMemory {
+    bool areBound = false;
+
+public:
+    bufferMemory() = default;
+    bufferMemory(VkBufferCreateInfo& createInfo, VkMemoryPropertyFlags desiredMemoryProperties)
+    {
+        Create(createInfo, desiredMemoryProperties);
+    }
+    bufferMemory(bufferMemory&& other) noexcept : buffer(std::move(other)), deviceMemory(std::move(other))
+    {
+        areBound       = other.areBound;
+        other.areBound = false;
+    }
+    ~bufferMemory() { areBound = false; }
+
+    // Getter
+    // 不定义到VkBuffer和VkDeviceMemory的转换函数，因为32位下这俩类型都是uint64_t的别名，会造成冲突
+    VkBuffer              Buffer() const { return static_cast<const buffer&>(*this); }
+    const VkBuffer*       AddressOfBuffer() const { return buffer::Address(); }
+    VkDeviceMemory        Memory() const { return static_cast<const deviceMemory&>(*this); }
+    const VkDeviceMemory* AddressOfMemory() const { return deviceMemory::Address(); }
+    bool                  AreBound() const { return areBound; }
+    using deviceMemory::AllocationSize;
+    using deviceMemory::MemoryProperties;
+
+    // Const Function
+    using deviceMemory::BufferData;
+    using deviceMemory::MapMemory;
+    using deviceMemory::RetrieveData;
+    using deviceMemory::UnmapMemory;
+
+    // Non-const Function
+    // 以下三个函数仅用于Create(...)可能执行失败的情况
+    result_t CreateBuffer(VkBufferCreateInfo& createInfo) { return buffer::Create(createInfo); }
+    result_t AllocateMemory(VkMemoryPropertyFlags desiredMemoryProperties)
+    {
+        VkMemoryAllocateInfo allocateInfo = MemoryAllocateInfo(desiredMemoryProperties);
+        if (allocateInfo.memoryTypeIndex >= GraphicsBase::Base().PhysicalDeviceMemoryProperties().memoryTypeCount)
+        {
+            return VK_RESULT_MAX_ENUM;  // 没有合适的错误码，别用VK_ERROR_UNKNOWN
+        }
+        return Allocate(allocateInfo);
+    }
+    result_t BindMemory()
+    {
+        if (result_t result = buffer::BindMemory(Memory())) { return result; }
+        areBound = true;
+        return VK_SUCCESS;
+    }
+    // 分配设备内存、创建缓冲、绑定
+    result_t Create(VkBufferCreateInfo& createInfo, VkMemoryPropertyFlags desiredMemoryProperties)
+    {
+        if (result_t result = CreateBuffer(createInfo)) { return result; }
+        if (result_t result = AllocateMemory(desiredMemoryProperties)) { return result; }
+        return BindMemory();
+    }
+};
+
+/**
+ * @brief 图像视图
+ */
+class imageView {
+    VkImageView handle = VK_NULL_HANDLE;
+
+public:
+    imageView() = default;
+    imageView(VkImageViewCreateInfo& createInfo) { Create(createInfo); }
+    imageView(VkImage                        image,
+              VkImageViewType                viewType,
+              VkFormat                       format,
+              const VkImageSubresourceRange& subresourceRange,
+              VkImageViewCreateFlags         flags = 0)
+    {
+        Create(image, viewType, format, subresourceRange, flags);
+    }
+    imageView(imageView&& other) noexcept { MoveHandle; }
+    ~imageView() { DestroyHandleBy(vkDestroyImageView); }
+
+    // Getter
+    DefineHandleTypeOperator;
+    DefineAddressFunction;
+
+    // Non-const Function
+    result_t Create(VkImageViewCreateInfo& createInfo)
+    {
+        createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        VkResult result  = vkCreateImageView(GraphicsBase::Base().Device(), &createInfo, nullptr, &handle);
+        if (result != 0)
+        {
+            LOG(ERROR) << "[ imageView ] ERROR\nFailed to create an image view!\nError code: "
+                       << static_cast<int32_t>(result);
+        }
+        return result;
+    }
+    result_t Create(VkImage                        image,
+                    VkImageViewType                viewType,
+                    VkFormat                       format,
+                    const VkImageSubresourceRange& subresourceRange,
+                    VkImageViewCreateFlags         flags = 0)
+    {
+        VkImageViewCreateInfo createInfo = {
+            .flags            = flags,
+            .image            = image,
+            .viewType         = viewType,
+            .format           = format,
+            .subresourceRange = subresourceRange,
+        };
+        return Create(createInfo);
+    }
+};
+
+/**
+ * @brief 图像
+ */
+class image {
+    VkImage handle = VK_NULL_HANDLE;
+
+public:
+    image() = default;
+    image(VkImageCreateInfo& createInfo) { Create(createInfo); }
+    image(image&& other) noexcept { MoveHandle; }
+    ~image() { DestroyHandleBy(vkDestroyImage); }
+
+    // Getter
+    DefineHandleTypeOperator;
+    DefineAddressFunction;
+
+    // Const Function
+    VkMemoryAllocateInfo MemoryAllocateInfo(VkMemoryPropertyFlags desiredMemoryProperties) const
+    {
+        VkMemoryRequirements memoryRequirements;
+        vkGetImageMemoryRequirements(GraphicsBase::Base().Device(), handle, &memoryRequirements);
+        auto memoryAllocateInfo = vulkan::MemoryAllocateInfo(memoryRequirements, desiredMemoryProperties);
+        // 找不到惰性分配的内存时，退而使用普通的device local内存
+        if (memoryAllocateInfo.memoryTypeIndex == UINT32_MAX &&
+            (desiredMemoryProperties & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) != 0U)
+        {
+            memoryAllocateInfo = vulkan::MemoryAllocateInfo(
+                memoryRequirements, desiredMemoryProperties & ~VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+        }
+        return memoryAllocateInfo;
+    }
+    result_t BindMemory(VkDeviceMemory deviceMemory, VkDeviceSize memoryOffset = 0) const
+    {
+        VkResult result = vkBindImageMemory(GraphicsBase::Base().Device(), handle, deviceMemory, memoryOffset);
+        if (result != 0)
+        {
+            LOG(ERROR) << "[ image ] ERROR\nFailed to attach the memory!\nError code: " << static_cast<int32_t>(result);
+        }
+        return result;
+    }
+
+    // Non-const Function
+    result_t Create(VkImageCreateInfo& createInfo)
+    {
+        createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        VkResult result  = vkCreateImage(GraphicsBase::Base().Device(), &createInfo, nullptr, &handle);
+        if (result != 0)
+        {
+            LOG(ERROR) << "[ image ] ERROR\nFailed to create an image!\nError code: " << static_cast<int32_t>(result);
+        }
+        return result;
+    }
+};
+
+/**
+ * @brief 图像及其所绑定的设备内存
+ */
+class imageMemory : image, deviceMemory {
+    bool areBound = false;
+
+public:
+    imageMemory() = default;
+    imageMemory(VkImageCreateInfo& createInfo, VkMemoryPropertyFlags desiredMemoryProperties)
+    {
+        Create(createInfo, desiredMemoryProperties);
+    }
+    imageMemory(imageMemory&& other) noexcept : image(std::move(other)), deviceMemory(std::move(other))
+    {
+        areBound       = other.areBound;
+        other.areBound = false;
+    }
+    ~imageMemory() { areBound = false; }
+
+    // Getter
+    VkImage               Image() const { return static_cast<const image&>(*this); }
+    const VkImage*        AddressOfImage() const { return image::Address(); }
+    VkDeviceMemory        Memory() const { return static_cast<const deviceMemory&>(*this); }
+    const VkDeviceMemory* AddressOfMemory() const { return deviceMemory::Address(); }
+    bool                  AreBound() const { return areBound; }
+    using deviceMemory::AllocationSize;
+    using deviceMemory::MemoryProperties;
+
+    // Non-const Function
+    // 以下三个函数仅用于Create(...)可能执行失败的情况
+    result_t CreateImage(VkImageCreateInfo& createInfo) { return image::Create(createInfo); }
+    result_t AllocateMemory(VkMemoryPropertyFlags desiredMemoryProperties)
+    {
+        VkMemoryAllocateInfo allocateInfo = MemoryAllocateInfo(desiredMemoryProperties);
+        if (allocateInfo.memoryTypeIndex >= GraphicsBase::Base().PhysicalDeviceMemoryProperties().memoryTypeCount)
+        {
+            return VK_RESULT_MAX_ENUM;  // 没有合适的错误码，别用VK_ERROR_UNKNOWN
+        }
+        return Allocate(allocateInfo);
+    }
+    result_t BindMemory()
+    {
+        if (result_t result = image::BindMemory(Memory())) { return result; }
+        areBound = true;
+        return VK_SUCCESS;
+    }
+    // 分配设备内存、创建图像、绑定
+    result_t Create(VkImageCreateInfo& createInfo, VkMemoryPropertyFlags desiredMemoryProperties)
+    {
+        if (result_t result = CreateImage(createInfo)) { return result; }
+        if (result_t result = AllocateMemory(desiredMemoryProperties)) { return result; }
+        return BindMemory();
+    }
+};
+
+/**
+ * @brief 采样器
+ */
+class sampler {
+    VkSampler handle = VK_NULL_HANDLE;
+
+public:
+    sampler() = default;
+    sampler(VkSamplerCreateInfo& createInfo) { Create(createInfo); }
+    sampler(sampler&& other) noexcept { MoveHandle; }
+    ~sampler() { DestroyHandleBy(vkDestroySampler); }
+
+    // Getter
+    DefineHandleTypeOperator;
+    DefineAddressFunction;
+
+    // Non-const Function
+    result_t Create(VkSamplerCreateInfo& createInfo)
+    {
+        createInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        VkResult result  = vkCreateSampler(GraphicsBase::Base().Device(), &createInfo, nullptr, &handle);
+        if (result != 0)
+        {
+            LOG(ERROR) << "[ sampler ] ERROR\nFailed to create a sampler!\nError code: "
                        << static_cast<int32_t>(result);
         }
         return result;
@@ -0,0 +1,185 @@
+#pragma once
+#include "EasyVKStart.h"
+
+// GLM
+#include <glm/gtc/packing.hpp>
+
+namespace easyVulkan {
+
+/**
+ * @brief 网格缓存中顶点数据的存储格式
+ */
+enum class vertexFormat : uint32_t {
+    full,     // meshVertex，各属性皆为32位浮点数，64字节
+    compact,  // compactVertex，量化后的属性，24字节
+};
+
+/**
+ * @brief 紧凑顶点
+ * @note 各属性的编码方式：
+ * position  snorm16x4，xyz为相对于网格包围盒中心、以半边长归一化的坐标，w恒为1
+ * normal    snorm16x2，八面体映射编码的法线
+ * tangent   snorm16x2，八面体映射编码的切线，x分量量化后的整数的最低位为切线的手性（1为-1，0为+1）
+ * texCoord  unorm16x2，若有纹理坐标超出[0, 1]（平铺贴图），则改用half float
+ * color     unorm8x4
+ */
+struct compactVertex
+{
+    int16_t  position[4];
+    int16_t  normal[2];
+    int16_t  tangent[2];
+    uint16_t texCoord[2];
+    uint8_t  color[4];
+};
+static_assert(sizeof(compactVertex) == 24);
+
+/**
+ * @brief 单个顶点属性的描述，会被写入网格缓存，供生成VkVertexInputAttributeDescription
+ */
+struct vertexAttribute
+{
+    uint32_t location;
+    VkFormat format;
+    uint32_t offset;
+};
+
+/*
+着色器中各location的约定：
+    0 position
+    1 normal
+    2 tangent
+    3 texCoord
+    4 color
+使用compact格式时，着色器中position须声明为vec4，normal和tangent须声明为vec2并解码：
+
+vec3 OctahedralDecode(vec2 e) {
+    vec3 v = vec3(e, 1 - abs(e.x) - abs(e.y));
+    float t = max(-v.z, 0);
+    v.xy += mix(vec2(t), vec2(-t), greaterThanEqual(v.xy, vec2(0)));
+    return normalize(v);
+}
+float TangentHandedness(vec2 e) {
+    return (int(round(e.x * 32767)) & 1) != 0 ? -1 : 1;  // snorm16到浮点数的转换可以精确地还原整数
+}
+
+手性不放在position的w分量中，是为了让w恒为1，使反量化矩阵能直接作用于position。
+
+位置的反量化（乘以半边长再加上中心）已经被折算进meshCache::PositionDequantization()返回的矩阵，
+将其右乘到模型矩阵即可，着色器中不需要额外的计算。
+*/
+
+// ANCHOR - Quantization
+
+inline int16_t QuantizeSnorm16(float value)
+{
+    return static_cast<int16_t>(std::round(glm::clamp(value, -1.F, 1.F) * 32767.F));
+}
+inline uint16_t QuantizeUnorm16(float value)
+{
+    return static_cast<uint16_t>(std::round(glm::clamp(value, 0.F, 1.F) * 65535.F));
+}
+inline uint8_t QuantizeUnorm8(float value)
+{
+    return static_cast<uint8_t>(std::round(glm::clamp(value, 0.F, 1.F) * 255.F));
+}
+
+/**
+ * @brief 八面体映射编码，将单位向量映射到[-1, 1]^2
+ */
+inline glm::vec2 OctahedralEncode(glm::vec3 vector)
+{
+    float l1Norm = std::abs(vector.x) + std::abs(vector.y) + std::abs(vector.z);
+    if (l1Norm == 0.F) { return glm::vec2(0.F); }
+    vector /= l1Norm;
+    glm::vec2 encoded(vector.x, vector.y);
+    if (vector.z < 0.F)
+    {
+        // 下半球沿对角线折叠到正方形的四个角
+        glm::vec2 signNotZero(encoded.x >= 0.F ? 1.F : -1.F, encoded.y >= 0.F ? 1.F : -1.F);
+        encoded = (1.F - glm::abs(glm::vec2(encoded.y, encoded.x))) * signNotZero;
+    }
+    return encoded;
+}
+
+/**
+ * @brief 将切线的手性写入量化后的整数的最低位，误差不超过1/32767
+ */
+inline int16_t PackHandedness(int16_t value, float handedness)
+{
+    int32_t packed = (value & ~1) | (handedness < 0.F ? 1 : 0);
+    return static_cast<int16_t>(packed < -32767 ? packed + 2 : packed);  // -32768与-32767都被解读为-1，会丢失最低位
+}
+
+/**
+ * @brief 判断纹理坐标能否以unorm16存储
+ */
+inline bool TexCoordsFitUnorm(const glm::vec2* pTexCoords, size_t count, size_t stride)
+{
+    const auto* pBytes = reinterpret_cast<const uint8_t*>(pTexCoords);
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto& texCoord = *reinterpret_cast<const glm::vec2*>(pBytes + i * stride);
+        if (texCoord.x < 0.F || texCoord.x > 1.F || texCoord.y < 0.F || texCoord.y > 1.F) { return false; }
+    }
+    return true;
+}
+
+/**
+ * @brief 量化单个顶点
+ *
+ * @param center 网格包围盒的中心
+ * @param inverseHalfExtent 网格包围盒半边长的倒数
+ */
+inline compactVertex QuantizeVertex(const glm::vec3& position,
+                                    const glm::vec3& normal,
+                                    const glm::vec4& tangent,
+                                    const glm::vec2& texCoord,
+                                    const glm::vec4& color,
+                                    const glm::vec3& center,
+                                    const glm::vec3& inverseHalfExtent,
+                                    bool             texCoordsAsHalf)
+{
+    compactVertex vertex   = {};
+    glm::vec3     relative = (position - center) * inverseHalfExtent;
+    vertex.position[0]     = QuantizeSnorm16(relative.x);
+    vertex.position[1]     = QuantizeSnorm16(relative.y);
+    vertex.position[2]     = QuantizeSnorm16(relative.z);
+    vertex.position[3]     = 32767;
+
+    glm::vec2 encodedNormal  = OctahedralEncode(normal);
+    glm::vec2 encodedTangent = OctahedralEncode(glm::vec3(tangent));
+    vertex.normal[0]         = QuantizeSnorm16(encodedNormal.x);
+    vertex.normal[1]         = QuantizeSnorm16(encodedNormal.y);
+    vertex.tangent[0]        = PackHandedness(QuantizeSnorm16(encodedTangent.x), tangent.w);
+    vertex.tangent[1]        = QuantizeSnorm16(encodedTangent.y);
+
+    if (texCoordsAsHalf)
+    {
+        vertex.texCoord[0] = glm::packHalf1x16(texCoord.x);
+        vertex.texCoord[1] = glm::packHalf1x16(texCoord.y);
+    }
+    else
+    {
+        vertex.texCoord[0] = QuantizeUnorm16(texCoord.x);
+        vertex.texCoord[1] = QuantizeUnorm16(texCoord.y);
+    }
+
+    for (int i = 0; i < 4; i++) { vertex.color[i] = QuantizeUnorm8(color[i]); }
+    return vertex;
+}
+
+/**
+ * @brief 取得紧凑顶点各属性的描述
+ */
+inline std::vector<vertexAttribute> CompactVertexAttributes(bool texCoordsAsHalf)
+{
+    return {
+        {0, VK_FORMAT_R16G16B16A16_SNORM, offsetof(compactVertex, position)},
+        {1, VK_FORMAT_R16G16_SNORM, offsetof(compactVertex, normal)},
+        {2, VK_FORMAT_R16G16_SNORM, offsetof(compactVertex, tangent)},
+        {3, texCoordsAsHalf ? VK_FORMAT_R16G16_SFLOAT : VK_FORMAT_R16G16_UNORM, offsetof(compactVertex, texCoord)},
+        {4, VK_FORMAT_R8G8B8A8_UNORM, offsetof(compactVertex, color)},
+    };
+}
+
+}  // namespace easyVulkan
@@ -0,0 +1,35 @@
+# 把若干SPIR-V文件写成一个C++源文件，各文件成为constexpr的uint32_t数组，并在静态初始化时登记到vulkan::shaderRegistry
+# 登记的名称为运行时的相对路径shader/<文件名>，与不嵌入时复制到编译目录下的着色器的路径一致
+# 用法：cmake -DOUTPUT=<EmbeddedShaders.cpp> -DSPIRV_FILES=<a.spv|b.spv|...> -P EmbedSpirv.cmake
+# SPIRV_FILES以"|"分隔，避免分号在add_custom_command中被展开为多个参数
+
+string(REPLACE "|" ";" SPIRV_FILES "${SPIRV_FILES}")
+
+set(ARRAYS "")
+set(REGISTRATIONS "")
+set(INDEX 0)
+foreach(SPIRV_FILE IN LISTS SPIRV_FILES)
+    get_filename_component(NAME "${SPIRV_FILE}" NAME)
+    file(READ "${SPIRV_FILE}" HEX HEX)
+    string(LENGTH "${HEX}" HEX_LENGTH)
+    math(EXPR REMAINDER "${HEX_LENGTH} % 8")
+    if(HEX_LENGTH EQUAL 0 OR NOT REMAINDER EQUAL 0)
+        message(FATAL_ERROR "${SPIRV_FILE} isn't valid SPIR-V: its size isn't a multiple of 4 bytes")
+    endif()
+    # 文件按小端序存储，每4个字节倒序拼成一个字，每行8个字
+    string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1, " WORDS "${HEX}")
+    string(REPEAT "0x[0-9a-f]+, " 8 LINE_PATTERN)  # CMake的正则表达式不支持{n}
+    string(REGEX REPLACE "(${LINE_PATTERN})" "\\1\n    " WORDS "${WORDS}")
+    string(REPLACE ", \n" ",\n" WORDS "${WORDS}")
+    string(STRIP "${WORDS}" WORDS)
+    string(APPEND ARRAYS "// ${NAME}\nconstexpr uint32_t spirv_${INDEX}[] = {\n    ${WORDS}\n};\n\n")
+    string(APPEND REGISTRATIONS "    registry.Register(\"shader/${NAME}\", spirv_${INDEX}, sizeof spirv_${INDEX});\n")
+    math(EXPR INDEX "${INDEX} + 1")
+endforeach()
+
+set(CONTENT "// 由EmbedSpirv.cmake在构建时生成，不要手动修改\n#include \"ShaderRegistry.h\"\n\nnamespace {\n\n")
+string(APPEND CONTENT "${ARRAYS}")
+string(APPEND CONTENT "[[maybe_unused]] const bool registered = [] {\n    vulkan::shaderRegistry& registry = vulkan::shaderRegistry::Shared();\n")
+string(APPEND CONTENT "${REGISTRATIONS}    return true;\n}();\n\n}  // namespace\n")
+
+file(WRITE "${OUTPUT}" "${CONTENT}")
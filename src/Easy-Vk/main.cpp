@@ -1,5 +1,8 @@
+#define STB_IMAGE_IMPLEMENTATION  // stb_image的实现只能在一个编译单元中展开
 #include "EasyVulkan.hpp"
+#include "FramePacer.h"
 #include "GlfwGeneral.hpp"
+#include "ShaderModuleCache.h"
 #include "VKBase+.h"
 #include "VKBase.h"
 #include <vulkan/vulkan_core.h>
@@ -32,17 +35,21 @@ void CreateLayout()
 
 /**
  * @brief 创建管线
+ *
+ * @return bool 着色器模块创建失败时返回false
  */
-void CreatePipeline()
+bool CreatePipeline()
 {
-    static shaderModule                                   vert("./shader/FirstTriangle.vert.spv");
-    static shaderModule                                   frag("./shader/FirstTriangle.frag.spv");
-    static std::array<VkPipelineShaderStageCreateInfo, 2> shaderStageCreateInfos_triangle = {
-        vert.StageCreateInfo(VK_SHADER_STAGE_VERTEX_BIT),
-        frag.StageCreateInfo(VK_SHADER_STAGE_FRAGMENT_BIT),
-    };
-
-    std::function<void()> Create = []() {
+    // 着色器模块由缓存持有，重建交换链时重新创建管线不会再次读取文件
+    const shaderModule* pVert = easyVulkan::shaderModuleCache::Shared().Get("./shader/FirstTriangle.vert.spv");
+    const shaderModule* pFrag = easyVulkan::shaderModuleCache::Shared().Get("./shader/FirstTriangle.frag.spv");
+    if (pVert == nullptr || pFrag == nullptr) { return false; }  // 缓存已输出错误信息，且不缓存失败的结果
+
+    std::function<void()> Create = [pVert, pFrag]() {
+        std::array<VkPipelineShaderStageCreateInfo, 2> shaderStageCreateInfos_triangle = {
+            pVert->StageCreateInfo(VK_SHADER_STAGE_VERTEX_BIT),
+            pFrag->StageCreateInfo(VK_SHADER_STAGE_FRAGMENT_BIT),
+        };
         graphicsPipelineCreateInfoPack pipelineCiPack;
         pipelineCiPack.createInfo.layout     = pipelineLayout_triangle;
         pipelineCiPack.createInfo.renderPass = RenderPassAndFramebuffers().renderPass;
@@ -71,11 +78,16 @@ void CreatePipeline()
         pipelineCiPack.createInfo.pStages    = shaderStageCreateInfos_triangle.data();
         pipeline_triangle.Create(pipelineCiPack);
     };
-    std::function<void()> Destroy = []() { pipeline_triangle.~pipeline(); };
+    std::function<void()> Destroy = []() {
+        // 旧管线可能仍被尚未执行完毕的帧使用，移入删除队列
+        auto retired = std::make_shared<pipeline>(std::move(pipeline_triangle));
+        GraphicsBase::Base().DeferDestruction([retired]() mutable { retired.reset(); });
+    };
     GraphicsBase::Base().AddCallback_CreateSwapchain(Create);
     GraphicsBase::Base().AddCallback_DestroySwapchain(Destroy);
 
     Create();  // 调用Create()以创建管线
+    return true;
 }
 
 int main(int argc, char** argv)
@@ -94,17 +106,21 @@ int main(int argc, char** argv)
 
     const auto& [renderPass, framebuffers] = RenderPassAndFramebuffers();
     CreateLayout();
-    CreatePipeline();
+    if (!CreatePipeline())
+    {
+        TerminateWindow();
+        return EXIT_FAILURE;
+    }
 
-    fence     fence(VK_FENCE_CREATE_SIGNALED_BIT);  // 以置位状态创建栅栏
-    semaphore semaphore_imageIsAvailable;
-    semaphore semaphore_renderingIsOver;
+    // 两个即时帧，且每帧都等到上一帧被呈现后才开始，交互时的延迟最低
+    constexpr uint32_t     framesInFlight = 2;
+    easyVulkan::framePacer framePacer(framesInFlight, 1);
 
-    // 创建指令池和指令缓冲
-    commandBuffer commandBuffer;
-    commandPool   commandPool(GraphicsBase::Base().QueueFamilyIndex_Graphics(),
-                              VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
-    commandPool.AllocateBuffers(commandBuffer);
+    // 创建指令池和指令缓冲，每个即时帧一个
+    std::array<commandBuffer, framesInFlight> commandBuffers;
+    commandPool                               commandPool(GraphicsBase::Base().QueueFamilyIndex_Graphics(),
+                                                          VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+    commandPool.AllocateBuffers(commandBuffers);
 
     VkClearValue clearColor = {
         .color = {1.F, 0.F, 0.F, 1.F},
@@ -117,9 +133,10 @@ int main(int argc, char** argv)
             glfwWaitEvents();  // 出于节省CPU和GPU占用的考量，有必要在窗口最小化时阻塞渲染循环。
         }
 
-        fence.WaitAndReset();                                        // 等待并重置fence
-        GraphicsBase::Base().SwapImage(semaphore_imageIsAvailable);  // 获取交换链图像索引
-        auto i = GraphicsBase::Base().CurrentImageIndex();
+        framePacer.BeginFrame();                                        // 等待并重置当前即时帧的栅栏
+        GraphicsBase::Base().SwapImage(framePacer.ImageIsAvailable());  // 获取交换链图像索引
+        auto           i             = GraphicsBase::Base().CurrentImageIndex();
+        commandBuffer& commandBuffer = commandBuffers[framePacer.CurrentFrame()];
 
         commandBuffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
         renderPass.CmdBegin(commandBuffer, framebuffers[i],
@@ -133,9 +150,9 @@ int main(int argc, char** argv)
         renderPass.CmdEnd(commandBuffer);
         commandBuffer.End();
 
-        GraphicsBase::Base().SubmitCommandBuffer_Graphics(commandBuffer, semaphore_imageIsAvailable,
-                                                          semaphore_renderingIsOver, fence);
-        GraphicsBase::Base().PresentImage(semaphore_renderingIsOver);
+        GraphicsBase::Base().SubmitCommandBuffer_Graphics(commandBuffer, framePacer.ImageIsAvailable(),
+                                                          framePacer.RenderingIsOver(), framePacer.InFlightFence());
+        framePacer.Present();
 
         glfwPollEvents();
         TitleFps();
@@ -0,0 +1,54 @@
+#version 450
+#pragma shader_stage(compute)
+
+layout(local_size_x = 64) in;
+
+struct meshlet {
+    vec4 boundingSphere;
+    vec4 normalCone;
+    uint firstIndex;
+    uint indexCount;
+    int  vertexOffset;
+    uint subMeshIndex;
+};
+struct drawIndexedIndirectCommand {
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int  vertexOffset;
+    uint firstInstance;
+};
+
+layout(std430, binding = 0) readonly buffer meshletBuffer {
+    meshlet meshlets[];
+};
+layout(std430, binding = 1) writeonly buffer drawCommandBuffer {
+    drawIndexedIndirectCommand drawCommands[];
+};
+layout(std430, binding = 2) buffer drawCountBuffer {
+    uint drawCount;
+};
+//平截头体的六个平面和相机位置皆在模型空间中
+layout(push_constant) uniform pushConstants {
+    vec4 frustumPlanes[6];
+    vec3 cameraPosition;
+    uint meshletCount;
+};
+
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= meshletCount)
+        return;
+    vec3 center = meshlets[i].boundingSphere.xyz;
+    float radius = meshlets[i].boundingSphere.w;
+    for (int p = 0; p < 6; p++)
+        if (dot(frustumPlanes[p].xyz, center) + frustumPlanes[p].w < -radius)
+            return;
+    vec3 toCenter = center - cameraPosition;
+    vec4 normalCone = meshlets[i].normalCone;
+    if (dot(toCenter, normalCone.xyz) >= normalCone.w * length(toCenter) + radius)
+        return;
+    uint slot = atomicAdd(drawCount, 1);
+    drawCommands[slot] = drawIndexedIndirectCommand(
+        meshlets[i].indexCount, 1, meshlets[i].firstIndex, meshlets[i].vertexOffset, 0);
+}
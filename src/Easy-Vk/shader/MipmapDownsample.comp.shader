@@ -0,0 +1,23 @@
+#version 450
+#pragma shader_stage(compute)
+#extension GL_EXT_samplerless_texture_functions : require
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+// 两个图像视图各只包含一个mip等级
+layout(binding = 0) uniform texture2D srcLevel;
+layout(binding = 1) uniform writeonly image2D dstLevel;  // 不指定格式，需要shaderStorageImageWriteWithoutFormat
+
+void main() {
+    ivec2 dstTexel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(dstTexel, imageSize(dstLevel)))) { return; }
+
+    // 2x2盒式滤波，源图像的边长为奇数时，最后一行/列被钳制到边缘
+    ivec2 srcMax   = textureSize(srcLevel, 0) - 1;
+    ivec2 srcTexel = dstTexel * 2;
+    vec4  color    = texelFetch(srcLevel, min(srcTexel, srcMax), 0) +
+                     texelFetch(srcLevel, min(srcTexel + ivec2(1, 0), srcMax), 0) +
+                     texelFetch(srcLevel, min(srcTexel + ivec2(0, 1), srcMax), 0) +
+                     texelFetch(srcLevel, min(srcTexel + ivec2(1, 1), srcMax), 0);
+    imageStore(dstLevel, dstTexel, color * 0.25);
+}